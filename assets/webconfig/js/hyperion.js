@@ -84,6 +84,8 @@ function initWebSocket()
 			else
 				window.jsonPort = document.location.port;
 			window.websocket = (document.location.protocol == "https:") ? new WebSocket('wss://'+document.location.hostname+":"+window.jsonPort) : new WebSocket('ws://'+document.location.hostname+":"+window.jsonPort);
+			// the ledstream is received as binary frames
+			window.websocket.binaryType = "arraybuffer";
 
 			window.websocket.onopen = function (event) {
 				$(window.hyperion).trigger({type:"open"});
@@ -119,6 +121,12 @@ function initWebSocket()
 			};
 
 			window.websocket.onmessage = function (event) {
+				if (event.data instanceof ArrayBuffer)
+				{
+					handleBinaryMessage(event.data);
+					return;
+				}
+
 				try
 				{
 					var response = JSON.parse(event.data);
@@ -160,6 +168,56 @@ function initWebSocket()
 	}
 }
 
+// Decode a frame of the binary led- or imagestream and trigger the same event as the json stream
+// Header: frame type (1: all leds, 2: runs of changed leds, 3: jpeg image), reserved byte, led count (16 bit)
+// Run: index of the first led (16 bit), led count (16 bit), rgb bytes
+function handleBinaryMessage(buffer)
+{
+	var view = new DataView(buffer);
+	if (view.byteLength < 4)
+		return;
+
+	var type = view.getUint8(0);
+	var ledCount = view.getUint16(2);
+
+	if (type == 3)
+	{
+		// the previous image has been drawn when the next one arrives
+		if (window.imageStreamUrl)
+			URL.revokeObjectURL(window.imageStreamUrl);
+		window.imageStreamUrl = URL.createObjectURL(new Blob([buffer.slice(4)], {type:"image/jpeg"}));
+		$(window.hyperion).trigger({type:"cmd-ledcolors-imagestream-update", response:{success:true, command:"ledcolors-imagestream-update", result:{image:window.imageStreamUrl}}});
+		return;
+	}
+
+	if (type == 1)
+	{
+		window.ledStreamColors = new Uint8Array(buffer.slice(4, 4 + ledCount * 3));
+	}
+	else if (type == 2)
+	{
+		// a delta frame requires the full frame it is based on
+		if (!window.ledStreamColors || window.ledStreamColors.length != ledCount * 3)
+			return;
+
+		var pos = 4;
+		while (pos + 4 <= view.byteLength)
+		{
+			var first = view.getUint16(pos);
+			var count = view.getUint16(pos + 2);
+			pos += 4;
+			window.ledStreamColors.set(new Uint8Array(buffer, pos, count * 3), first * 3);
+			pos += count * 3;
+		}
+	}
+	else
+	{
+		return;
+	}
+
+	$(window.hyperion).trigger({type:"cmd-ledcolors-ledstream-update", response:{success:true, command:"ledcolors-ledstream-update", result:{leds:window.ledStreamColors}}});
+}
+
 function sendToHyperion(command, subcommand, msg)
 {
 	if (typeof subcommand != 'undefined' && subcommand.length > 0)
@@ -203,6 +261,10 @@ async function __sendAsync (data) {
       cmd = `${cmd}-${subc}`
 
     let func = (e) => {
+      // binary frames of the ledstream are no replies
+      if (typeof e.data !== "string")
+        return;
+
       let rdata;
       try {
         rdata = JSON.parse(e.data)
@@ -331,7 +393,8 @@ function requestServerConfigReload()
 function requestLedColorsStart()
 {
 	window.ledStreamActive=true;
-	sendToHyperion("ledcolors", "ledstream-start");
+	window.ledStreamColors=null;
+	sendToHyperion("ledcolors", "ledstream-start", '"format":"binary"');
 }
 
 function requestLedColorsStop()
@@ -343,7 +406,7 @@ function requestLedColorsStop()
 function requestLedImageStart()
 {
 	window.imageStreamActive=true;
-	sendToHyperion("ledcolors", "imagestream-start");
+	sendToHyperion("ledcolors", "imagestream-start", '"format":"binary"');
 }
 
 function requestLedImageStop()
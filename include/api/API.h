@@ -83,6 +83,14 @@ protected:
     ///
     bool clearPriority(int priority, QString &replyMsg, hyperion::Components callerComp = hyperion::COMP_INVALID);
 
+    ///
+    /// @brief Set how a priority is composited onto the priorities below it, kept until the priority is cleared
+    /// @param priority   The priority
+    /// @param blendMode  The blend mode ("none", "alpha", "add" or "max")
+    /// @param opacity    The opacity of the priority (0-255)
+    ///
+    void setInputBlending(int priority, const QString &blendMode, int opacity = 255);
+
     ///
     /// @brief Set a new component state
     /// @param comp       The component name
@@ -3,6 +3,9 @@
 // parent class
 #include <api/API.h>
 
+// api includes
+#include <api/LedStreamEncoder.h>
+
 // hyperion includes
 #include <utils/Components.h>
 #include <hyperion/Hyperion.h>
@@ -44,6 +47,12 @@ public:
 	///
 	void initialize();
 
+	///
+	/// @brief Set whether the connection can carry binary messages (WebSocket), enables the binary ledstream
+	/// @param supported  True, if callbackBinaryMessage() is handled
+	///
+	void setBinaryMessagesSupported(bool supported);
+
 public slots:
 	///
 	/// @brief Is called whenever the current Hyperion instance pushes new led raw values (if enabled)
@@ -52,10 +61,10 @@ public slots:
 	void streamLedcolorsUpdate(const std::vector<ColorRgb> &ledColors);
 
 	///
-	/// @brief Push images whenever hyperion emits (if enabled)
-	/// @param image  The current image
+	/// @brief Push the images of the instance's image stream (if enabled)
+	/// @param jpeg  The current image as JPEG
 	///
-	void setImage(const Image<ColorRgb> &image);
+	void streamImageUpdate(const QByteArray &jpeg);
 
 	///
 	/// @brief Process and push new log messages from logger (if enabled)
@@ -94,6 +103,11 @@ signals:
 	///
 	void callbackMessage(QJsonObject);
 
+	///
+	/// Signal emits with a binary message of a stream, see setBinaryMessagesSupported()
+	///
+	void callbackBinaryMessage(QByteArray);
+
 	///
 	/// Signal emits whenever a JSON-message should be forwarded
 	///
@@ -126,6 +140,22 @@ private:
 	/// the current streaming led values
 	std::vector<ColorRgb> _currentLedValues;
 
+	/// can the connection carry binary messages?
+	bool _binaryMessagesSupported;
+
+	/// is the led stream sent as binary delta frames?
+	bool _ledStreamBinary;
+
+	/// encoder and frame buffer of the binary led stream
+	LedStreamEncoder _ledStreamEncoder;
+	QByteArray _ledStreamFrame;
+
+	/// image stream connection handle
+	QMetaObject::Connection _imageStreamConnection;
+
+	/// is the image stream sent as binary JPEG frames?
+	bool _imageStreamBinary;
+
 	///
 	/// @brief Handle the switches of Hyperion instances
 	/// @param instance the instance to switch
@@ -0,0 +1,56 @@
+#pragma once
+
+// STL includes
+#include <vector>
+
+// Qt includes
+#include <QByteArray>
+
+// util
+#include <utils/ColorRgb.h>
+
+///
+/// @brief Encodes the LED colors of the binary "ledstream" of a WebSocket client
+///
+/// Every frame starts with a 4 byte header: the frame type, a reserved byte and the number of LEDs (16 bit, big endian).
+/// A full frame is followed by the RGB bytes of all LEDs. A delta frame is followed by runs of changed LEDs, each one
+/// has the index of its first LED and the number of LEDs (16 bit, big endian) followed by their RGB bytes. Unchanged
+/// LEDs between two changed ones are part of a run as long as this is smaller than the header of a new run.
+///
+class LedStreamEncoder
+{
+public:
+	/// The type of a frame, its first byte
+	enum FrameType
+	{
+		FULL_FRAME = 0x01,
+		DELTA_FRAME = 0x02
+	};
+
+	LedStreamEncoder();
+
+	///
+	/// @brief Forget the previous frame, the next one is sent as full frame
+	///
+	void reset();
+
+	///
+	/// @brief Encode the LED colors against the previous frame
+	/// @param ledColors  The LED colors
+	/// @param[out] frame The frame
+	/// @return False, if nothing changed since the previous frame and there is nothing to send
+	///
+	bool encode(const std::vector<ColorRgb>& ledColors, QByteArray& frame);
+
+private:
+	///
+	/// @brief Encode all LED colors
+	///
+	void encodeFullFrame(const std::vector<ColorRgb>& ledColors, QByteArray& frame);
+
+	/// The LED colors of the previous frame
+	std::vector<ColorRgb> _previousColors;
+
+	/// Was a frame sent since the last reset?
+	bool _hasPrevious;
+};
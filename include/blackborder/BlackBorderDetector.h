@@ -1,6 +1,9 @@
 //#include <iostream>
 #pragma once
 
+// QT includes
+#include <QString>
+
 // Utils includes
 #include <utils/Image.h>
 
@@ -62,6 +65,47 @@ namespace hyperion
 
 		uint8_t calculateThreshold(double blackborderThreshold) const;
 
+		///
+		/// @return The threshold of the detector [0 .. 255]
+		///
+		uint8_t threshold() const { return _blackborderThreshold; }
+
+		///
+		/// @param[in] mode  The detection mode
+		///
+		/// @return True if the mode is one of the detection modes (default, classic, osd, letterbox)
+		///
+		static bool isDetectionMode(const QString & mode)
+		{
+			return mode == "default" || mode == "classic" || mode == "osd" || mode == "letterbox";
+		}
+
+		///
+		/// Performs the black-border detection of the given mode on the given image
+		///
+		/// @param[in] image  The image on which detection is performed
+		/// @param[in] mode   The detection mode (classic, osd, letterbox), any other mode uses the default detection
+		///
+		/// @return The detected (or not detected) black border info
+		///
+		template <typename Pixel_T>
+		BlackBorder process(const Image<Pixel_T> & image, const QString & mode) const
+		{
+			if (mode == "classic")
+			{
+				return process_classic(image);
+			}
+			if (mode == "osd")
+			{
+				return process_osd(image);
+			}
+			if (mode == "letterbox")
+			{
+				return process_letterbox(image);
+			}
+			return process(image);
+		}
+
 		///
 		/// default detection mode (3lines 4side detection)
 		template <typename Pixel_T>
@@ -10,6 +10,7 @@
 
 // Local Hyperion includes
 #include "BlackBorderDetector.h"
+#include <hyperion/FrameAnalysis.h>
 
 class Hyperion;
 
@@ -74,14 +75,10 @@ namespace hyperion
 				return true;
 			}
 
-			if (_detectionMode == "default") {
-				imageBorder = _detector->process(image);
-			} else if (_detectionMode == "classic") {
-				imageBorder = _detector->process_classic(image);
-			} else if (_detectionMode == "osd") {
-				imageBorder = _detector->process_osd(image);
-			} else if (_detectionMode == "letterbox") {
-				imageBorder = _detector->process_letterbox(image);
+			// an unknown detection mode keeps the border initialized above
+			if (BlackBorderDetector::isDetectionMode(_detectionMode))
+			{
+				imageBorder = detect(image);
 			}
 			// add blur to the border
 			if (imageBorder.horizontalSize > 0)
@@ -96,6 +93,15 @@ namespace hyperion
 			const bool borderUpdated = updateBorder(imageBorder);
 			return borderUpdated;
 		}
+
+		///
+		/// Returns true if the detection is settled, the last processed image confirmed the current border.
+		/// Processing the same image again will not change the current border then.
+		///
+		/// @return True if disabled or the current border is consistent
+		///
+		bool isSettled() const;
+
 	private slots:
 		///
 		/// @brief Handle settings update from Hyperion Settingsmanager emit or this constructor
@@ -113,6 +119,28 @@ namespace hyperion
 		/// Hyperion instance
 		Hyperion* _hyperion;
 
+		///
+		/// Detects the border of a single image with the current detection mode
+		///
+		template <typename Pixel_T>
+		BlackBorder detect(const Image<Pixel_T> & image) const
+		{
+			return _detector->process(image, _detectionMode);
+		}
+
+		///
+		/// Captured frames shared by several instances get their border detected once per frame
+		///
+		BlackBorder detect(const Image<ColorRgb> & image) const
+		{
+			const std::shared_ptr<FrameAnalysis> analysis = FrameAnalysis::get(image);
+			if (analysis == nullptr)
+			{
+				return _detector->process(image, _detectionMode);
+			}
+			return analysis->blackBorder(*_detector, _detectionMode);
+		}
+
 		///
 		/// Updates the current border based on the newly detected border. Returns true if the
 		/// current border has changed.
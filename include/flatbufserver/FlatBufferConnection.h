@@ -21,6 +21,8 @@ namespace hyperionnet
 struct Reply;
 }
 
+class SharedMemoryRing;
+
 ///
 /// Connection class to setup an connection to the hyperion server and execute commands.
 ///
@@ -52,6 +54,15 @@ public:
 	///
 	void setRegister(const QString& origin, int priority);
 
+	///
+	/// @brief Set the encoding of images sent via TCP, less bytes per pixel or compression for slow networks
+	/// The server has to support it, the default (rgb24, none) is understood by all servers
+	/// @param format       The pixel format: rgb24, rgb565, nv12 or i420
+	/// @param compression  The compression: none, zlib or jpeg (the pixel format is ignored then)
+	/// @return False, if unknown
+	///
+	bool setImageEncoding(const QString& format, const QString& compression);
+
 	///
 	/// @brief Set all leds to the specified color
 	/// @param color The color
@@ -80,6 +91,7 @@ public:
 public slots:
 	///
 	/// @brief Set the leds according to the given image
+	/// The image is passed via shared memory, if the server runs on the same host and provides it
 	/// @param image The image
 	///
 	void setImage(const Image<ColorRgb> &image);
@@ -111,6 +123,18 @@ private:
 	///
 	bool parseReply(const hyperionnet::Reply *reply);
 
+	///
+	/// @brief Pass an image via the shared memory of a local server
+	/// @param image The image
+	/// @return False, if the image has to be sent via TCP
+	///
+	bool setSharedMemoryImage(const Image<ColorRgb> &image);
+
+	///
+	/// @brief Give the shared memory channel back and detach, e.g. when the connection is lost
+	///
+	void detachSharedMemory();
+
 private:
 	/// The TCP-Socket with the connection to the server
 	QTcpSocket _socket;
@@ -134,4 +158,17 @@ private:
 	flatbuffers::FlatBufferBuilder _builder;
 
 	bool _registered;
+
+	/// Shared memory of a local server and the channel claimed
+	SharedMemoryRing* _sharedMemory;
+	int _sharedMemoryChannel;
+	/// Was attaching to the shared memory tried for the current connection?
+	bool _sharedMemoryTried;
+
+	/// The encoding of images (hyperionnet::ImageFormat, hyperionnet::ImageCompression)
+	int8_t _imageFormat;
+	int8_t _imageCompression;
+
+	/// The encoded image, reused between images
+	QByteArray _encodedImage;
 };
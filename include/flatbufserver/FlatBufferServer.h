@@ -4,18 +4,28 @@
 #include <utils/Logger.h>
 #include <utils/settings.h>
 
+// util
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+#include <utils/Components.h>
+
 // qt
 #include <QVector>
+#include <QMap>
 
 class BonjourServiceRegister;
 class QTcpServer;
 class FlatBufferClient;
+class FlatBufferImageDecoder;
+class SharedMemoryServer;
 class NetOrigin;
 
 
 ///
 /// @brief A TcpServer to receive images of different formats with Google Flatbuffer
 /// Images will be forwarded to all Hyperion instances
+/// Clients on the same host may send their images via shared memory, see SharedMemoryServer
+/// Encoded (converted or compressed) images are decoded on a worker thread, see FlatBufferImageDecoder
 ///
 class FlatBufferServer : public QObject
 {
@@ -45,7 +55,28 @@ private slots:
 	///
 	void clientDisconnected();
 
+	///
+	/// @brief Forward an image received via shared memory or decoded by the worker thread,
+	/// if the priority is registered by a connected client
+	/// @param priority  The priority of the producer
+	/// @param image     The image
+	/// @param duration  The duration in milliseconds
+	///
+	void handleClientImage(int priority, const Image<ColorRgb>& image, int duration);
+
+	///
+	/// @brief Handle the standby state of an input of a Hyperion instance.
+	/// The clients of a priority hidden in all instances take keep-alive images only
+	///
+	void handleInputStandby(int hyperionInd, int priority, hyperion::Components component, bool standby);
+
 private:
+	///
+	/// @brief Apply the standby state of a priority to its clients
+	/// @param priority  The priority
+	///
+	void updateClientStandby(int priority);
+
 	///
 	/// @brief Start the server with current _port
 	///
@@ -59,12 +90,18 @@ private:
 
 private:
 	QTcpServer* _server;
+	SharedMemoryServer* _sharedMemoryServer;
+	FlatBufferImageDecoder* _imageDecoder;
 	NetOrigin* _netOrigin;
 	Logger* _log;
 	int _timeout;
 	quint16 _port;
+	bool _sharedMemory;
 	const QJsonDocument _config;
 	BonjourServiceRegister * _serviceRegister = nullptr;
 
 	QVector<FlatBufferClient*> _openConnections;
+
+	/// The standby state of the flatbuffer priorities by instance
+	QMap<int, QMap<int, bool>> _inputStandby;
 };
@@ -3,6 +3,7 @@
 // stl includes
 #include <vector>
 #include <map>
+#include <memory>
 
 // Qt includes
 #include <QObject>
@@ -10,29 +11,20 @@
 #include <QRectF>
 #include <QMap>
 #include <QMultiMap>
+#include <QElapsedTimer>
 
 // util includes
 #include <utils/PixelFormat.h>
 #include <hyperion/Grabber.h>
+#include <hyperion/ImageToLedsMap.h>
+#include <hyperion/LedString.h>
 #include <grabber/VideoStandard.h>
 #include <utils/Components.h>
 #include <cec/CECEvent.h>
 
-// general JPEG decoder includes
+// MJPEG decoder
 #ifdef HAVE_JPEG_DECODER
-	#include <QImage>
-	#include <QColor>
-#endif
-
-// System JPEG decoder
-#ifdef HAVE_JPEG
-	#include <jpeglib.h>
-	#include <csetjmp>
-#endif
-
-// TurboJPEG decoder
-#ifdef HAVE_TURBO_JPEG
-	#include <turbojpeg.h>
+	class MjpegDecoder;
 #endif
 
 /// Capture class for V4L2 devices
@@ -150,6 +142,28 @@ public:
 	///
 	QStringList getFramerates(const QString& devicePath) const override;
 
+	///
+	/// @brief Map frames directly to led colors for the given instance (direct mapping)
+	/// @param hyperionInd The Hyperion instance index
+	/// @param leds        The led layout of the instance, an empty layout removes the instance
+	/// @param mappingType The image to led mapping type of the instance
+	///
+	void setDirectMapping(int hyperionInd, const std::vector<Led>& leds, int mappingType);
+
+	///
+	/// @brief Set if a listener requires an image of every frame. If not, frames are just mapped to led
+	/// 	   colors for the direct mapped instances
+	/// @param required  True if the image is required
+	///
+	void setImageRequired(bool required);
+
+	///
+	/// @brief Process only one frame per interval, while all listeners show a higher priority. Frames in between
+	/// 	   are neither decoded nor resampled
+	/// @param interval_ms  The interval in milliseconds, 0 to process every frame
+	///
+	void setStandbyInterval(int interval_ms);
+
 public slots:
 
 	bool start();
@@ -160,11 +174,17 @@ public slots:
 
 signals:
 	void newFrame(const Image<ColorRgb> & image);
+	void newLedColors(int hyperionInd, const std::vector<ColorRgb>& ledColors);
 	void readError(const char* err);
 
 private slots:
 	int read_frame();
 
+	///
+	/// @brief Handle a frame of the MJPEG decoder, outdated frames are dropped
+	///
+	void handleDecodedFrame(quint64 sequence, const Image<ColorRgb> & image);
+
 private:
 	void getV4Ldevices();
 
@@ -194,6 +214,21 @@ private:
 
 	void process_image(const uint8_t *p, int size);
 
+	///
+	/// @brief Run the signal detection on a captured image and forward it
+	///
+	void processFrame(const Image<ColorRgb> & image);
+
+	///
+	/// @brief Emit the image and the led colors of the direct mapped instances
+	///
+	void forwardFrame(const Image<ColorRgb> & image);
+
+	///
+	/// @brief Emit the led colors of the direct mapped instances mapped from the raw frame
+	///
+	void forwardLedColors(const uint8_t * data);
+
 	int xioctl(int request, void *arg);
 
 	int xioctl(int fileDescriptor, int request, void *arg);
@@ -222,31 +257,9 @@ private:
 			size_t  length;
 	};
 
-#ifdef HAVE_JPEG
-	struct errorManager
-	{
-		jpeg_error_mgr pub;
-		jmp_buf setjmp_buffer;
-	};
-
-	static void errorHandler(j_common_ptr cInfo)
-	{
-		errorManager* mgr = reinterpret_cast<errorManager*>(cInfo->err);
-		longjmp(mgr->setjmp_buffer, 1);
-	}
-
-	static void outputHandler(j_common_ptr cInfo)
-	{
-		// Suppress fprintf warnings.
-	}
-
-	jpeg_decompress_struct* _decompress;
-	errorManager* _error;
-#endif
-
-#ifdef HAVE_TURBO_JPEG
-	tjhandle _decompress = nullptr;
-	int _subsamp;
+#ifdef HAVE_JPEG_DECODER
+	MjpegDecoder* _mjpegDecoder = nullptr;
+	quint64 _mjpegSequence = 0;
 #endif
 
 private:
@@ -279,6 +292,28 @@ private:
 
 	QSocketNotifier *_streamNotifier;
 
+	/// Led layout of an instance that receives led colors instead of images
+	struct DirectMapping
+	{
+		std::vector<Led> leds;
+		int mappingType;
+		std::unique_ptr<hyperion::ImageToLedsMap> map;
+		std::vector<ColorRgb> ledColors;
+
+		/// Get the led mapping for the given image size, (re)build it on size changes
+		const hyperion::ImageToLedsMap& getMap(unsigned width, unsigned height);
+	};
+
+	/// Direct mapped instances by instance index
+	std::map<int, DirectMapping> _directMappings;
+
+	/// A listener requires the image of every frame
+	bool _imageRequired;
+
+	/// Frames are processed once per interval while all listeners show a higher priority
+	int _standbyInterval_ms;
+	QElapsedTimer _standbyTimer;
+
 	bool _initialized;
 	bool _deviceAutoDiscoverEnabled;
 
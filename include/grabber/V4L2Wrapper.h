@@ -3,6 +3,9 @@
 #include <hyperion/GrabberWrapper.h>
 #include <grabber/V4L2Grabber.h>
 
+// qt
+#include <QSet>
+
 class V4L2Wrapper : public GrabberWrapper
 {
 	Q_OBJECT
@@ -36,11 +39,39 @@ public slots:
 
 private slots:
 	void newFrame(const Image<ColorRgb> & image);
+	void newLedColors(int hyperionInd, const std::vector<ColorRgb>& ledColors);
 	void readError(const char* err);
 
+	///
+	/// @brief Track the instances which listen to the v4l capture
+	///
+	void handleV4lSourceRequest(hyperion::Components component, int hyperionInd, bool listen);
+
+	///
+	/// @brief Map frames directly to led colors for an instance or return to images if leds is empty
+	///
+	void handleDirectMappingRequest(int hyperionInd, const std::vector<Led>& leds, int mappingType);
+
 	void action() override;
 
+protected:
+	///
+	/// @brief Process keep-alive frames only while all listeners show a higher priority
+	///
+	void setStandby(bool standby) override;
+
 private:
 	/// The V4L2 grabber
 	V4L2Grabber _grabber;
+
+	/// Instances which listen to the v4l capture
+	QSet<int> _listeners;
+
+	/// Instances which receive direct mapped led colors instead of images
+	QSet<int> _directMapped;
+
+	///
+	/// @brief An image is required as long as one listener is not direct mapped
+	///
+	void updateImageRequired();
 };
@@ -4,6 +4,9 @@
 #include <utils/settings.h>
 #include <utils/Components.h>
 #include <utils/Image.h>
+#include <utils/FrameMailbox.h>
+
+#include <QMutex>
 
 class Hyperion;
 class QTimer;
@@ -17,10 +20,18 @@ class CaptureCont : public QObject
 	Q_OBJECT
 public:
 	CaptureCont(Hyperion* hyperion);
+	~CaptureCont() override;
 
 	void setSystemCaptureEnable(bool enable);
 	void setV4LCaptureEnable(bool enable);
 
+	///
+	/// @brief Get the number of captured frames which were replaced by a newer one before this instance processed them
+	/// @param component  COMP_GRABBER or COMP_V4L
+	/// @return The number of dropped frames
+	///
+	quint64 getDroppedFrames(hyperion::Components component) const;
+
 private slots:
 	///
 	/// @brief Handle component state change of V4L and SystemCapture
@@ -36,6 +47,16 @@ private slots:
 	///
 	void handleSettingsUpdate(settings::type type, const QJsonDocument& config);
 
+	///
+	/// @brief Process the latest system image of the mailbox
+	///
+	void processSystemImage();
+
+	///
+	/// @brief Process the latest v4l image of the mailbox
+	///
+	void processV4lImage();
+
 	///
 	/// @brief forward system image
 	/// @param image  The image
@@ -48,6 +69,29 @@ private slots:
 	///
 	void handleV4lImage(const QString& name, const Image<ColorRgb> & image);
 
+	///
+	/// @brief forward v4l led colors of direct mapping
+	/// @param name         The name of the v4l capture
+	/// @param hyperionInd  The instance the led colors are mapped for
+	/// @param ledColors    The led colors
+	///
+	void handleV4lLedColors(const QString& name, int hyperionInd, const std::vector<ColorRgb>& ledColors);
+
+	///
+	/// @brief Request or cancel direct mapping of v4l frames to led colors, depending on the settings and
+	/// 	   whether a consumer requires the image
+	/// @param force   Send the request even if the state did not change (e.g. on led layout changes)
+	///
+	void updateV4lDirectMapping(bool force = false);
+
+	///
+	/// @brief Handle the standby state of the capture inputs, hidden captures send keep-alive images only
+	/// @param priority   The priority of the input
+	/// @param component  The component of the input
+	/// @param standby    True if the input is hidden by a higher priority
+	///
+	void handleInputStandby(int priority, hyperion::Components component, bool standby);
+
 	///
 	/// @brief Is called from _v4lInactiveTimer to set source after specific time to inactive
 	///
@@ -59,18 +103,49 @@ private slots:
 	void setSystemInactive();
 
 private:
+	/// A captured image with the name of its capture
+	struct CapturedImage
+	{
+		QString name;
+		Image<ColorRgb> image;
+	};
+
+	///
+	/// @brief Put a system image into the mailbox, called in the thread of the capture
+	///
+	void queueSystemImage(const QString& name, const Image<ColorRgb>& image);
+
+	///
+	/// @brief Put a v4l image into the mailbox, called in the thread of the capture
+	///
+	void queueV4lImage(const QString& name, const Image<ColorRgb>& image);
+
 	/// Hyperion instance
 	Hyperion* _hyperion;
 
+	/// Latest captured images which are not processed yet, images are not queued in the event loop
+	FrameMailbox<CapturedImage> _systemImages;
+	FrameMailbox<CapturedImage> _v4lImages;
+
+	/// Guards the mailboxes against the capture threads, which put images directly, and the destruction
+	QMutex _captureLock;
+	bool _closing;
+
 	/// Reflect state of System capture and prio
 	bool _systemCaptEnabled;
 	quint8 _systemCaptPrio;
 	QString _systemCaptName;
 	QTimer* _systemInactiveTimer;
+	bool _systemCaptStandby;
 
 	/// Reflect state of v4l capture and prio
 	bool _v4lCaptEnabled;
 	quint8 _v4lCaptPrio;
 	QString _v4lCaptName;
 	QTimer* _v4lInactiveTimer;
+	bool _v4lCaptStandby;
+
+	/// Reflect state of v4l direct mapping (configured and currently active)
+	bool _v4lDirectMappingEnabled;
+	bool _v4lDirectMapping;
 };
@@ -7,6 +7,9 @@
 #include <utils/RgbChannelAdjustment.h>
 #include <utils/RgbTransform.h>
 
+// Hyperion includes
+#include <hyperion/ColorLut.h>
+
 class ColorAdjustment
 {
 public:
@@ -31,4 +34,7 @@ public:
 	RgbChannelAdjustment _rgbYellowAdjustment;
 
 	RgbTransform _rgbTransform;
+
+	/// The baked adjustment, used if enabled by MultiColorAdjustment
+	ColorLut _lut;
 };
@@ -0,0 +1,111 @@
+#pragma once
+
+// STL includes
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+
+///
+/// A 3D lookup table of a color transformation. The transformation is evaluated for size^3 evenly
+/// distributed input colors, all other colors are interpolated tetrahedral between the 4 surrounding nodes.
+///
+class ColorLut
+{
+public:
+	ColorLut();
+
+	///
+	/// @param size  The number of nodes per channel
+	/// @return True if the table is built with the given number of nodes
+	///
+	bool isValid(int size) const { return _size == size; }
+
+	///
+	/// Discards the table, it has to be built again before it is applied
+	///
+	void invalidate();
+
+	///
+	/// Evaluates the transformation for the next nodes of the table, a table is built over several calls
+	/// to spread the work. The build starts over if the size changes or the table is invalidated.
+	///
+	/// @param size       The number of nodes per channel (2..256)
+	/// @param transform  The color transformation, called with every node color to be updated in place
+	/// @param maxNodes   The number of nodes to evaluate at most, at least one plane of size^2 nodes is evaluated
+	///
+	/// @return True if the table is built with the given number of nodes
+	///
+	template <typename Transform_T>
+	bool build(int size, Transform_T transform, size_t maxNodes)
+	{
+		if (_buildSize != size)
+		{
+			initNodes(size);
+			_table.resize(static_cast<size_t>(size) * size * size);
+			_size = 0;
+			_buildSize = size;
+			_buildPlane = 0;
+		}
+
+		const size_t planeNodes = static_cast<size_t>(size) * size;
+		const int planes = static_cast<int>(std::max<size_t>(1, maxNodes / planeNodes));
+		const int end = std::min(size, _buildPlane + planes);
+
+		ColorRgb* node = _table.data() + _buildPlane * planeNodes;
+		for (int r = _buildPlane; r < end; ++r)
+		{
+			for (int g = 0; g < size; ++g)
+			{
+				for (int b = 0; b < size; ++b, ++node)
+				{
+					*node = ColorRgb{_nodeValues[r], _nodeValues[g], _nodeValues[b]};
+					transform(*node);
+				}
+			}
+		}
+
+		_buildPlane = end;
+		if (_buildPlane == size)
+		{
+			_size = size;
+		}
+		return isValid(size);
+	}
+
+	///
+	/// Transforms the given colors in place
+	///
+	/// @param colors  The first color
+	/// @param count   The number of colors
+	///
+	void apply(ColorRgb* colors, size_t count) const;
+
+private:
+	///
+	/// Computes the node values and the interpolation position of every channel value
+	///
+	void initNodes(int size);
+
+	/// The number of nodes per channel, 0 if not built
+	int _size;
+
+	/// The number of nodes per channel of the table being built, 0 if none
+	int _buildSize;
+
+	/// The next red plane of the table being built
+	int _buildPlane;
+
+	/// The transformed node colors, indexed by (r * size + g) * size + b
+	std::vector<ColorRgb> _table;
+
+	/// The channel value of every node
+	std::vector<uint8_t> _nodeValues;
+
+	/// The node below every channel value and the weight (0..256) of the node above
+	uint8_t _lowerNode[256];
+	uint16_t _weight[256];
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <vector>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+
+// Hyperion includes
+#include <hyperion/LedString.h>
+
+///
+/// The ColorOrderMap converts the adjusted led colors to the byte order of every led. The led string is
+/// partitioned into runs of leds with the same color order, which are converted in one go.
+///
+class ColorOrderMap
+{
+public:
+	ColorOrderMap();
+
+	///
+	/// Partitions the leds into runs of equal color order
+	///
+	/// @param leds  The leds of the led string
+	///
+	void setLeds(const std::vector<Led>& leds);
+
+	///
+	/// Converts the colors to the byte order of the leds and fills up additional hardware leds with black.
+	/// Colors beyond the led string are copied unchanged.
+	///
+	/// @param[in]  colors      The colors in RGB order
+	/// @param[in]  hwLedCount  The number of leds of the device
+	/// @param[out] output      The colors in led order, resized to max(colors.size(), hwLedCount)
+	///
+	void apply(const std::vector<ColorRgb>& colors, size_t hwLedCount, std::vector<ColorRgb>& output) const;
+
+private:
+	/// Consecutive leds with the same color order
+	struct Run
+	{
+		size_t begin;
+		size_t end;
+		ColorOrder order;
+	};
+
+	std::vector<Run> _runs;
+
+	/// The number of leds of the led string
+	size_t _ledCount;
+};
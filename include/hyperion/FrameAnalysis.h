@@ -0,0 +1,212 @@
+#pragma once
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// QT includes
+#include <QMutex>
+#include <QString>
+
+// Utils includes
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+// Blackborder includes
+#include <blackborder/BlackBorderDetector.h>
+
+namespace hyperion
+{
+	///
+	/// The layout of a summed area table which holds only the rows read by a set of rectangular areas.
+	/// The sum of an area only needs the table rows at its top and bottom edge, so just these rows are
+	/// stored and only the rows and columns covered by any area are integrated.
+	///
+	struct SummedAreaLayout
+	{
+		/// The image rows [0 .. height] whose sums are stored, ascending
+		std::vector<unsigned> tableRows;
+
+		/// The image rows covered by any area, up to the last table row
+		std::vector<bool> coveredRows;
+
+		/// The columns covered by any area, given as half-open interval [min, max)
+		unsigned coveredMinX;
+		unsigned coveredMaxX;
+
+		bool operator==(const SummedAreaLayout & other) const
+		{
+			return coveredMinX == other.coveredMinX && coveredMaxX == other.coveredMaxX
+				&& tableRows == other.tableRows && coveredRows == other.coveredRows;
+		}
+	};
+
+	///
+	/// The FrameAnalysis holds the results of a captured frame which do not depend on the Hyperion instance,
+	/// the summed area tables used by the led mapping and the detected black borders.
+	///
+	/// Captured frames are handed to all instances as the same implicitly shared image. The capture control adds
+	/// a frame which is captured by several instances, those get the same FrameAnalysis, so every result is computed
+	/// once per frame and read by all of them. Other images (effects, flatbuffer and JSON clients) are not added and
+	/// analysed by their instance alone. The analysis keeps a reference to its frame, a writer of the image detaches
+	/// from it (copy on write), hence the analysed pixels never change.
+	///
+	class FrameAnalysis
+	{
+	public:
+		///
+		/// Add a captured frame which is shared by several instances. The analyses of the latest frames are kept
+		/// as long as they fit into a memory budget, a frame is added once for all instances.
+		///
+		/// @param[in] image  The frame
+		///
+		static void add(const Image<ColorRgb> & image);
+
+		///
+		/// Get the analysis of the given frame, if the image shares its pixels with a frame added before.
+		///
+		/// @param[in] image  The frame
+		///
+		/// @return The analysis of the frame, or null if the frame was not added (or is not kept anymore)
+		///
+		static std::shared_ptr<FrameAnalysis> get(const Image<ColorRgb> & image);
+
+		///
+		/// Returns the summed area table of the frame for the given layout, which is computed on first use.
+		/// Instances with the same led layout share the table. See integrate() for the layout of the table.
+		///
+		/// @param[in] layout  The rows and columns to integrate
+		///
+		/// @return The summed area table
+		///
+		const std::vector<uint32_t> & summedAreaTable(const std::shared_ptr<const SummedAreaLayout> & layout);
+
+		///
+		/// Returns the black border detected in the frame, which is computed on first use for every
+		/// detector threshold and mode.
+		///
+		/// @param[in] detector  The black border detector
+		/// @param[in] mode      The detection mode
+		///
+		/// @return The detected (or not detected) black border info
+		///
+		BlackBorder blackBorder(const BlackBorderDetector & detector, const QString & mode);
+
+		///
+		/// Integrates the covered pixels of an image into a summed area table of the given layout. The table holds
+		/// (width+1) interleaved RGB sums for every table row, each of them the sum of all covered pixels above
+		/// and left of it. Pixels outside of the covered rows and columns are left out, which does not change the
+		/// sum of any area inside of them. The sums wrap around on overflow, as the differences of an area are exact
+		/// in modular arithmetic as long as the area sums up to less than 2^32 per channel (which holds for every
+		/// area up to 16.8M pixels).
+		///
+		/// @param[in]  layout      The rows and columns to integrate
+		/// @param[in]  width       The width of the image
+		/// @param[in]  row         Returns the covered pixels of an image row, starting at column coveredMinX
+		/// @param[out] summedArea  The summed area table
+		///
+		template <typename RowFunction>
+		static void integrate(const SummedAreaLayout & layout, unsigned width, RowFunction row, std::vector<uint32_t> & summedArea)
+		{
+			const size_t stride = static_cast<size_t>(width + 1) * 3;
+			const size_t first = static_cast<size_t>(layout.coveredMinX + 1) * 3;
+			const unsigned count = layout.coveredMaxX - layout.coveredMinX;
+			summedArea.resize(stride * layout.tableRows.size());
+			if (summedArea.empty())
+			{
+				return;
+			}
+
+			// the sums above the first image row are zero, every table row continues from the one above
+			uint32_t* current = summedArea.data();
+			std::fill(current, current + stride, 0);
+
+			unsigned y = 0;
+			for (size_t tableRow = 0; tableRow < layout.tableRows.size(); ++tableRow)
+			{
+				if (tableRow > 0)
+				{
+					std::copy(current, current + stride, current + stride);
+					current += stride;
+				}
+
+				for (; y < layout.tableRows[tableRow]; ++y)
+				{
+					// a row outside of all areas adds nothing
+					if (!layout.coveredRows[y] || count == 0)
+					{
+						continue;
+					}
+
+					// the columns left of the covered ones add nothing, the ones right of them the sum of the row
+					const auto* pixel = row(y);
+					uint32_t rowRed   = 0;
+					uint32_t rowGreen = 0;
+					uint32_t rowBlue  = 0;
+					size_t x = first;
+					for (unsigned i = 0; i < count; ++i, ++pixel, x += 3)
+					{
+						rowRed   += pixel->red;
+						rowGreen += pixel->green;
+						rowBlue  += pixel->blue;
+						current[x]   += rowRed;
+						current[x+1] += rowGreen;
+						current[x+2] += rowBlue;
+					}
+					for (; x < stride; x += 3)
+					{
+						current[x]   += rowRed;
+						current[x+1] += rowGreen;
+						current[x+2] += rowBlue;
+					}
+				}
+			}
+		}
+
+		///
+		/// Integrates the covered pixels of the given image into a summed area table of the given layout,
+		/// see integrate() above.
+		///
+		/// @param[in]  layout      The rows and columns to integrate
+		/// @param[in]  image       The image to integrate
+		/// @param[out] summedArea  The summed area table
+		///
+		template <typename Pixel_T>
+		static void integrate(const SummedAreaLayout & layout, const Image<Pixel_T> & image, std::vector<uint32_t> & summedArea)
+		{
+			const Pixel_T* imgData = image.memptr();
+			const unsigned width = image.width();
+			integrate(layout, width, [imgData, width, &layout](unsigned y) {
+				return imgData + static_cast<size_t>(y) * width + layout.coveredMinX;
+			}, summedArea);
+		}
+
+	private:
+		explicit FrameAnalysis(const Image<ColorRgb> & image);
+
+		/// Find the analysis of the given frame, the caller holds the lock of the kept analyses
+		static std::shared_ptr<FrameAnalysis> find(const Image<ColorRgb> & image);
+
+		/// The analysed frame
+		const Image<ColorRgb> _image;
+
+		/// Guards the lazily computed results
+		QMutex _mutex;
+
+		/// The summed area tables of the frame per layout, the entries are never moved
+		std::list<std::pair<std::shared_ptr<const SummedAreaLayout>, std::vector<uint32_t>>> _summedAreas;
+
+		/// The detected borders per detector threshold and mode
+		std::map<std::pair<uint8_t, QString>, BlackBorder> _blackBorders;
+
+		/// The bytes held by the frame and its summed area tables
+		std::atomic<size_t> _memoryUsage;
+	};
+
+} // end namespace hyperion
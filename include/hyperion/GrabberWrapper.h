@@ -6,6 +6,7 @@
 #include <QString>
 #include <QStringList>
 #include <QMultiMap>
+#include <QSet>
 
 #include <utils/Logger.h>
 #include <utils/Components.h>
@@ -36,6 +37,9 @@ public:
 	static GrabberWrapper* instance;
 	static GrabberWrapper* getInstance(){ return instance; }
 
+	/// The capture interval while all listening instances show a higher priority [ms]
+	const static int STANDBY_INTERVAL_MS;
+
 	///
 	/// Starts the grabber which produces led values with the specified update rate
 	///
@@ -157,6 +161,12 @@ private slots:
 	/// Will start and stop grabber based on active listeners count
 	void handleSourceRequest(hyperion::Components component, int hyperionInd, bool listen);
 
+	///
+	/// @brief Handle the standby state of an input of a Hyperion instance.
+	/// Will capture at the keep-alive rate while the capture is hidden in all listening instances
+	///
+	void handleInputStandby(int hyperionInd, int priority, hyperion::Components component, bool standby);
+
 	///
 	/// @brief Update Update capture rate
 	/// @param type   interval between frames in millisecons
@@ -164,6 +174,12 @@ private slots:
 	void updateTimer(int interval);
 
 protected:
+	///
+	/// @brief Capture at the keep-alive rate while all listening instances show a higher priority
+	/// @param standby  True to capture at the keep-alive rate
+	///
+	virtual void setStandby(bool standby);
+
 	QString _grabberName;
 
 	/// The timer for generating events with the specified update rate
@@ -179,4 +195,16 @@ protected:
 
 	/// The image used for grabbing frames
 	Image<ColorRgb> _image;
+
+private:
+	///
+	/// @brief Enter or leave standby after the listeners or their standby states changed
+	///
+	void updateStandby();
+
+	/// Instances which hide the capture by a higher priority
+	QSet<int> _standbyClients;
+
+	/// Is the capture hidden in all listening instances?
+	bool _standby;
 };
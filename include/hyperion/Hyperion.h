@@ -22,6 +22,7 @@
 #include <hyperion/LedString.h>
 #include <hyperion/PriorityMuxer.h>
 #include <hyperion/ColorAdjustment.h>
+#include <hyperion/ColorOrderMap.h>
 #include <hyperion/ComponentRegister.h>
 
 // Effect engine includes
@@ -45,6 +46,7 @@ class MultiColorAdjustment;
 class ColorAdjustment;
 class SettingsManager;
 class BGEffectHandler;
+class ImageStream;
 class CaptureCont;
 class BoblightServer;
 class LedDeviceWrapper;
@@ -73,6 +75,11 @@ public:
 
 	ImageProcessor* getImageProcessor() const { return _imageProcessor; }
 
+	///
+	/// @brief Get the live image preview, encoded once for all API clients on its own thread
+	///
+	ImageStream* getImageStream() const { return _imageStream; }
+
 	///
 	/// @brief Get instance index of this instance
 	/// @return The index of this instance
@@ -84,12 +91,42 @@ public:
 	///
 	QSize getLedGridSize() const { return _ledGridSize; }
 
+	///
+	/// @brief Return the led string specification (led areas and color order)
+	///
+	const LedString& getLedString() const { return _ledString; }
+
+	///
+	/// @brief Check if any consumer requires the pixels of the current image (image stream, forwarder)
+	/// @return True if the image is required, false if led colors are sufficient
+	///
+	bool hasImageConsumers() const;
+
+	///
+	/// @brief Get the number of captured frames which were replaced by a newer one before they were processed
+	/// @param component  COMP_GRABBER or COMP_V4L
+	/// @return The number of dropped frames
+	///
+	quint64 getCaptureDroppedFrames(hyperion::Components component) const;
+
+	///
+	/// @brief Get the deviation of the smoothed device writes from their schedule
+	/// @return The smoothing statistics
+	///
+	QJsonObject getSmoothingStatistics() const;
+
+	///
+	/// @brief Get the frames queued, dropped and written by the LED device and its write latency
+	/// @return The LED device statistics
+	///
+	QJsonObject getLedDeviceStatistics() const;
+
 	/// gets the methode how image is maped to leds
 	int getLedMappingType() const;
 
-	/// forward smoothing config
-	unsigned addSmoothingConfig(int settlingTime_ms, double ledUpdateFrequency_hz=25.0, unsigned updateDelay=0);
-	unsigned updateSmoothingConfig(unsigned id, int settlingTime_ms=200, double ledUpdateFrequency_hz=25.0, unsigned updateDelay=0);
+	/// forward smoothing config, the type is named as in the smoothing settings
+	unsigned addSmoothingConfig(int settlingTime_ms, double ledUpdateFrequency_hz=25.0, unsigned updateDelay=0, const QString& smoothingType="linear");
+	unsigned updateSmoothingConfig(unsigned id, int settlingTime_ms=200, double ledUpdateFrequency_hz=25.0, unsigned updateDelay=0, const QString& smoothingType="linear");
 
 	VideoMode getCurrentVideoMode() const;
 
@@ -167,6 +204,15 @@ public slots:
 	///
 	bool setInputInactive(quint8 priority);
 
+	///
+	/// @brief Set how a priority is composited onto the priorities below it
+	/// @param priority   The priority
+	/// @param blendMode  The blend mode, see PriorityMuxer::BlendMode
+	/// @param opacity    The opacity of the priority (0-255)
+	/// @return True on success false if not found
+	///
+	bool setInputBlending(int priority, int blendMode, int opacity);
+
 	///
 	/// Returns the list with unique adjustment identifiers
 	/// @return The list with adjustment identifiers
@@ -410,6 +456,11 @@ signals:
 	/// Signal which is emitted, when a new V4l proto image should be forwarded
 	void forwardV4lProtoMessage(const QString&, const Image<ColorRgb>&);
 
+	///
+	/// @brief Emits whenever a consumer of the images connected or disconnected, see hasImageConsumers()
+	///
+	void imageConsumersChanged();
+
 	///
 	/// @brief Is emitted from clients who request a videoMode change
 	///
@@ -479,6 +530,13 @@ private slots:
 
 	void handlePriorityChangedLedDevice(const quint8& priority);
 
+protected:
+	///
+	/// @brief Notify about connected and disconnected image consumers, see imageConsumersChanged()
+	///
+	void connectNotify(const QMetaMethod& signal) override;
+	void disconnectNotify(const QMetaMethod& signal) override;
+
 private:
 	friend class HyperionDaemon;
 	friend class HyperionIManager;
@@ -489,6 +547,13 @@ private:
 	///
 	Hyperion(quint8 instance, bool readonlyMode = false);
 
+	///
+	/// @brief Map the image of a layer blended onto the current priority to led colors
+	/// @param  layerInfo  The input of the layer
+	/// @return The led colors
+	///
+	std::vector<ColorRgb> processLayerImage(const PriorityMuxer::InputInfo& layerInfo);
+
 	/// instance index
 	const quint8 _instIndex;
 
@@ -504,7 +569,11 @@ private:
 	/// Image Processor
 	ImageProcessor* _imageProcessor;
 
-	std::vector<ColorOrder> _ledStringColorOrder;
+	/// Image Processor of the image layers blended onto the current priority, created on first use
+	ImageProcessor* _layerProcessor;
+
+	/// The color order of the leds
+	ColorOrderMap _colorOrderMap;
 
 	/// The priority muxer
 	PriorityMuxer _muxer;
@@ -537,9 +606,23 @@ private:
 	/// Capture control for Daemon native capture
 	CaptureCont* _captureCont;
 
+	/// The live image preview
+	ImageStream* _imageStream;
+
 	/// buffer for leds (with adjustment)
 	std::vector<ColorRgb> _ledBuffer;
 
+	/// buffer for the led colors of a blended layer
+	std::vector<ColorRgb> _layerBuffer;
+
+	/// buffer for the device (in led color order, filled up to the hardware led count)
+	std::vector<ColorRgb> _ledOutput;
+
+	/// The colors and smoothing config last written to the device, an unchanged update is skipped
+	std::vector<ColorRgb> _lastLedOutput;
+	unsigned _lastSmoothCfg;
+	bool _ledOutputValid;
+
 	VideoMode _currVideoMode = VideoMode::VIDEO_2D;
 
 	/// Boblight instance
@@ -1,5 +1,8 @@
 #pragma once
 
+// STL includes
+#include <vector>
+
 #include <QString>
 
 // Utils includes
@@ -65,6 +68,18 @@ public:
 	static int mappingTypeToInt(const QString& mappingType);
 	static QString mappingTypeToStr(int mappingType);
 
+	/// Returns the current engine used to compute the mean color per led
+	hyperion::MappingEngine ledMappingEngine() const { return _mappingEngine; }
+
+	static hyperion::MappingEngine mappingEngineFromStr(const QString& mappingEngine);
+	static QString mappingEngineToStr(hyperion::MappingEngine mappingEngine);
+
+	///
+	/// @brief Set the engine used to compute the mean color per led, the led mapping is rebuilt on change
+	/// @param  mappingEngine   The new mapping engine
+	///
+	void setLedMappingEngine(hyperion::MappingEngine mappingEngine);
+
 	///
 	/// @brief Set the Hyperion::update() request LED mapping type. This type is used in favour of type set with setLedMappingType.
 	/// 	   If you don't want to force a mapType set this to -1 (user choice will be set)
@@ -111,6 +126,12 @@ public:
 		std::vector<ColorRgb> colors;
 		if (image.width()>0 && image.height()>0)
 		{
+			// The same image results in the same colors as long as mapping and border are unchanged
+			if (isLastFrame(image))
+			{
+				return _lastColors;
+			}
+
 			// Ensure that the buffer-image is the proper size
 			setSize(image);
 
@@ -123,6 +144,8 @@ public:
 				case 1: colors = _imageToLeds->getUniLedColor(image); break;
 				default: colors = _imageToLeds->getMeanLedColor(image);
 			}
+
+			setLastFrame(image, colors);
 		}
 		else
 		{
@@ -175,6 +198,37 @@ public:
 	bool getScanParameters(size_t led, double & hscanBegin, double & hscanEnd, double & vscanBegin, double & vscanEnd) const;
 
 private:
+	///
+	/// Checks if the image equals the last processed frame and its colors are still valid, i.e. the mapping
+	/// was not rebuilt and the black border detection is settled. Only RGB images are remembered.
+	///
+	/// @param[in] image  The image to check
+	///
+	/// @return True if the colors of the last frame can be reused
+	///
+	template <typename Pixel_T>
+	bool isLastFrame(const Image<Pixel_T>& /*image*/) const
+	{
+		return false;
+	}
+
+	bool isLastFrame(const Image<ColorRgb>& image) const;
+
+	///
+	/// Remembers the processed frame and its colors, see isLastFrame()
+	///
+	template <typename Pixel_T>
+	void setLastFrame(const Image<Pixel_T>& /*image*/, const std::vector<ColorRgb>& /*colors*/)
+	{
+	}
+
+	void setLastFrame(const Image<ColorRgb>& image, const std::vector<ColorRgb>& colors);
+
+	///
+	/// Forgets the last processed frame, must be called whenever the mapping is rebuilt
+	///
+	void clearLastFrame();
+
 	///
 	/// Performs black-border detection (if enabled) on the given image
 	///
@@ -187,8 +241,9 @@ private:
 		{
 			Debug(_log, "Reset border");
 			_borderProcessor->process(image);
+			clearLastFrame();
 			delete _imageToLeds;
-			_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), 0, 0, _ledString.leds());
+			_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), 0, 0, _ledString.leds(), _mappingEngine);
 		}
 
 		if(_borderProcessor->enabled() && _borderProcessor->process(image))
@@ -196,17 +251,18 @@ private:
 			const hyperion::BlackBorder border = _borderProcessor->getCurrentBorder();
 
 			// Clean up the old mapping
+			clearLastFrame();
 			delete _imageToLeds;
 
 			if (border.unknown)
 			{
 				// Construct a new buffer and mapping
-				_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), 0, 0, _ledString.leds());
+				_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), 0, 0, _ledString.leds(), _mappingEngine);
 			}
 			else
 			{
 				// Construct a new buffer and mapping
-				_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), border.horizontalSize, border.verticalSize, _ledString.leds());
+				_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), border.horizontalSize, border.verticalSize, _ledString.leds(), _mappingEngine);
 			}
 
 			//Debug(Logger::getInstance("BLACKBORDER"),  "CURRENT BORDER TYPE: unknown=%d hor.size=%d vert.size=%d",
@@ -235,6 +291,16 @@ private:
 	/// Type of last requested hard type
 	int _hardMappingType;
 
+	/// Engine used to compute the mean color per led
+	hyperion::MappingEngine _mappingEngine;
+
+	/// The last processed frame, holding it keeps its pixels unchanged (copy on write)
+	Image<ColorRgb> _lastImage;
+	/// The led colors of the last processed frame, empty if invalid
+	std::vector<ColorRgb> _lastColors;
+	/// The mapping type used for the last processed frame
+	int _lastMappingType;
+
 	/// Hyperion instance pointer
 	Hyperion* _hyperion;
 };
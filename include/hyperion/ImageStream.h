@@ -0,0 +1,81 @@
+#pragma once
+
+// Qt includes
+#include <QObject>
+#include <QByteArray>
+#include <QJsonDocument>
+
+// util
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+#include <utils/Logger.h>
+#include <utils/settings.h>
+
+class QTimer;
+class Hyperion;
+
+///
+/// @brief The live image preview of a Hyperion instance, encoded once for all subscribers
+///
+/// The current image of the instance is taken at a fixed rate, downscaled to the preview width and encoded as JPEG
+/// on the thread of the stream. Subscribers connect to imageEncoded() and call subscriptionChanged(), the stream
+/// stops taking images when nobody is connected anymore.
+///
+class ImageStream : public QObject
+{
+	Q_OBJECT
+public:
+	///
+	/// @brief Constructor
+	/// @param hyperion  The instance
+	/// @param config    The webConfig settings with the rate and width of the preview
+	///
+	ImageStream(Hyperion* hyperion, const QJsonDocument& config);
+
+signals:
+	///
+	/// @brief Emits with the JPEG of the current image
+	///
+	void imageEncoded(const QByteArray& jpeg);
+
+public slots:
+	///
+	/// @brief Start or stop taking images, call it queued after connecting to or disconnecting from imageEncoded()
+	///
+	void subscriptionChanged();
+
+	///
+	/// @brief Take the current image of the instance, encoded at the next tick
+	///
+	void handleImage(const Image<ColorRgb>& image);
+
+	///
+	/// @brief Handle settings update
+	/// @param type   The type from enum
+	/// @param config The configuration
+	///
+	void handleSettingsUpdate(settings::type type, const QJsonDocument& config);
+
+private slots:
+	///
+	/// @brief Encode the latest image, if a new one was taken
+	///
+	void encodeImage();
+
+private:
+	Hyperion* _hyperion;
+	Logger* _log;
+
+	/// Triggers the encoding at the preview rate
+	QTimer* _timer;
+
+	/// The largest width of the preview, a wider image is downscaled
+	int _maxWidth;
+
+	/// The latest image, encoded at the next tick
+	Image<ColorRgb> _image;
+	bool _hasNewImage;
+
+	/// Are images taken?
+	bool _active;
+};
@@ -2,19 +2,36 @@
 #pragma once
 
 // STL includes
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <memory>
 #include <sstream>
 
 // hyperion-utils includes
 #include <utils/Image.h>
+#include <utils/ImageResampler.h>
 #include <utils/Logger.h>
 
 // hyperion includes
 #include <hyperion/LedString.h>
+#include <hyperion/FrameAnalysis.h>
 
 namespace hyperion
 {
 
+	///
+	/// The engine used to compute the mean color of a led area
+	///
+	enum MappingEngine
+	{
+		/// Every led holds the absolute indices of all pixels in its area
+		PIXEL_INDEX = 0,
+
+		/// Every led holds its area as rectangle, means are taken from a per frame summed area table
+		SUMMED_AREA = 1
+	};
+
 	///
 	/// The ImageToLedsMap holds a mapping of indices into an image to leds. It can be used to
 	/// calculate the average (or mean) color per led for a specific region.
@@ -35,13 +52,15 @@ namespace hyperion
 		/// @param[in] horizontalBorder The size of the horizontal border (0=no border)
 		/// @param[in] verticalBorder   The size of the vertical border (0=no border)
 		/// @param[in] leds             The list with led specifications
+		/// @param[in] engine           The engine used to compute the mean color per led
 		///
 		ImageToLedsMap(
 				const unsigned width,
 				const unsigned height,
 				const unsigned horizontalBorder,
 				const unsigned verticalBorder,
-				const std::vector<Led> & leds);
+				const std::vector<Led> & leds,
+				const MappingEngine engine = PIXEL_INDEX);
 
 		///
 		/// Returns the width of the indexed image
@@ -60,6 +79,11 @@ namespace hyperion
 		unsigned horizontalBorder() const { return _horizontalBorder; }
 		unsigned verticalBorder() const { return _verticalBorder; }
 
+		///
+		/// Returns the engine used to compute the mean color per led
+		///
+		MappingEngine engine() const { return _engine; }
+
 		///
 		/// Determines the mean color for each led using the mapping the image given
 		/// at construction.
@@ -71,7 +95,7 @@ namespace hyperion
 		template <typename Pixel_T>
 		std::vector<ColorRgb> getMeanLedColor(const Image<Pixel_T> & image) const
 		{
-			std::vector<ColorRgb> colors(_colorsMap.size(), ColorRgb{0,0,0});
+			std::vector<ColorRgb> colors(_ledAreas.size(), ColorRgb{0,0,0});
 			getMeanLedColor(image, colors);
 			return colors;
 		}
@@ -87,10 +111,23 @@ namespace hyperion
 		void getMeanLedColor(const Image<Pixel_T> & image, std::vector<ColorRgb> & ledColors) const
 		{
 			// Sanity check for the number of leds
-			//assert(_colorsMap.size() == ledColors.size());
-			if(_colorsMap.size() != ledColors.size())
+			//assert(_ledAreas.size() == ledColors.size());
+			if(_ledAreas.size() != ledColors.size())
 			{
-				Debug(Logger::getInstance("HYPERION"), "ImageToLedsMap: colorsMap.size != ledColors.size -> %d != %d", _colorsMap.size(), ledColors.size());
+				Debug(Logger::getInstance("HYPERION"), "ImageToLedsMap: ledAreas.size != ledColors.size -> %d != %d", _ledAreas.size(), ledColors.size());
+				return;
+			}
+
+			if (_engine == SUMMED_AREA)
+			{
+				// Integrate the image once, every led area is then reduced in constant time
+				const uint32_t* summedArea = summedAreaTable(image);
+
+				auto led = ledColors.begin();
+				for (auto area = _ledAreas.begin(); area != _ledAreas.end(); ++area, ++led)
+				{
+					*led = calcMeanColor(*area, summedArea);
+				}
 				return;
 			}
 
@@ -103,6 +140,32 @@ namespace hyperion
 			}
 		}
 
+		///
+		/// Determines the mean color for each led directly from a raw frame (direct mapping). Only the
+		/// pixels inside the led areas are converted by the resampler, each of them once, into a summed
+		/// area table, no intermediate image is created. The mapping has to be constructed for the output
+		/// size of the resampler.
+		///
+		/// @param[in] resampler    The resampler which holds cropping and decimation of the frame
+		/// @param[in] data         The raw frame
+		/// @param[in] lineLength   The length of a frame line in bytes
+		/// @param[in] pixelFormat  The pixel format of the frame
+		/// @param[out] ledColors   The vector containing the output
+		///
+		void getMeanLedColor(const ImageResampler & resampler, const uint8_t * data, int lineLength, PixelFormat pixelFormat, std::vector<ColorRgb> & ledColors) const;
+
+		///
+		/// Determines the uni color for each led directly from a raw frame (direct mapping).
+		/// The mapping has to be constructed for the output size of the resampler.
+		///
+		/// @param[in] resampler    The resampler which holds cropping and decimation of the frame
+		/// @param[in] data         The raw frame
+		/// @param[in] lineLength   The length of a frame line in bytes
+		/// @param[in] pixelFormat  The pixel format of the frame
+		/// @param[out] ledColors   The vector containing the output
+		///
+		void getUniLedColor(const ImageResampler & resampler, const uint8_t * data, int lineLength, PixelFormat pixelFormat, std::vector<ColorRgb> & ledColors) const;
+
 		///
 		/// Determines the uni color for each led using the mapping the image given
 		/// at construction.
@@ -114,7 +177,7 @@ namespace hyperion
 		template <typename Pixel_T>
 		std::vector<ColorRgb> getUniLedColor(const Image<Pixel_T> & image) const
 		{
-			std::vector<ColorRgb> colors(_colorsMap.size(), ColorRgb{0,0,0});
+			std::vector<ColorRgb> colors(_ledAreas.size(), ColorRgb{0,0,0});
 			getUniLedColor(image, colors);
 			return colors;
 		}
@@ -130,10 +193,10 @@ namespace hyperion
 		void getUniLedColor(const Image<Pixel_T> & image, std::vector<ColorRgb> & ledColors) const
 		{
 			// Sanity check for the number of leds
-			// assert(_colorsMap.size() == ledColors.size());
-			if(_colorsMap.size() != ledColors.size())
+			// assert(_ledAreas.size() == ledColors.size());
+			if(_ledAreas.size() != ledColors.size())
 			{
-				Debug(Logger::getInstance("HYPERION"), "ImageToLedsMap: colorsMap.size != ledColors.size -> %d != %d", _colorsMap.size(), ledColors.size());
+				Debug(Logger::getInstance("HYPERION"), "ImageToLedsMap: ledAreas.size != ledColors.size -> %d != %d", _ledAreas.size(), ledColors.size());
 				return;
 			}
 
@@ -153,9 +216,123 @@ namespace hyperion
 
 		const unsigned _verticalBorder;
 
-		/// The absolute indices into the image for each led
+		/// The engine used to compute the mean color per led
+		const MappingEngine _engine;
+
+		///
+		/// The pixel area of a single led, given as half-open interval [min, max) in both directions.
+		/// An empty area (min == max) results in black.
+		///
+		struct LedArea
+		{
+			unsigned minX;
+			unsigned maxX;
+			unsigned minY;
+			unsigned maxY;
+
+			/// The rows of the summed area table at minY and maxY (SUMMED_AREA engine and direct mapping only)
+			unsigned topRow;
+			unsigned bottomRow;
+		};
+
+		/// The pixel area for each led
+		std::vector<LedArea> _ledAreas;
+
+		/// The absolute indices into the image for each led (PIXEL_INDEX engine only)
 		std::vector<std::vector<unsigned>> _colorsMap;
 
+		/// The rows of the summed area table and the pixels covered by any led area, only these are integrated
+		std::shared_ptr<const SummedAreaLayout> _summedAreaLayout;
+
+		/// Summed area table of the last image, see FrameAnalysis::integrate() (SUMMED_AREA engine only)
+		mutable std::vector<uint32_t> _summedArea;
+
+		/// Analysis of the last shared captured frame, which holds its summed area table (SUMMED_AREA engine only)
+		mutable std::shared_ptr<FrameAnalysis> _frameAnalysis;
+
+		/// Buffer for the converted pixels of a single line (direct mapping only)
+		mutable std::vector<ColorRgb> _lineBuffer;
+
+		///
+		/// Integrates the pixels of a raw frame covered by any led area into the own summed area table, every pixel
+		/// is converted once. Pixels outside of all led areas are integrated as black, they are never part of a mean.
+		///
+		/// @return The summed area table
+		///
+		const uint32_t* summedAreaTable(const ImageResampler & resampler, const uint8_t * data, int lineLength, PixelFormat pixelFormat) const;
+
+		///
+		/// Calculates the 'mean color' of the given led area of a raw frame (direct mapping)
+		///
+		/// @return The mean of the given area (or black when empty)
+		///
+		ColorRgb calcMeanColor(const ImageResampler & resampler, const uint8_t * data, int lineLength, PixelFormat pixelFormat, const LedArea & area) const;
+
+		///
+		/// Integrates the pixels covered by any led area of the given image into the own summed area table,
+		/// see FrameAnalysis::integrate().
+		///
+		/// @param[in] image The image to integrate
+		///
+		/// @return The summed area table
+		///
+		template <typename Pixel_T>
+		const uint32_t* summedAreaTable(const Image<Pixel_T> & image) const
+		{
+			FrameAnalysis::integrate(*_summedAreaLayout, image, _summedArea);
+			return _summedArea.data();
+		}
+
+		///
+		/// Captured frames shared by several instances are integrated once for all of them, the table is taken
+		/// from their FrameAnalysis. Other images are integrated into the own summed area table.
+		///
+		/// @param[in] image The image to integrate
+		///
+		/// @return The summed area table
+		///
+		const uint32_t* summedAreaTable(const Image<ColorRgb> & image) const
+		{
+			_frameAnalysis = FrameAnalysis::get(image);
+			if (_frameAnalysis == nullptr)
+			{
+				FrameAnalysis::integrate(*_summedAreaLayout, image, _summedArea);
+				return _summedArea.data();
+			}
+			return _frameAnalysis->summedAreaTable(_summedAreaLayout).data();
+		}
+
+		///
+		/// Calculates the 'mean color' of the given led area from the given summed area table.
+		/// The table has to be integrated with the layout of the map.
+		///
+		/// @param[in] area The led area
+		/// @param[in] summedArea The summed area table of the image
+		///
+		/// @return The mean of the given area (or black when empty)
+		///
+		ColorRgb calcMeanColor(const LedArea & area, const uint32_t* summedArea) const
+		{
+			const uint32_t pixelCount = (area.maxX - area.minX) * (area.maxY - area.minY);
+			if (pixelCount == 0)
+			{
+				return ColorRgb::BLACK;
+			}
+
+			const size_t stride = static_cast<size_t>(_width + 1) * 3;
+			const uint32_t* topLeft     = summedArea + area.topRow * stride + area.minX * 3;
+			const uint32_t* topRight    = summedArea + area.topRow * stride + area.maxX * 3;
+			const uint32_t* bottomLeft  = summedArea + area.bottomRow * stride + area.minX * 3;
+			const uint32_t* bottomRight = summedArea + area.bottomRow * stride + area.maxX * 3;
+
+			// Compute the average of each color channel
+			const uint8_t avgRed   = uint8_t((bottomRight[0] - bottomLeft[0] - topRight[0] + topLeft[0]) / pixelCount);
+			const uint8_t avgGreen = uint8_t((bottomRight[1] - bottomLeft[1] - topRight[1] + topLeft[1]) / pixelCount);
+			const uint8_t avgBlue  = uint8_t((bottomRight[2] - bottomLeft[2] - topRight[2] + topLeft[2]) / pixelCount);
+
+			return {avgRed, avgGreen, avgBlue};
+		}
+
 		///
 		/// Calculates the 'mean color' of the given list. This is the mean over each color-channel
 		/// (red, green, blue)
@@ -4,6 +4,7 @@
 #include <vector>
 #include <QStringList>
 #include <QString>
+#include <QElapsedTimer>
 
 // Hyperion includes
 #include <utils/ColorRgb.h>
@@ -32,6 +33,19 @@ public:
 
 	void setBacklightEnabled(bool enable);
 
+	///
+	/// Sets the size of the 3D lookup tables the adjustments are baked into.
+	///
+	/// @param size The number of nodes per channel, 0 to calculate every color exactly
+	///
+	void setLutSize(int size);
+
+	///
+	/// Discards the lookup tables, must be called whenever a ColorAdjustment is changed. The colors are
+	/// calculated exactly until the adjustments are unchanged for a while and the new tables are built.
+	///
+	void invalidateLuts();
+
 	///
 	/// Returns the identifier of all the unique ColorAdjustment
 	///
@@ -55,6 +69,14 @@ public:
 	void applyAdjustment(std::vector<ColorRgb>& ledColors);
 
 private:
+	///
+	/// Performs the exact color adjustment of a single color
+	///
+	/// @param adjustment The ColorAdjustment
+	/// @param color The raw color, updated in place
+	///
+	static void adjustColor(ColorAdjustment* adjustment, ColorRgb& color);
+
 	/// List with transform ids
 	QStringList _adjustmentIds;
 
@@ -64,6 +86,12 @@ private:
 	/// List with a pointer to the ColorAdjustment for each individual led
 	std::vector<ColorAdjustment*> _ledAdjustments;
 
+	/// Number of nodes per channel of the lookup tables, 0 if disabled
+	int _lutSize;
+
+	/// Time since the adjustments were changed the last time, the tables are built once they settled
+	QElapsedTimer _lutChanged;
+
 	// logger instance
 	Logger * _log;
 };
@@ -2,6 +2,9 @@
 
 // STL includes
 #include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
 #include <cstdint>
 
 // QT includes
@@ -31,6 +34,21 @@ class PriorityMuxer : public QObject
 {
 	Q_OBJECT
 public:
+	///
+	/// How the colors of a priority channel are composited onto the channels below it
+	///
+	enum BlendMode
+	{
+		/// The channel replaces the channels below (default)
+		BLEND_NONE = 0,
+		/// The channel is mixed with the channels below by its opacity
+		BLEND_ALPHA,
+		/// The channel, scaled by its opacity, is added to the channels below
+		BLEND_ADD,
+		/// The brighter one of the channel, scaled by its opacity, and the channels below wins per color
+		BLEND_MAX
+	};
+
 	///
 	/// The information structure for a single priority channel
 	///
@@ -52,6 +70,10 @@ public:
 		unsigned smooth_cfg;
 		/// specific owner description
 		QString owner;
+		/// How the channel is composited onto the channels below
+		BlendMode blendMode;
+		/// The opacity of the channel when it is composited (0-255)
+		uint8_t opacity;
 	};
 
 	//Foreground and Background priorities
@@ -60,6 +82,20 @@ public:
 	/// The lowest possible priority, which is used when no priority channels are active
 	const static int LOWEST_PRIORITY;
 
+	///
+	/// @brief Translate a blend mode string to the enum, unknown strings are BLEND_NONE
+	/// @param blendMode  The blend mode ("none", "alpha", "add" or "max")
+	/// @return The blend mode
+	///
+	static BlendMode blendModeFromString(const QString& blendMode);
+
+	///
+	/// @brief Translate a blend mode to its string
+	/// @param blendMode  The blend mode
+	/// @return The string
+	///
+	static QString blendModeToString(BlendMode blendMode);
+
 	///
 	/// Constructs the PriorityMuxer for the given number of LEDs (used to switch to black when
 	/// there are no priority channels
@@ -74,7 +110,7 @@ public:
 	~PriorityMuxer() override;
 
 	///
-	/// @brief Start/Stop the PriorityMuxer update timer; On disabled no priority and timeout updates will be performend
+	/// @brief Start/Stop the PriorityMuxer timeout handling; On disabled no timeouts will be performed until it is enabled again
 	/// @param  enable  The new state
 	///
 	void setEnable(bool enable);
@@ -192,6 +228,37 @@ public:
 	///
 	void clearAll(bool forceClearAll=false);
 
+	///
+	/// @brief Set how a priority channel is composited onto the channels below it. A new input is not blended
+	/// @param  priority   The priority of the channel
+	/// @param  blendMode  The blend mode, BLEND_NONE to replace the channels below
+	/// @param  opacity    The opacity of the channel (0-255)
+	/// @return            True on success, false when priority is not found
+	///
+	bool setInputBlending(int priority, BlendMode blendMode, uint8_t opacity);
+
+	///
+	/// @brief Get the priorities which make up the led colors, from the base to the current priority. The current
+	///        priority is blended onto the next active channel below as long as its blend mode is not BLEND_NONE,
+	///        which applies to this channel again
+	/// @return The priorities, the current priority only if it is not blended
+	///
+	const QList<int>& getLayers() const { return _layers; }
+
+	///
+	/// @brief Check if the colors of an input are visible, as the current priority or a blended layer below it
+	/// @param priority  The priority of the input
+	/// @return True if the input is visible
+	///
+	bool isInputVisible(int priority) const { return priority == _currentPriority || _layers.contains(priority); }
+
+	///
+	/// @brief Check if an input is hidden by a higher priority, its producer may continue at a low keep-alive rate
+	/// @param priority  The priority of the input
+	/// @return True if the input is in standby
+	///
+	bool isInputStandby(int priority) const { return _standbyInputs.contains(priority); }
+
 	///
 	/// @brief Queue a manual push where muxer doesn't recognize them (e.g. continuous single color pushes)
 	///
@@ -222,19 +289,23 @@ signals:
 	void prioritiesChanged();
 
 	///
-	/// internal used signal to resolve treading issues with timer
+	/// @brief Emits with the initial standby state of a new input and whenever the state of an input changed.
+	///        An input is in standby while it is hidden by a higher priority, a removed input is not in standby
+	/// @param priority   The priority of the input
+	/// @param component  The component of the input
+	/// @param standby    True if the input is hidden
 	///
-	void signalTimeTrigger();
+	void inputStandbyChanged(int priority, hyperion::Components component, bool standby);
 
-private slots:
 	///
-	/// Slot which is called to adapt to 1s interval for signal timeRunner() / prioritiesChanged()
+	/// @brief Emits whenever the layers blended below the current priority changed, while the current priority is the same
 	///
-	void timeTrigger();
+	void layersChanged();
 
+private slots:
 	///
-	/// Updates the current time. Channels with a configured time out will be checked and cleared if
-	/// required.
+	/// Updates the current time. Channels whose timeout is reached are cleared and the current priority is
+	/// evaluated again. Is called at the next deadline and whenever the inputs changed
 	///
 	void setCurrentTime();
 
@@ -245,6 +316,41 @@ private:
 	///
 	hyperion::Components getComponentOfPriority(int priority) const;
 
+	///
+	/// @brief Check if an input would be hidden by the current priority
+	/// @param priority  The priority of the input
+	/// @return True if the input is hidden
+	///
+	bool isHidden(int priority) const;
+
+	///
+	/// @brief Collect the layers blended below the current priority, see getLayers()
+	/// @return True if the layers changed
+	///
+	bool updateLayers();
+
+	///
+	/// @brief Update the standby state of all inputs after the current priority changed or inputs were removed
+	///
+	void updateInputStandby();
+
+	///
+	/// @brief Queue the timeout of an input, the timer is armed again if it is the next one
+	/// @param priority        The priority of the input
+	/// @param timeoutTime_ms  The absolute timeout
+	///
+	void addDeadline(int priority, int64_t timeoutTime_ms);
+
+	///
+	/// @brief Arm the timer for the next deadline of an input, outdated deadlines are dropped
+	///
+	void scheduleNextDeadline();
+
+	///
+	/// @brief Start or stop the timeRunner() interval, depending on a running COLOR, EFFECT or IMAGE with a timeout
+	///
+	void updateTimeRunner();
+
 	/// Logger instance
 	Logger* _log;
 
@@ -266,12 +372,28 @@ private:
 	/// The information of the lowest priority channel
 	InputInfo _lowestPriorityInfo;
 
+	/// The priorities composited into the led colors, from the base to the current priority
+	QList<int> _layers;
+
+	/// The inputs hidden by a higher priority with their component
+	QMap<int, hyperion::Components> _standbyInputs;
+
 	// Reflect the state of auto select
 	bool _sourceAutoSelectEnabled;
 
-	// Timer to update Muxer times independent
+	/// A timeout of an input: the absolute timeout and the priority
+	typedef std::pair<int64_t, int> Deadline;
+
+	/// The timeouts in the order they expire. A deadline of an input which got a new timeout or was removed
+	/// meanwhile is outdated, it is dropped when it is reached
+	std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> _deadlines;
+
+	/// Are timeouts performed?
+	bool _enabled;
+
+	// Timer armed for the next deadline
 	QTimer* _updateTimer;
 
-	QTimer* _timer;
-	QTimer* _blockTimer;
+	// Timer for the timeRunner() interval
+	QTimer* _timeRunnerTimer;
 };
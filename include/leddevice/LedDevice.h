@@ -9,11 +9,14 @@
 #include <QJsonDocument>
 #include <QTimer>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutex>
 
 // STL includes
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <atomic>
 
 // Utility includes
 #include <utils/ColorRgb.h>
@@ -22,6 +25,7 @@
 #include <utils/Logger.h>
 #include <functional>
 #include <utils/Components.h>
+#include <utils/FrameMailbox.h>
 
 class LedDevice;
 
@@ -68,7 +72,7 @@ public:
 	/// @brief Set a device's latch time.
 	///
 	/// Latch time is the time-frame a device requires until the next update can be processed.
-	/// During that time-frame any updates done via updateLeds are skipped.
+	/// An update done via updateLeds during that time-frame is deferred to its end, a newer update replaces it.
 	///
 	/// @param[in] latchTime_ms Latch time in milliseconds
 	///
@@ -152,6 +156,25 @@ public:
 	///
 	static void printLedValues(const std::vector<ColorRgb>& ledValues);
 
+	///
+	/// @brief Queue the color values of the device's LEDs to be written by the device's thread.
+	///
+	/// May be called from any thread. Only the latest values are kept, values which are not written yet
+	/// are replaced. So a slow device writes the latest values instead of working off outdated ones.
+	///
+	/// @param[in] ledValues The color per LED
+	///
+	void queueLeds(const std::vector<ColorRgb>& ledValues);
+
+	///
+	/// @brief Get the statistics of the queued and written LED values.
+	///
+	/// May be called from any thread, also while the device blocks in a write.
+	///
+	/// @return The frames queued, dropped and written and the write latency
+	///
+	QJsonObject getStatistics() const;
+
 public slots:
 
 	///
@@ -371,7 +394,7 @@ protected:
 	/// @return array as string of hex values
 	QString toHex(const QByteArray& data, int number = -1) const;
 
-	/// Current device's type
+	/// Current device's type, changed under the statistics mutex as getStatistics() reads it from other threads
 	QString _activeDeviceType;
 
 	/// Helper to pipe device configuration from constructor to start()
@@ -428,6 +451,9 @@ protected:
 	/// Timestamp of last write
 	QDateTime _lastWriteTime;
 
+	/// Monotonic time since the last write, the latch time is measured with it
+	QElapsedTimer _lastWriteClock;
+
 protected slots:
 
 	///
@@ -444,6 +470,18 @@ protected slots:
 	///
 	virtual void setInError( const QString& errorMsg);
 
+private slots:
+
+	///
+	/// @brief Update the LEDs with the latest queued color values.
+	///
+	void processQueuedLeds();
+
+	///
+	/// @brief Write the update deferred to the end of the latch time.
+	///
+	void writeDeferredLeds();
+
 private:
 
 	/// @brief Start a new refresh cycle
@@ -452,6 +490,18 @@ private:
 	/// @brief Stop refresh cycle
 	void stopRefreshTimer();
 
+	/// @brief Discard an update deferred to the end of the latch time
+	void cancelDeferredWrite();
+
+	/// Timer writing an update deferred to the end of the latch time
+	QTimer* _latchTimer;
+
+	/// Is an update deferred to the end of the latch time?
+	bool _isWriteDeferred;
+
+	/// LED values deferred to the end of the latch time
+	std::vector<ColorRgb> _deferredLedValues;
+
 	/// Is last write refreshing enabled?
 	bool	_isRefreshEnabled;
 
@@ -461,6 +511,32 @@ private:
 
 	/// Last LED values written
 	std::vector<ColorRgb> _lastLedValues;
+
+	/// Latest LED values queued, which are not written yet
+	FrameMailbox<std::vector<ColorRgb>> _queuedLedValues;
+
+	/// The LED values taken from the mailbox, its storage is handed back to the mailbox with the next take
+	std::vector<ColorRgb> _takenLedValues;
+
+	/// Number of LED values queued
+	std::atomic<uint64_t> _queuedFrames;
+
+	/// Guards the write statistics and the device type, which are read by other threads
+	mutable QMutex _statisticsMutex;
+
+	/// Number of LED values written by updateLeds
+	uint64_t _writtenFrames;
+
+	/// Number of LED values deferred to the end of the latch time and of those replaced before written
+	uint64_t _deferredFrames;
+	uint64_t _replacedDeferredFrames;
+
+	/// Sum and maximum of the write durations in microseconds
+	int64_t _writeMicrosSum;
+	int64_t _maxWriteMicros;
+
+	/// Number of writes per duration range, see WRITE_LATENCY_BOUNDS
+	std::vector<uint64_t> _writeLatencyHistogram;
 };
 
 #endif // LEDEVICE_H
@@ -72,24 +72,28 @@ public:
 	///
 	unsigned int getLedCount() const;
 
-public slots:
 	///
-	/// @brief Handle new component state request
-	/// @param component  The comp from enum
-	/// @param state      The new state
+	/// @brief Get the statistics of the queued and written LED values of the device
 	///
-	void handleComponentState(hyperion::Components component, bool state);
+	QJsonObject getStatistics() const;
 
-signals:
+public slots:
 	///
-	/// PIPER signal for Hyperion -> LedDevice
+	/// @brief Hand the LED values to the device, which writes the latest values only
+	/// Called directly by the thread providing the values
 	///
 	/// @param[in] ledValues  The RGB-color per led
 	///
-	/// @return Zero on success else negative
+	void updateLeds(const std::vector<ColorRgb>& ledValues);
+
 	///
-	int updateLeds(const std::vector<ColorRgb>& ledValues);
+	/// @brief Handle new component state request
+	/// @param component  The comp from enum
+	/// @param state      The new state
+	///
+	void handleComponentState(hyperion::Components component, bool state);
 
+signals:
 	///
 	/// @brief Enables the LED-Device.
 	///
@@ -137,6 +141,8 @@ private:
 	Hyperion* _hyperion;
 	// Pointer of current led device
 	LedDevice* _ledDevice;
+	// guards the device against its deletion while LED values are handed over by another thread
+	mutable QMutex _ledDeviceLock;
 	// the enable state
 	bool _enabled;
 };
@@ -0,0 +1,108 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+///
+/// @brief Single slot mailbox between a producer and a consumer thread where the latest value wins.
+///
+/// The producer puts every new value into the slot, a value which has not been taken by the consumer yet
+/// is replaced and counted as dropped. So a slow consumer always gets the latest value instead of a
+/// growing queue of outdated ones. Put and take are lock-free: the mailbox is a triple buffer, the producer
+/// writes its buffer and exchanges it with the slot, the consumer exchanges the slot with its buffer. The
+/// buffers are reused, a value is copied into the storage of a previous one (e.g. the capacity of a vector).
+///
+/// There is one producer and one consumer thread at a time, several producers have to be serialized.
+///
+template <typename T>
+class FrameMailbox
+{
+public:
+	FrameMailbox()
+		: _buffers()
+		, _back(0)
+		, _slot(1)
+		, _front(2)
+		, _dropped(0)
+	{
+	}
+
+	FrameMailbox(const FrameMailbox&) = delete;
+	FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+	///
+	/// @brief Put a new value, an unprocessed value is dropped
+	/// @param value  The value
+	/// @return True if the slot was empty, the consumer has to be notified then. Otherwise a notification is pending already
+	///
+	bool put(const T& value)
+	{
+		_buffers[_back] = value;
+		const uint8_t previous = _slot.exchange(static_cast<uint8_t>(_back | NEW_VALUE), std::memory_order_acq_rel);
+		_back = previous & INDEX_MASK;
+
+		if ((previous & NEW_VALUE) != 0)
+		{
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		return true;
+	}
+
+	///
+	/// @brief Take the latest value, the storage of the previous content of value is reused by the mailbox
+	/// @param[out] value  The value
+	/// @return False if the slot is empty
+	///
+	bool take(T& value)
+	{
+		// only the producer changes the slot meanwhile, it stays new then
+		if ((_slot.load(std::memory_order_acquire) & NEW_VALUE) == 0)
+		{
+			return false;
+		}
+
+		const uint8_t previous = _slot.exchange(_front, std::memory_order_acq_rel);
+		_front = previous & INDEX_MASK;
+
+		using std::swap;
+		swap(value, _buffers[_front]);
+		return true;
+	}
+
+	///
+	/// @brief Discard an unprocessed value without counting it as dropped
+	///
+	void clear()
+	{
+		_slot.fetch_and(INDEX_MASK, std::memory_order_acq_rel);
+	}
+
+	///
+	/// @return The number of values which were replaced before the consumer took them
+	///
+	uint64_t dropped() const
+	{
+		return _dropped.load(std::memory_order_relaxed);
+	}
+
+private:
+	/// The slot holds the index of a buffer and whether it holds a value not taken yet
+	static const uint8_t INDEX_MASK = 0x03;
+	static const uint8_t NEW_VALUE = 0x04;
+
+	T _buffers[3];
+
+	/// The buffer written by the producer
+	uint8_t _back;
+
+	/// The buffer exchanged between producer and consumer
+	std::atomic<uint8_t> _slot;
+
+	/// The buffer read by the consumer
+	uint8_t _front;
+
+	std::atomic<uint64_t> _dropped;
+};
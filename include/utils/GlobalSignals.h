@@ -5,6 +5,9 @@
 #include <utils/ColorRgb.h>
 #include <utils/Components.h>
 
+// hyperion
+#include <hyperion/LedString.h>
+
 // qt
 #include <QObject>
 
@@ -47,6 +50,14 @@ signals:
 	///
 	void setV4lImage(const QString& name, const Image<ColorRgb>& image);
 
+	///
+	/// @brief PIPE led colors of a direct mapped v4lCapture over HyperionDaemon to Hyperion class
+	/// @param name         The name of the v4l capture (path) that is currently active
+	/// @param hyperionInd  The Hyperion instance index the led colors are mapped for
+	/// @param ledColors    The led colors
+	///
+	void setV4lLedColors(const QString& name, int hyperionInd, const std::vector<ColorRgb>& ledColors);
+
 	///
 	/// @brief PIPE the register command for a new global input over HyperionDaemon to Hyperion class
 	/// @param[in] priority    The priority of the channel
@@ -101,4 +112,30 @@ signals:
 	///
 	void requestSource(hyperion::Components component, int hyperionInd, bool listen);
 
+	///
+	/// @brief Tell captures and network servers whether the input of an instance is hidden by a higher priority
+	/// @param hyperionInd The Hyperion instance index as identifier
+	/// @param priority    The priority of the input
+	/// @param component   The component of the input
+	/// @param standby     True while the input is hidden, a producer may continue at a low keep-alive rate
+	///
+	void inputStandby(int hyperionInd, int priority, hyperion::Components component, bool standby);
+
+	///
+	/// @brief Tell v4l2 capture to map frames directly to led colors for an instance (direct mapping)
+	/// @param hyperionInd The Hyperion instance index as identifier
+	/// @param leds        The led layout of the instance, empty to receive images again
+	/// @param mappingType The image to led mapping type of the instance
+	///
+	void requestV4lDirectMapping(int hyperionInd, const std::vector<Led>& leds, int mappingType);
+
+	///////////////////////////////////////
+	////////////// FROM V4L2 //////////////
+	///////////////////////////////////////
+
+	///
+	/// @brief Tell the Hyperion instances that a v4l capture has been (re)created, direct mapping requests have to be sent again
+	///
+	void v4lDirectMappingReset();
+
 };
@@ -8,6 +8,7 @@
 #include <cassert>
 #include <type_traits>
 #include <utils/ColorRgb.h>
+#include <utils/ImageDataPool.h>
 
 // QT includes
 #include <QSharedData>
@@ -24,10 +25,13 @@ class ImageData : public QSharedData
 public:
 	typedef Pixel_T pixel_type;
 
+	static_assert(std::is_trivially_copyable<Pixel_T>::value, "Pixel buffers are recycled without construction");
+
 	ImageData(unsigned width, unsigned height, const Pixel_T background) :
 		_width(width),
 		_height(height),
-		_pixels(new Pixel_T[width * height + 1])
+		_capacity(width * height + 1),
+		_pixels(allocate(_capacity))
 	{
 		std::fill(_pixels, _pixels + width * height, background);
 	}
@@ -36,7 +40,8 @@ public:
 		QSharedData(other),
 		_width(other._width),
 		_height(other._height),
-		_pixels(new Pixel_T[other._width * other._height + 1])
+		_capacity(other._width * other._height + 1),
+		_pixels(allocate(_capacity))
 	{
 		memcpy(_pixels, other._pixels, static_cast<ulong>(other._width) * static_cast<ulong>(other._height) * sizeof(Pixel_T));
 	}
@@ -52,12 +57,14 @@ public:
 		using std::swap;
 		swap(this->_width, s._width);
 		swap(this->_height, s._height);
+		swap(this->_capacity, s._capacity);
 		swap(this->_pixels, s._pixels);
 	}
 
 	ImageData(ImageData&& src) noexcept
 		: _width(0)
 		, _height(0)
+		, _capacity(0)
 		, _pixels(NULL)
 	{
 		src.swap(*this);
@@ -71,7 +78,7 @@ public:
 
 	~ImageData()
 	{
-		delete[] _pixels;
+		release(_pixels, _capacity);
 	}
 
 	inline unsigned width() const
@@ -114,10 +121,11 @@ public:
 		if (width == _width && height == _height)
 			return;
 
-		if ((width * height) > unsigned((_width * _height)))
+		if ((width * height + 1) > _capacity)
 		{
-			delete[] _pixels;
-			_pixels = new Pixel_T[width*height + 1];
+			release(_pixels, _capacity);
+			_capacity = width * height + 1;
+			_pixels = allocate(_capacity);
 		}
 
 		_width = width;
@@ -159,8 +167,9 @@ public:
 		{
 			_width = 1;
 			_height = 1;
-			delete[] _pixels;
-			_pixels = new Pixel_T[2];
+			release(_pixels, _capacity);
+			_capacity = 2;
+			_pixels = allocate(_capacity);
 		}
 
 		memset(_pixels, 0, static_cast<unsigned long>(_width) * static_cast<unsigned long>(_height) * sizeof(Pixel_T));
@@ -172,11 +181,23 @@ private:
 		return y * _width + x;
 	}
 
+	static Pixel_T* allocate(unsigned count)
+	{
+		return static_cast<Pixel_T*>(ImageDataPool::allocate(count * sizeof(Pixel_T)));
+	}
+
+	static void release(Pixel_T* pixels, unsigned count)
+	{
+		ImageDataPool::release(pixels, count * sizeof(Pixel_T));
+	}
+
 private:
 	/// The width of the image
 	unsigned _width;
 	/// The height of the image
 	unsigned _height;
+	/// The number of allocated pixels
+	unsigned _capacity;
 	/// The pixels of the image
 	Pixel_T* _pixels;
 };
@@ -0,0 +1,49 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+///
+/// @brief Recycles the pixel buffers of ImageData. Released buffers are kept as slabs keyed by their size
+/// 	   (width * height * pixel size) and handed out again for an image of the same dimensions, so a
+/// 	   capture running at a fixed resolution does not allocate pixel memory per frame in steady state.
+/// 	   The pool is thread safe, images are allocated and released from different threads.
+///
+class ImageDataPool
+{
+public:
+	struct Statistics
+	{
+		/// Heap allocations of pixel buffers since start
+		uint64_t allocations;
+		/// Heap allocations of pixel buffers in the last second
+		uint64_t allocationsPerSecond;
+		/// Buffers which have been handed out again
+		uint64_t reused;
+		/// Bytes currently held by free slabs
+		size_t cachedBytes;
+	};
+
+	///
+	/// @brief Get a buffer of the given size, from the pool if available
+	/// @param bytes  The size of the buffer in bytes
+	/// @return The buffer
+	///
+	static void* allocate(size_t bytes);
+
+	///
+	/// @brief Return a buffer to the pool, it is freed if the pool is full
+	/// @param buffer  The buffer as returned by allocate(), might be nullptr
+	/// @param bytes   The size the buffer was allocated with
+	///
+	static void release(void* buffer, size_t bytes);
+
+	///
+	/// @brief Get the allocation statistics
+	///
+	static Statistics getStatistics();
+
+private:
+	ImageDataPool() = delete;
+};
@@ -17,6 +17,27 @@ public:
 	void setVideoMode(VideoMode mode);
 	void processImage(const uint8_t * data, int width, int height, int lineLength, PixelFormat pixelFormat, Image<ColorRgb> & outputImage) const;
 
+	///
+	/// @brief Get the size of the image processImage() creates for a source of the given size
+	/// @param[in]  width        The width of the source
+	/// @param[in]  height       The height of the source
+	/// @param[out] outputWidth  The width of the output image
+	/// @param[out] outputHeight The height of the output image
+	///
+	void getOutputSize(int width, int height, int & outputWidth, int & outputHeight) const;
+
+	///
+	/// @brief Convert a part of a single output row without creating the output image
+	/// @param[in]  data        The source data
+	/// @param[in]  lineLength  The length of a source line in bytes
+	/// @param[in]  pixelFormat The pixel format of the source
+	/// @param[in]  yDest       The output row
+	/// @param[in]  xDest       The first output column
+	/// @param[in]  count       The number of output pixels
+	/// @param[out] dest        Buffer for count output pixels
+	///
+	void processLine(const uint8_t * data, int lineLength, PixelFormat pixelFormat, int yDest, int xDest, int count, ColorRgb * dest) const;
+
 private:
 	int _horizontalDecimation;
 	int _verticalDecimation;
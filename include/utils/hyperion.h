@@ -157,6 +157,8 @@ namespace hyperion {
 			//Info(Logger::getInstance("HYPERION"), "ColorAdjustment '%s' => [%s]", QSTRING_CSTR(colorAdjustment->_id), ss.str().c_str());
 		}
 
+		adjustment->setLutSize(colorConfig["adjustmentLutSize"].toInt(0));
+
 		return adjustment;
 	}
 
@@ -199,6 +199,12 @@ bool API::clearPriority(int priority, QString &replyMsg, hyperion::Components ca
     return true;
 }
 
+void API::setInputBlending(int priority, const QString &blendMode, int opacity)
+{
+    const int mode = PriorityMuxer::blendModeFromString(blendMode);
+    QMetaObject::invokeMethod(_hyperion, "setInputBlending", Qt::QueuedConnection, Q_ARG(int, priority), Q_ARG(int, mode), Q_ARG(int, opacity));
+}
+
 bool API::setComponentState(const QString &comp, bool &compState, QString &replyMsg, hyperion::Components callerComp)
 {
     Components component = stringToComponent(comp);
@@ -4,8 +4,6 @@
 // Qt includes
 #include <QResource>
 #include <QDateTime>
-#include <QImage>
-#include <QBuffer>
 #include <QByteArray>
 #include <QTimer>
 #include <QHostInfo>
@@ -24,6 +22,7 @@
 #include <utils/ColorSys.h>
 #include <utils/Process.h>
 #include <utils/JsonUtils.h>
+#include <utils/ImageDataPool.h>
 
 // bonjour wrapper
 #ifdef ENABLE_AVAHI
@@ -33,6 +32,9 @@
 // ledmapping int <> string transform methods
 #include <hyperion/ImageProcessor.h>
 
+// live image preview
+#include <hyperion/ImageStream.h>
+
 // api includes
 #include <api/JsonCB.h>
 
@@ -41,6 +43,15 @@
 
 using namespace hyperion;
 
+namespace {
+
+/// The type of a binary message of the image stream, a JPEG follows the 4 byte header
+/// The types of the ledstream are defined by LedStreamEncoder::FrameType
+const char IMAGE_FRAME = 0x03;
+const int IMAGE_FRAME_HEADER_SIZE = 4;
+
+} // namespace
+
 JsonAPI::JsonAPI(QString peerAddress, Logger* log, bool localConnection, QObject* parent, bool noListener)
 	: API(log, localConnection, parent)
 {
@@ -49,10 +60,18 @@ JsonAPI::JsonAPI(QString peerAddress, Logger* log, bool localConnection, QObject
 	_jsonCB = new JsonCB(this);
 	_streaming_logging_activated = false;
 	_ledStreamTimer = new QTimer(this);
+	_binaryMessagesSupported = false;
+	_ledStreamBinary = false;
+	_imageStreamBinary = false;
 
 	Q_INIT_RESOURCE(JSONRPC_schemas);
 }
 
+void JsonAPI::setBinaryMessagesSupported(bool supported)
+{
+	_binaryMessagesSupported = supported;
+}
+
 void JsonAPI::initialize()
 {
 	// init API, REQUIRED!
@@ -203,6 +222,8 @@ void JsonAPI::handleColorCommand(const QJsonObject& message, const QString& comm
 	}
 
 	API::setColor(priority, colors, duration, origin);
+	if (message.contains("blend"))
+		API::setInputBlending(priority, message["blend"].toString(), message["opacity"].toInt(255));
 	sendSuccessReply(command, tan);
 }
 
@@ -227,6 +248,8 @@ void JsonAPI::handleImageCommand(const QJsonObject& message, const QString& comm
 		sendErrorReply(replyMsg, command, tan);
 		return;
 	}
+	if (message.contains("blend"))
+		API::setInputBlending(idata.priority, message["blend"].toString(), message["opacity"].toInt(255));
 	sendSuccessReply(command, tan);
 }
 
@@ -244,7 +267,11 @@ void JsonAPI::handleEffectCommand(const QJsonObject& message, const QString& com
 	dat.args = message["effect"].toObject()["args"].toObject();
 
 	if (API::setEffect(dat))
+	{
+		if (message.contains("blend"))
+			API::setInputBlending(dat.priority, message["blend"].toString(), message["opacity"].toInt(255));
 		sendSuccessReply(command, tan);
+	}
 	else
 		sendErrorReply("Effect '" + dat.effectName + "' not found", command, tan);
 }
@@ -332,6 +359,13 @@ void JsonAPI::handleServerInfoCommand(const QJsonObject& message, const QString&
 		item["active"] = (priorityInfo.timeoutTime_ms >= -1);
 		item["visible"] = (priority == currentPriority);
 
+		// a blended priority is composited onto the priorities below it
+		if (priorityInfo.blendMode != PriorityMuxer::BLEND_NONE)
+		{
+			item["blend"] = PriorityMuxer::blendModeToString(priorityInfo.blendMode);
+			item["opacity"] = priorityInfo.opacity;
+		}
+
 		if (priorityInfo.componentId == hyperion::COMP_COLOR && !priorityInfo.ledColors.empty())
 		{
 			QJsonObject LEDcolor;
@@ -464,6 +498,27 @@ void JsonAPI::handleServerInfoCommand(const QJsonObject& message, const QString&
 	ledDevices["available"] = availableLedDevices;
 	info["ledDevices"] = ledDevices;
 
+	// image buffer allocations, steady state capture is expected to be allocation free
+	const ImageDataPool::Statistics poolStatistics = ImageDataPool::getStatistics();
+	QJsonObject imagePool;
+	imagePool["allocations"] = static_cast<double>(poolStatistics.allocations);
+	imagePool["allocationsPerSecond"] = static_cast<double>(poolStatistics.allocationsPerSecond);
+	imagePool["reused"] = static_cast<double>(poolStatistics.reused);
+	imagePool["cachedBytes"] = static_cast<double>(poolStatistics.cachedBytes);
+	info["imagePool"] = imagePool;
+
+	// captured frames replaced by a newer one before this instance processed them
+	QJsonObject droppedFrames;
+	droppedFrames["systemCapture"] = static_cast<double>(_hyperion->getCaptureDroppedFrames(hyperion::COMP_GRABBER));
+	droppedFrames["v4lCapture"] = static_cast<double>(_hyperion->getCaptureDroppedFrames(hyperion::COMP_V4L));
+	info["droppedFrames"] = droppedFrames;
+
+	// schedule of the smoothed device writes
+	info["smoothing"] = _hyperion->getSmoothingStatistics();
+
+	// latest frame queue of the led device, a slow device drops frames instead of adding latency
+	info["ledDevice"] = _hyperion->getLedDeviceStatistics();
+
 	QJsonObject grabbers;
 	QJsonArray availableGrabbers;
 
@@ -974,6 +1029,16 @@ void JsonAPI::handleLedColorsCommand(const QJsonObject& message, const QString&
 
 	if (subcommand == "ledstream-start")
 	{
+		// raw RGB bytes, delta encoded against the previous frame, instead of a json array per frame
+		const bool binary = (message["format"].toString("json") == "binary");
+		if (binary && !_binaryMessagesSupported)
+		{
+			sendErrorReply("Binary ledstream is not supported by this connection", command + "-" + subcommand, tan);
+			return;
+		}
+		_ledStreamBinary = binary;
+		_ledStreamEncoder.reset();
+
 		_streaming_leds_reply["success"] = true;
 		_streaming_leds_reply["command"] = command + "-ledstream-update";
 		_streaming_leds_reply["tan"] = tan;
@@ -1005,15 +1070,29 @@ void JsonAPI::handleLedColorsCommand(const QJsonObject& message, const QString&
 	}
 	else if (subcommand == "imagestream-start")
 	{
+		// the JPEG without base64 and json
+		const bool binary = (message["format"].toString("json") == "binary");
+		if (binary && !_binaryMessagesSupported)
+		{
+			sendErrorReply("Binary imagestream is not supported by this connection", command + "-" + subcommand, tan);
+			return;
+		}
+		_imageStreamBinary = binary;
+
 		_streaming_image_reply["success"] = true;
 		_streaming_image_reply["command"] = command + "-imagestream-update";
 		_streaming_image_reply["tan"] = tan;
 
-		connect(_hyperion, &Hyperion::currentImage, this, &JsonAPI::setImage, Qt::UniqueConnection);
+		// the images are encoded once by the instance for all clients
+		ImageStream* imageStream = _hyperion->getImageStream();
+		disconnect(_imageStreamConnection);
+		_imageStreamConnection = connect(imageStream, &ImageStream::imageEncoded, this, &JsonAPI::streamImageUpdate);
+		QMetaObject::invokeMethod(imageStream, "subscriptionChanged", Qt::QueuedConnection);
 	}
 	else if (subcommand == "imagestream-stop")
 	{
-		disconnect(_hyperion, &Hyperion::currentImage, this, 0);
+		// the stream stops by itself without subscribers
+		disconnect(_imageStreamConnection);
 	}
 	else
 	{
@@ -1487,6 +1566,16 @@ void JsonAPI::sendErrorReply(const QString& error, const QString& command, int t
 
 void JsonAPI::streamLedcolorsUpdate(const std::vector<ColorRgb>& ledColors)
 {
+	if (_ledStreamBinary)
+	{
+		// nothing is sent, if no led changed
+		if (_ledStreamEncoder.encode(ledColors, _ledStreamFrame))
+		{
+			emit callbackBinaryMessage(_ledStreamFrame);
+		}
+		return;
+	}
+
 	QJsonObject result;
 	QJsonArray leds;
 
@@ -1502,16 +1591,19 @@ void JsonAPI::streamLedcolorsUpdate(const std::vector<ColorRgb>& ledColors)
 	emit callbackMessage(_streaming_leds_reply);
 }
 
-void JsonAPI::setImage(const Image<ColorRgb>& image)
+void JsonAPI::streamImageUpdate(const QByteArray& jpeg)
 {
-	QImage jpgImage((const uint8_t*)image.memptr(), image.width(), image.height(), 3 * image.width(), QImage::Format_RGB888);
-	QByteArray ba;
-	QBuffer buffer(&ba);
-	buffer.open(QIODevice::WriteOnly);
-	jpgImage.save(&buffer, "jpg");
+	if (_imageStreamBinary)
+	{
+		QByteArray frame(IMAGE_FRAME_HEADER_SIZE, 0);
+		frame[0] = IMAGE_FRAME;
+		frame.append(jpeg);
+		emit callbackBinaryMessage(frame);
+		return;
+	}
 
 	QJsonObject result;
-	result["image"] = "data:image/jpg;base64," + QString(ba.toBase64());
+	result["image"] = "data:image/jpg;base64," + QString(jpeg.toBase64());
 	_streaming_image_reply["result"] = result;
 	emit callbackMessage(_streaming_image_reply);
 }
@@ -1608,4 +1700,6 @@ void JsonAPI::stopDataConnections()
 	disconnect(_hyperion, &Hyperion::rawLedColors, this, 0);
 	_ledStreamTimer->stop();
 	disconnect(_ledStreamConnection);
+	// image stream
+	disconnect(_imageStreamConnection);
 }
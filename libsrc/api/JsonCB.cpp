@@ -240,6 +240,13 @@ void JsonCB::handlePriorityUpdate()
 		item["active"] = (priorityInfo.timeoutTime_ms >= -1);
 		item["visible"] = (priority == currentPriority);
 
+		// a blended priority is composited onto the priorities below it
+		if (priorityInfo.blendMode != PriorityMuxer::BLEND_NONE)
+		{
+			item["blend"] = PriorityMuxer::blendModeToString(priorityInfo.blendMode);
+			item["opacity"] = priorityInfo.opacity;
+		}
+
 		if(priorityInfo.componentId == hyperion::COMP_COLOR && !priorityInfo.ledColors.empty())
 		{
 			QJsonObject LEDcolor;
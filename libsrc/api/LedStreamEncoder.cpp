@@ -0,0 +1,120 @@
+#include <api/LedStreamEncoder.h>
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/// The size of the frame header
+const int HEADER_SIZE = 4;
+
+/// The size of the header of a run of a delta frame
+const int RUN_HEADER_SIZE = 4;
+
+/// The number of unchanged LEDs merged into a run, more cost more than the header of a new run
+const size_t MAX_MERGED_GAP = (RUN_HEADER_SIZE - 1) / 3;
+
+/// The number of LEDs fitting into the 16 bit count
+const size_t MAX_LEDS = 0xFFFF;
+
+inline void writeUInt16(char* dest, size_t value)
+{
+	dest[0] = char((value >> 8) & 0xFF);
+	dest[1] = char(value & 0xFF);
+}
+
+inline void writeHeader(QByteArray& frame, LedStreamEncoder::FrameType type, size_t ledCount)
+{
+	char* header = frame.data();
+	header[0] = char(type);
+	header[1] = 0;
+	writeUInt16(header + 2, ledCount);
+}
+
+} // namespace
+
+LedStreamEncoder::LedStreamEncoder()
+	: _previousColors()
+	, _hasPrevious(false)
+{
+}
+
+void LedStreamEncoder::reset()
+{
+	_hasPrevious = false;
+}
+
+bool LedStreamEncoder::encode(const std::vector<ColorRgb>& ledColors, QByteArray& frame)
+{
+	const size_t ledCount = std::min(ledColors.size(), MAX_LEDS);
+
+	if (!_hasPrevious || _previousColors.size() != ledCount)
+	{
+		encodeFullFrame(ledColors, frame);
+		return true;
+	}
+
+	// the delta frame is not larger than a full frame, otherwise the full frame is sent
+	const int fullFrameSize = HEADER_SIZE + int(ledCount) * 3;
+	frame.resize(fullFrameSize);
+	writeHeader(frame, DELTA_FRAME, ledCount);
+	int size = HEADER_SIZE;
+
+	size_t index = 0;
+	while (index < ledCount)
+	{
+		if (ledColors[index] == _previousColors[index])
+		{
+			++index;
+			continue;
+		}
+
+		// extend the run as long as the gaps of unchanged LEDs are cheaper than a new run
+		size_t last = index;
+		for (size_t next = index + 1; next < ledCount && next <= last + MAX_MERGED_GAP + 1; ++next)
+		{
+			if (ledColors[next] != _previousColors[next])
+			{
+				last = next;
+			}
+		}
+
+		const size_t runLength = last - index + 1;
+		const int runSize = RUN_HEADER_SIZE + int(runLength) * 3;
+		if (size + runSize >= fullFrameSize)
+		{
+			encodeFullFrame(ledColors, frame);
+			return true;
+		}
+
+		char* run = frame.data() + size;
+		writeUInt16(run, index);
+		writeUInt16(run + 2, runLength);
+		memcpy(run + RUN_HEADER_SIZE, &ledColors[index], runLength * 3);
+		std::copy(ledColors.begin() + index, ledColors.begin() + last + 1, _previousColors.begin() + index);
+
+		size += runSize;
+		index = last + 1;
+	}
+
+	if (size == HEADER_SIZE)
+	{
+		return false;
+	}
+
+	frame.resize(size);
+	return true;
+}
+
+void LedStreamEncoder::encodeFullFrame(const std::vector<ColorRgb>& ledColors, QByteArray& frame)
+{
+	const size_t ledCount = std::min(ledColors.size(), MAX_LEDS);
+
+	frame.resize(HEADER_SIZE + int(ledCount) * 3);
+	writeHeader(frame, FULL_FRAME, ledCount);
+	memcpy(frame.data() + HEADER_SIZE, ledColors.data(), ledCount * 3);
+
+	_previousColors.assign(ledColors.begin(), ledColors.begin() + ledCount);
+	_hasPrevious = true;
+}
@@ -113,6 +113,11 @@ bool BlackBorderProcessor::enabled() const
 	return _enabled;
 }
 
+bool BlackBorderProcessor::isSettled() const
+{
+	return !_enabled || (_currentBorder == _previousDetectedBorder && _inconsistentCnt == 0);
+}
+
 void BlackBorderProcessor::setEnabled(bool enable)
 {
 	_enabled = enable;
@@ -1,4 +1,5 @@
 #include "FlatBufferClient.h"
+#include "FlatBufferImageDecoder.h"
 
 // qt
 #include <QTcpSocket>
@@ -6,7 +7,7 @@
 #include <QTimer>
 #include <QRgb>
 
-FlatBufferClient::FlatBufferClient(QTcpSocket* socket, int timeout, QObject *parent)
+FlatBufferClient::FlatBufferClient(QTcpSocket* socket, int timeout, FlatBufferImageDecoder* decoder, QObject *parent)
 	: QObject(parent)
 	, _log(Logger::getInstance("FLATBUFSERVER"))
 	, _socket(socket)
@@ -14,6 +15,9 @@ FlatBufferClient::FlatBufferClient(QTcpSocket* socket, int timeout, QObject *par
 	, _timeoutTimer(new QTimer(this))
 	, _timeout(timeout * 1000)
 	, _priority()
+	, _imageDecoder(decoder)
+	, _standbyInterval_ms(0)
+	, _standbyTimer()
 {
 	// timer setup
 	_timeoutTimer->setSingleShot(true);
@@ -29,37 +33,52 @@ void FlatBufferClient::readyRead()
 {
 	_timeoutTimer->start();
 
-	_receiveBuffer += _socket->readAll();
-
-	// check if we can read a header
-	while(_receiveBuffer.size() >= 4)
+	qint64 available;
+	while((available = _socket->bytesAvailable()) > 0)
 	{
-		uint32_t messageSize =
-			((_receiveBuffer[0]<<24) & 0xFF000000) |
-			((_receiveBuffer[1]<<16) & 0x00FF0000) |
-			((_receiveBuffer[2]<< 8) & 0x0000FF00) |
-			((_receiveBuffer[3]    ) & 0x000000FF);
-
-		// check if we can read a complete message
-		if((uint32_t) _receiveBuffer.size() < messageSize + 4) return;
-
-		// extract message only and remove header + msg from buffer :: QByteArray::remove() does not return the removed data
-		const QByteArray msg = _receiveBuffer.mid(4, messageSize);
-		_receiveBuffer.remove(0, messageSize + 4);
-
-		const auto* msgData = reinterpret_cast<const uint8_t*>(msg.constData());
-		flatbuffers::Verifier verifier(msgData, messageSize);
+		// read directly into the receive buffer, the messages are verified and handled in place
+		char* dest = reinterpret_cast<char*>(_receiveBuffer.reserve(static_cast<size_t>(available)));
+		const qint64 received = _socket->read(dest, available);
+		if(received <= 0) return;
+		_receiveBuffer.commit(static_cast<size_t>(received));
+
+		const uint8_t* msgData;
+		uint32_t messageSize;
+		while(_receiveBuffer.nextMessage(msgData, messageSize))
+		{
+			flatbuffers::Verifier verifier(msgData, messageSize);
+
+			if (hyperionnet::VerifyRequestBuffer(verifier))
+			{
+				auto message = hyperionnet::GetRequest(msgData);
+				handleMessage(message);
+				continue;
+			}
+			sendErrorReply("Unable to parse message");
+		}
 
-		if (hyperionnet::VerifyRequestBuffer(verifier))
+		// the client can't be followed anymore, it is not allowed to make the server allocate the announced size
+		if(_receiveBuffer.isMessageTooLarge())
 		{
-			auto message = hyperionnet::GetRequest(msgData);
-			handleMessage(message);
-			continue;
+			Error(_log, "Message of client %s exceeds the maximum size of %u bytes, closing the connection", QSTRING_CSTR(_clientAddress), FlatBufferReceiveBuffer::MAX_MESSAGE_SIZE);
+			sendErrorReply("Message too large");
+			forceClose();
+			return;
 		}
-		sendErrorReply("Unable to parse message");
 	}
 }
 
+void FlatBufferClient::keepAlive()
+{
+	_timeoutTimer->start();
+}
+
+void FlatBufferClient::setStandbyInterval(int interval_ms)
+{
+	_standbyInterval_ms = interval_ms;
+	_standbyTimer.invalidate();
+}
+
 void FlatBufferClient::forceClose()
 {
 	_socket->close();
@@ -144,6 +163,17 @@ void FlatBufferClient::handleImageCommand(const hyperionnet::Image *image)
 	// extract parameters
 	int duration = image->duration();
 
+	// the priority is hidden in all instances, an image is taken once per interval if it outlasts the interval
+	if (_standbyInterval_ms > 0 && (duration <= 0 || duration > 2 * _standbyInterval_ms))
+	{
+		if (_standbyTimer.isValid() && _standbyTimer.elapsed() < _standbyInterval_ms)
+		{
+			sendSuccessReply();
+			return;
+		}
+		_standbyTimer.start();
+	}
+
 	const void* reqPtr;
 	if ((reqPtr = image->data_as_RawImage()) != nullptr)
 	{
@@ -158,10 +188,21 @@ void FlatBufferClient::handleImageCommand(const hyperionnet::Image *image)
 			return;
 		}
 
+		// the pixels are copied once from the receive buffer into a pooled image
 		Image<ColorRgb> imageDest(width, height);
-		memmove(imageDest.memptr(), imageData->data(), imageData->size());
+		memcpy(imageDest.memptr(), imageData->data(), imageData->size());
 		emit setGlobalInputImage(_priority, imageDest, duration);
 	}
+	else if ((reqPtr = image->data_as_EncodedImage()) != nullptr)
+	{
+		// converted and decompressed on the decoder's thread
+		QString error;
+		if (!_imageDecoder->decode(_priority, duration, static_cast<const hyperionnet::EncodedImage*>(reqPtr), error))
+		{
+			sendErrorReply(error.toStdString());
+			return;
+		}
+	}
 
 	// send reply
 	sendSuccessReply();
@@ -10,8 +10,14 @@
 #include "hyperion_reply_generated.h"
 #include "hyperion_request_generated.h"
 
+#include "FlatBufferReceiveBuffer.h"
+
+// qt
+#include <QElapsedTimer>
+
 class QTcpSocket;
 class QTimer;
+class FlatBufferImageDecoder;
 
 namespace flatbuf {
 	class HyperionRequest;
@@ -28,9 +34,27 @@ public:
 	/// @brief Construct the client
 	/// @param socket   The socket
 	/// @param timeout  The timeout when a client is automatically disconnected and the priority unregistered
+	/// @param decoder  The decoder of compressed images, shared by all clients
 	/// @param parent   The parent
 	///
-	explicit FlatBufferClient(QTcpSocket* socket, int timeout, QObject *parent = nullptr);
+	explicit FlatBufferClient(QTcpSocket* socket, int timeout, FlatBufferImageDecoder* decoder, QObject *parent = nullptr);
+
+	///
+	/// @brief Get the priority registered by the client
+	///
+	int getPriority() const { return _priority; }
+
+	///
+	/// @brief Restart the timeout, the client sends its images via another way (shared memory)
+	///
+	void keepAlive();
+
+	///
+	/// @brief Take only one image per interval, while the priority is hidden in all instances. Images in between
+	/// 	   are neither copied nor decoded
+	/// @param interval_ms  The interval in milliseconds, 0 to take every image
+	///
+	void setStandbyInterval(int interval_ms);
 
 signals:
 	///
@@ -139,8 +163,13 @@ private:
 	QTimer *_timeoutTimer;
 	int _timeout;
 	int _priority;
+	FlatBufferImageDecoder* _imageDecoder;
+
+	/// Images are taken once per interval while the priority is hidden in all instances
+	int _standbyInterval_ms;
+	QElapsedTimer _standbyTimer;
 
-	QByteArray _receiveBuffer;
+	FlatBufferReceiveBuffer _receiveBuffer;
 
 	// Flatbuffers builder
 	flatbuffers::FlatBufferBuilder _builder;
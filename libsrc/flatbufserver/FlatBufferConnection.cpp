@@ -1,5 +1,6 @@
 // stl includes
 #include <stdexcept>
+#include <cstring>
 
 // Qt includes
 #include <QRgb>
@@ -11,6 +12,9 @@
 #include "hyperion_reply_generated.h"
 #include "hyperion_request_generated.h"
 
+#include "SharedMemoryRing.h"
+#include "FlatBufferImageCodec.h"
+
 FlatBufferConnection::FlatBufferConnection(const QString& origin, const QString & address, int priority, bool skipReply)
 	: _socket()
 	, _origin(origin)
@@ -18,6 +22,11 @@ FlatBufferConnection::FlatBufferConnection(const QString& origin, const QString
 	, _prevSocketState(QAbstractSocket::UnconnectedState)
 	, _log(Logger::getInstance("FLATBUFCONN"))
 	, _registered(false)
+	, _sharedMemory(new SharedMemoryRing())
+	, _sharedMemoryChannel(-1)
+	, _sharedMemoryTried(false)
+	, _imageFormat(hyperionnet::ImageFormat_RGB24)
+	, _imageCompression(hyperionnet::ImageCompression_Uncompressed)
 {
 	QStringList parts = address.split(":");
 	if (parts.size() != 2)
@@ -50,6 +59,8 @@ FlatBufferConnection::FlatBufferConnection(const QString& origin, const QString
 FlatBufferConnection::~FlatBufferConnection()
 {
 	_timer.stop();
+	detachSharedMemory();
+	delete _sharedMemory;
 	_socket.close();
 }
 
@@ -95,6 +106,9 @@ void FlatBufferConnection::setSkipReply(bool skip)
 
 void FlatBufferConnection::setRegister(const QString& origin, int priority)
 {
+	// the shared memory channel is claimed for the registered priority
+	detachSharedMemory();
+
 	auto registerReq = hyperionnet::CreateRegister(_builder, _builder.CreateString(QSTRING_CSTR(origin)), priority);
 	auto req = hyperionnet::CreateRequest(_builder, hyperionnet::Command_Register, registerReq.Union());
 
@@ -126,9 +140,29 @@ void FlatBufferConnection::setColor(const ColorRgb & color, int priority, int du
 
 void FlatBufferConnection::setImage(const Image<ColorRgb> &image)
 {
-	auto imgData = _builder.CreateVector(reinterpret_cast<const uint8_t*>(image.memptr()), image.size());
-	auto rawImg = hyperionnet::CreateRawImage(_builder, imgData, image.width(), image.height());
-	auto imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_RawImage, rawImg.Union(), -1);
+	if (setSharedMemoryImage(image))
+	{
+		return;
+	}
+
+	flatbuffers::Offset<hyperionnet::Image> imageReq;
+	if (_imageFormat == hyperionnet::ImageFormat_RGB24 && _imageCompression == hyperionnet::ImageCompression_Uncompressed)
+	{
+		// a RawImage is understood by servers without EncodedImage support as well
+		auto imgData = _builder.CreateVector(reinterpret_cast<const uint8_t*>(image.memptr()), image.size());
+		auto rawImg = hyperionnet::CreateRawImage(_builder, imgData, image.width(), image.height());
+		imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_RawImage, rawImg.Union(), -1);
+	}
+	else
+	{
+		const auto format = static_cast<hyperionnet::ImageFormat>(_imageFormat);
+		const auto compression = static_cast<hyperionnet::ImageCompression>(_imageCompression);
+		FlatBufferImageCodec::encode(image, format, compression, _encodedImage);
+
+		auto imgData = _builder.CreateVector(reinterpret_cast<const uint8_t*>(_encodedImage.constData()), _encodedImage.size());
+		auto encodedImg = hyperionnet::CreateEncodedImage(_builder, imgData, image.width(), image.height(), format, compression);
+		imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_EncodedImage, encodedImg.Union(), -1);
+	}
 	auto req = hyperionnet::CreateRequest(_builder,hyperionnet::Command_Image,imageReq.Union());
 
 	_builder.Finish(req);
@@ -136,6 +170,99 @@ void FlatBufferConnection::setImage(const Image<ColorRgb> &image)
 	_builder.Clear();
 }
 
+bool FlatBufferConnection::setImageEncoding(const QString& format, const QString& compression)
+{
+	const QString formatName = format.toLower();
+	if (formatName == "rgb24")
+		_imageFormat = hyperionnet::ImageFormat_RGB24;
+	else if (formatName == "rgb565")
+		_imageFormat = hyperionnet::ImageFormat_RGB565;
+	else if (formatName == "nv12")
+		_imageFormat = hyperionnet::ImageFormat_NV12;
+	else if (formatName == "i420")
+		_imageFormat = hyperionnet::ImageFormat_I420;
+	else
+	{
+		Error(_log, "Unknown image format '%s'", QSTRING_CSTR(format));
+		return false;
+	}
+
+	const QString compressionName = compression.toLower();
+	if (compressionName == "none")
+		_imageCompression = hyperionnet::ImageCompression_Uncompressed;
+	else if (compressionName == "zlib")
+		_imageCompression = hyperionnet::ImageCompression_Zlib;
+	else if (compressionName == "jpeg")
+		_imageCompression = hyperionnet::ImageCompression_Jpeg;
+	else
+	{
+		Error(_log, "Unknown image compression '%s'", QSTRING_CSTR(compression));
+		return false;
+	}
+
+	if (_imageFormat != hyperionnet::ImageFormat_RGB24 || _imageCompression != hyperionnet::ImageCompression_Uncompressed)
+	{
+		Info(_log, "Images are sent as %s, compression %s", QSTRING_CSTR(formatName), QSTRING_CSTR(compressionName));
+	}
+	return true;
+}
+
+bool FlatBufferConnection::setSharedMemoryImage(const Image<ColorRgb> &image)
+{
+	// the server accepts shared memory images of a registered priority only
+	if (_socket.state() != QAbstractSocket::ConnectedState || !_registered)
+	{
+		detachSharedMemory();
+		return false;
+	}
+
+	if (_sharedMemoryChannel < 0)
+	{
+		if (_sharedMemoryTried || !_socket.peerAddress().isLoopback())
+		{
+			return false;
+		}
+		_sharedMemoryTried = true;
+
+		QString error;
+		if (!_sharedMemory->attach(SharedMemoryRing::segmentName(_port), error))
+		{
+			Debug(_log, "Images are sent via TCP. %s", QSTRING_CSTR(error));
+			return false;
+		}
+
+		_sharedMemoryChannel = _sharedMemory->claimChannel(_priority);
+		if (_sharedMemoryChannel < 0)
+		{
+			Debug(_log, "Images are sent via TCP, all shared memory channels are in use");
+			_sharedMemory->close();
+			return false;
+		}
+		Info(_log, "Images are sent via shared memory");
+	}
+
+	ColorRgb* pixels = _sharedMemory->beginFrame(_sharedMemoryChannel, image.width(), image.height());
+	if (pixels == nullptr)
+	{
+		return false;
+	}
+
+	memcpy(pixels, image.memptr(), image.size());
+	_sharedMemory->commitFrame(_sharedMemoryChannel, -1);
+	return true;
+}
+
+void FlatBufferConnection::detachSharedMemory()
+{
+	if (_sharedMemory->isOpen())
+	{
+		_sharedMemory->releaseChannel(_sharedMemoryChannel);
+		_sharedMemory->close();
+	}
+	_sharedMemoryChannel = -1;
+	_sharedMemoryTried = false;
+}
+
 void FlatBufferConnection::clear(int priority)
 {
 	auto clearReq = hyperionnet::CreateClear(_builder, priority);
@@ -0,0 +1,339 @@
+#include "FlatBufferImageCodec.h"
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+// Qt includes
+#include <QBuffer>
+#include <QImage>
+#include <QImageReader>
+
+// util
+#include <utils/ColorSys.h>
+
+namespace {
+
+/// The JPEG quality of encoded images
+const int JPEG_QUALITY = 85;
+
+/// The zlib level of encoded images, the fastest one, most of the gain of a grabbed image is there already
+const int ZLIB_LEVEL = 1;
+
+/// The size of the size prefix of zlib compressed data
+const uint32_t ZLIB_HEADER_SIZE = 4;
+
+inline uint8_t clampToByte(int value)
+{
+	return (value < 0) ? 0 : ((value > 255) ? 255 : static_cast<uint8_t>(value));
+}
+
+/// Inverse of ColorSys::yuv2rgb (BT.601, limited range)
+inline uint8_t rgbToY(int r, int g, int b)
+{
+	return clampToByte(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline uint8_t rgbToU(int r, int g, int b)
+{
+	return clampToByte(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline uint8_t rgbToV(int r, int g, int b)
+{
+	return clampToByte(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+///
+/// @brief Convert the decompressed data to RGB
+///
+void toRgb(const uint8_t* data, hyperionnet::ImageFormat format, Image<ColorRgb>& image)
+{
+	const int width = image.width();
+	const int height = image.height();
+	ColorRgb* pixel = image.memptr();
+
+	switch (format)
+	{
+		case hyperionnet::ImageFormat_RGB565:
+		{
+			for (int i = 0; i < width * height; ++i, data += 2, ++pixel)
+			{
+				const uint16_t value = uint16_t(data[0] | (data[1] << 8));
+				const uint8_t red   = (value >> 11) & 0x1F;
+				const uint8_t green = (value >>  5) & 0x3F;
+				const uint8_t blue  =  value        & 0x1F;
+				pixel->red   = uint8_t((red << 3) | (red >> 2));
+				pixel->green = uint8_t((green << 2) | (green >> 4));
+				pixel->blue  = uint8_t((blue << 3) | (blue >> 2));
+			}
+			break;
+		}
+		case hyperionnet::ImageFormat_NV12:
+		case hyperionnet::ImageFormat_I420:
+		{
+			const int chromaWidth = (width + 1) / 2;
+			const int chromaHeight = (height + 1) / 2;
+			const uint8_t* luma = data;
+			const uint8_t* chroma = data + width * height;
+			const bool interleaved = (format == hyperionnet::ImageFormat_NV12);
+
+			for (int y = 0; y < height; ++y)
+			{
+				const uint8_t* lumaRow = luma + y * width;
+				const int chromaRow = (y / 2) * chromaWidth;
+				for (int x = 0; x < width; ++x, ++pixel)
+				{
+					const int chromaIndex = chromaRow + x / 2;
+					const uint8_t u = interleaved ? chroma[2 * chromaIndex]     : chroma[chromaIndex];
+					const uint8_t v = interleaved ? chroma[2 * chromaIndex + 1] : chroma[chromaWidth * chromaHeight + chromaIndex];
+					ColorSys::yuv2rgb(lumaRow[x], u, v, pixel->red, pixel->green, pixel->blue);
+				}
+			}
+			break;
+		}
+		default:
+			memcpy(pixel, data, size_t(width) * height * 3);
+			break;
+	}
+}
+
+///
+/// @brief Convert RGB to the pixel format, the chroma of YUV 4:2:0 is the mean of 2x2 pixels
+///
+void fromRgb(const Image<ColorRgb>& image, hyperionnet::ImageFormat format, QByteArray& data)
+{
+	const int width = image.width();
+	const int height = image.height();
+	const ColorRgb* pixels = image.memptr();
+
+	data.resize(static_cast<int>(FlatBufferImageCodec::formatSize(format, width, height)));
+	uint8_t* dest = reinterpret_cast<uint8_t*>(data.data());
+
+	switch (format)
+	{
+		case hyperionnet::ImageFormat_RGB565:
+		{
+			for (int i = 0; i < width * height; ++i, dest += 2)
+			{
+				const ColorRgb& pixel = pixels[i];
+				const uint16_t value = uint16_t(((pixel.red >> 3) << 11) | ((pixel.green >> 2) << 5) | (pixel.blue >> 3));
+				dest[0] = uint8_t(value);
+				dest[1] = uint8_t(value >> 8);
+			}
+			break;
+		}
+		case hyperionnet::ImageFormat_NV12:
+		case hyperionnet::ImageFormat_I420:
+		{
+			const int chromaWidth = (width + 1) / 2;
+			const int chromaHeight = (height + 1) / 2;
+			uint8_t* chroma = dest + width * height;
+			const bool interleaved = (format == hyperionnet::ImageFormat_NV12);
+
+			for (int i = 0; i < width * height; ++i)
+			{
+				dest[i] = rgbToY(pixels[i].red, pixels[i].green, pixels[i].blue);
+			}
+
+			for (int cy = 0; cy < chromaHeight; ++cy)
+			{
+				const int y0 = 2 * cy;
+				const int y1 = std::min(y0 + 1, height - 1);
+				for (int cx = 0; cx < chromaWidth; ++cx)
+				{
+					const int x0 = 2 * cx;
+					const int x1 = std::min(x0 + 1, width - 1);
+					const ColorRgb& p00 = pixels[y0 * width + x0];
+					const ColorRgb& p01 = pixels[y0 * width + x1];
+					const ColorRgb& p10 = pixels[y1 * width + x0];
+					const ColorRgb& p11 = pixels[y1 * width + x1];
+					const int r = (p00.red   + p01.red   + p10.red   + p11.red   + 2) >> 2;
+					const int g = (p00.green + p01.green + p10.green + p11.green + 2) >> 2;
+					const int b = (p00.blue  + p01.blue  + p10.blue  + p11.blue  + 2) >> 2;
+
+					const int chromaIndex = cy * chromaWidth + cx;
+					if (interleaved)
+					{
+						chroma[2 * chromaIndex]     = rgbToU(r, g, b);
+						chroma[2 * chromaIndex + 1] = rgbToV(r, g, b);
+					}
+					else
+					{
+						chroma[chromaIndex] = rgbToU(r, g, b);
+						chroma[chromaWidth * chromaHeight + chromaIndex] = rgbToV(r, g, b);
+					}
+				}
+			}
+			break;
+		}
+		default:
+			memcpy(dest, pixels, image.size());
+			break;
+	}
+}
+
+} // namespace
+
+size_t FlatBufferImageCodec::formatSize(hyperionnet::ImageFormat format, int width, int height)
+{
+	const size_t pixels = size_t(width) * size_t(height);
+	switch (format)
+	{
+		case hyperionnet::ImageFormat_RGB565:
+			return pixels * 2;
+		case hyperionnet::ImageFormat_NV12:
+		case hyperionnet::ImageFormat_I420:
+			return pixels + 2 * size_t((width + 1) / 2) * size_t((height + 1) / 2);
+		default:
+			return pixels * 3;
+	}
+}
+
+bool FlatBufferImageCodec::validate(const hyperionnet::EncodedImage* image, QString& error)
+{
+	const auto* data = image->data();
+	if (data == nullptr || data->size() == 0)
+	{
+		error = "Image data is missing";
+		return false;
+	}
+
+	if (image->format() < hyperionnet::ImageFormat_MIN || image->format() > hyperionnet::ImageFormat_MAX)
+	{
+		error = QString("Unknown image format %1").arg(int(image->format()));
+		return false;
+	}
+
+	// the size of a JPEG is taken from the file
+	if (image->compression() == hyperionnet::ImageCompression_Jpeg)
+	{
+		return true;
+	}
+
+	const int width = image->width();
+	const int height = image->height();
+	if (width <= 0 || height <= 0 || width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE)
+	{
+		error = QString("Invalid image size %1x%2").arg(width).arg(height);
+		return false;
+	}
+
+	const size_t expected = formatSize(image->format(), width, height);
+	switch (image->compression())
+	{
+		case hyperionnet::ImageCompression_Uncompressed:
+			if (data->size() != expected)
+			{
+				error = "Size of image data does not match with the width, height and format";
+				return false;
+			}
+			return true;
+
+		case hyperionnet::ImageCompression_Zlib:
+		{
+			// the decompressed size is known before decompressing, which allocates it
+			if (data->size() < ZLIB_HEADER_SIZE)
+			{
+				error = "Compressed image data is truncated";
+				return false;
+			}
+			const uint8_t* header = data->data();
+			const size_t size = (size_t(header[0]) << 24) | (size_t(header[1]) << 16) | (size_t(header[2]) << 8) | size_t(header[3]);
+			if (size != expected)
+			{
+				error = "Size of the decompressed image data does not match with the width, height and format";
+				return false;
+			}
+			return true;
+		}
+
+		default:
+			error = QString("Unknown image compression %1").arg(int(image->compression()));
+			return false;
+	}
+}
+
+bool FlatBufferImageCodec::decode(const QByteArray& data, int width, int height, hyperionnet::ImageFormat format,
+								  hyperionnet::ImageCompression compression, Image<ColorRgb>& image, QString& error)
+{
+	if (compression == hyperionnet::ImageCompression_Jpeg)
+	{
+		QBuffer buffer;
+		buffer.setData(data);
+		buffer.open(QIODevice::ReadOnly);
+
+		QImageReader reader(&buffer, "jpg");
+		const QSize size = reader.size();
+		if (size.width() <= 0 || size.height() <= 0 || size.width() > MAX_IMAGE_SIZE || size.height() > MAX_IMAGE_SIZE)
+		{
+			error = QString("Invalid JPEG image size %1x%2").arg(size.width()).arg(size.height());
+			return false;
+		}
+
+		QImage decoded;
+		if (!reader.read(&decoded))
+		{
+			error = "Failed to decode JPEG image: " + reader.errorString();
+			return false;
+		}
+
+		decoded = decoded.convertToFormat(QImage::Format_RGB888);
+		image.resize(decoded.width(), decoded.height());
+		const size_t lineSize = size_t(decoded.width()) * 3;
+		for (int y = 0; y < decoded.height(); ++y)
+		{
+			memcpy(image.memptr() + y * decoded.width(), decoded.constScanLine(y), lineSize);
+		}
+		return true;
+	}
+
+	const size_t expected = formatSize(format, width, height);
+	image.resize(width, height);
+
+	if (compression == hyperionnet::ImageCompression_Zlib)
+	{
+		const QByteArray decompressed = qUncompress(data);
+		if (size_t(decompressed.size()) != expected)
+		{
+			error = "Failed to decompress image data";
+			return false;
+		}
+		toRgb(reinterpret_cast<const uint8_t*>(decompressed.constData()), format, image);
+		return true;
+	}
+
+	if (size_t(data.size()) != expected)
+	{
+		error = "Size of image data does not match with the width, height and format";
+		return false;
+	}
+	toRgb(reinterpret_cast<const uint8_t*>(data.constData()), format, image);
+	return true;
+}
+
+void FlatBufferImageCodec::encode(const Image<ColorRgb>& image, hyperionnet::ImageFormat format,
+								  hyperionnet::ImageCompression compression, QByteArray& data)
+{
+	if (compression == hyperionnet::ImageCompression_Jpeg)
+	{
+		const QImage rgb(reinterpret_cast<const uchar*>(image.memptr()), image.width(), image.height(),
+						 image.width() * 3, QImage::Format_RGB888);
+
+		data.clear();
+		QBuffer buffer(&data);
+		buffer.open(QIODevice::WriteOnly);
+		rgb.save(&buffer, "jpg", JPEG_QUALITY);
+		return;
+	}
+
+	if (compression == hyperionnet::ImageCompression_Zlib)
+	{
+		QByteArray raw;
+		fromRgb(image, format, raw);
+		data = qCompress(raw, ZLIB_LEVEL);
+		return;
+	}
+
+	fromRgb(image, format, data);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Qt includes
+#include <QByteArray>
+#include <QString>
+
+// util
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+// flatbuffer FBS
+#include "hyperion_request_generated.h"
+
+///
+/// @brief Conversion between an Image and the data of an EncodedImage of the flatbuffer protocol
+///
+/// Grabbers on a slow network send their images with less bytes per pixel (RGB565, NV12) and/or compressed,
+/// the server converts them back to RGB.
+///
+class FlatBufferImageCodec
+{
+public:
+	/// The largest width and height accepted, limits the memory allocated for a received image
+	static const int MAX_IMAGE_SIZE = 4096;
+
+	///
+	/// @brief Get the size of the (decompressed) data of an image
+	/// @param format  The pixel format
+	/// @param width   The width
+	/// @param height  The height
+	/// @return The size in bytes
+	///
+	static size_t formatSize(hyperionnet::ImageFormat format, int width, int height);
+
+	///
+	/// @brief Check an EncodedImage before its data is copied for decoding
+	/// @param image       The image of a request
+	/// @param[out] error  The reason, if invalid
+	/// @return True, if it can be decoded
+	///
+	static bool validate(const hyperionnet::EncodedImage* image, QString& error);
+
+	///
+	/// @brief Decode the data of an EncodedImage
+	/// @param data          The data
+	/// @param width         The width
+	/// @param height        The height
+	/// @param format        The pixel format
+	/// @param compression   The compression
+	/// @param[out] image    The image
+	/// @param[out] error    The reason, if it fails
+	/// @return True on success
+	///
+	static bool decode(const QByteArray& data, int width, int height, hyperionnet::ImageFormat format,
+					   hyperionnet::ImageCompression compression, Image<ColorRgb>& image, QString& error);
+
+	///
+	/// @brief Encode an image as the data of an EncodedImage
+	/// @param image        The image
+	/// @param format       The pixel format, ignored for Jpeg
+	/// @param compression  The compression
+	/// @param[out] data    The data
+	///
+	static void encode(const Image<ColorRgb>& image, hyperionnet::ImageFormat format,
+					   hyperionnet::ImageCompression compression, QByteArray& data);
+};
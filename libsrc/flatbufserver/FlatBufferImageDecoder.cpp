@@ -0,0 +1,63 @@
+#include "FlatBufferImageDecoder.h"
+#include "FlatBufferImageCodec.h"
+
+// Qt includes
+#include <QMutexLocker>
+
+FlatBufferImageDecoder::FlatBufferImageDecoder(QObject* parent)
+	: QObject(parent)
+	, _log(Logger::getInstance("FLATBUFSERVER"))
+	, _processPending(false)
+{
+}
+
+bool FlatBufferImageDecoder::decode(int priority, int duration, const hyperionnet::EncodedImage* image, QString& error)
+{
+	if (!FlatBufferImageCodec::validate(image, error))
+	{
+		return false;
+	}
+
+	Job job;
+	job.duration = duration;
+	job.width = image->width();
+	job.height = image->height();
+	job.format = image->format();
+	job.compression = image->compression();
+	// the data is copied out of the receive buffer, which is reused for the next message
+	job.data = QByteArray(reinterpret_cast<const char*>(image->data()->data()), static_cast<int>(image->data()->size()));
+
+	QMutexLocker locker(&_mutex);
+	_jobs[priority] = job;
+	if (!_processPending)
+	{
+		_processPending = true;
+		QMetaObject::invokeMethod(this, "processJobs", Qt::QueuedConnection);
+	}
+	return true;
+}
+
+void FlatBufferImageDecoder::processJobs()
+{
+	QMap<int, Job> jobs;
+	{
+		QMutexLocker locker(&_mutex);
+		jobs.swap(_jobs);
+		_processPending = false;
+	}
+
+	for (auto it = jobs.constBegin(); it != jobs.constEnd(); ++it)
+	{
+		const Job& job = it.value();
+		Image<ColorRgb> image;
+		QString error;
+		if (FlatBufferImageCodec::decode(job.data, job.width, job.height, job.format, job.compression, image, error))
+		{
+			emit imageDecoded(it.key(), image, job.duration);
+		}
+		else
+		{
+			Warning(_log, "Image of priority %d dropped: %s", it.key(), QSTRING_CSTR(error));
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// Qt includes
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+
+// util
+#include <utils/Logger.h>
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+// flatbuffer FBS
+#include "hyperion_request_generated.h"
+
+///
+/// @brief Decodes the EncodedImages of the FlatBufferClients on its own thread
+///
+/// The clients hand over the (compressed) data and continue reading their sockets. Only the latest image of
+/// a priority is kept, an image still waiting when the next one of the same priority arrives is replaced.
+///
+class FlatBufferImageDecoder : public QObject
+{
+	Q_OBJECT
+public:
+	explicit FlatBufferImageDecoder(QObject* parent = nullptr);
+
+	///
+	/// @brief Check an image and queue it for decoding, thread-safe
+	/// @param priority    The priority of the client
+	/// @param duration    The duration in milliseconds
+	/// @param image       The image of the request
+	/// @param[out] error  The reason, if the image is invalid
+	/// @return False, if the image is invalid
+	///
+	bool decode(int priority, int duration, const hyperionnet::EncodedImage* image, QString& error);
+
+signals:
+	///
+	/// @brief Emits with a decoded image
+	/// @param priority  The priority of the client
+	/// @param image     The image
+	/// @param duration  The duration in milliseconds
+	///
+	void imageDecoded(int priority, const Image<ColorRgb>& image, int duration);
+
+private slots:
+	///
+	/// @brief Decode the queued images
+	///
+	void processJobs();
+
+private:
+	struct Job
+	{
+		int duration;
+		int width;
+		int height;
+		hyperionnet::ImageFormat format;
+		hyperionnet::ImageCompression compression;
+		QByteArray data;
+	};
+
+	Logger* _log;
+
+	/// Guards the queued images
+	QMutex _mutex;
+
+	/// The latest image of each priority waiting for decoding
+	QMap<int, Job> _jobs;
+
+	/// Is a call of processJobs() pending?
+	bool _processPending;
+};
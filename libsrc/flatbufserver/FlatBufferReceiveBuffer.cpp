@@ -0,0 +1,98 @@
+#include "FlatBufferReceiveBuffer.h"
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/// The size of the message header
+const size_t HEADER_SIZE = 4;
+
+/// The initial size, enough for colors and small images
+const size_t INITIAL_CAPACITY = 64 * 1024;
+
+/// The alignment of the scalars of a flatbuffer
+const uintptr_t MESSAGE_ALIGNMENT = 4;
+
+} // namespace
+
+FlatBufferReceiveBuffer::FlatBufferReceiveBuffer()
+	: _buffer(INITIAL_CAPACITY)
+	, _readPos(0)
+	, _writePos(0)
+	, _alignedMessage()
+	, _messageTooLarge(false)
+{
+}
+
+uint8_t* FlatBufferReceiveBuffer::reserve(size_t size)
+{
+	if (_buffer.size() - _writePos < size)
+	{
+		// move the incomplete message to the front
+		const size_t pendingSize = pending();
+		if (_readPos > 0)
+		{
+			memmove(_buffer.data(), _buffer.data() + _readPos, pendingSize);
+			_readPos = 0;
+			_writePos = pendingSize;
+		}
+
+		if (_buffer.size() - _writePos < size)
+		{
+			// grow by the data received only, the size in a header is not trusted before the message arrived
+			const size_t maxCapacity = std::max(HEADER_SIZE + MAX_MESSAGE_SIZE, _writePos + size);
+			_buffer.resize(std::min(std::max(_buffer.size() * 2, _writePos + size), maxCapacity));
+		}
+	}
+	return _buffer.data() + _writePos;
+}
+
+void FlatBufferReceiveBuffer::commit(size_t size)
+{
+	_writePos = std::min(_writePos + size, _buffer.size());
+}
+
+bool FlatBufferReceiveBuffer::nextMessage(const uint8_t*& data, uint32_t& size)
+{
+	if (pending() < HEADER_SIZE)
+	{
+		return false;
+	}
+
+	const uint8_t* header = _buffer.data() + _readPos;
+	const uint32_t messageSize = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) | (uint32_t(header[2]) << 8) | uint32_t(header[3]);
+
+	if (messageSize > MAX_MESSAGE_SIZE)
+	{
+		_messageTooLarge = true;
+		return false;
+	}
+
+	// check if we can read a complete message
+	if (pending() < HEADER_SIZE + messageSize)
+	{
+		return false;
+	}
+
+	data = header + HEADER_SIZE;
+	size = messageSize;
+	_readPos += HEADER_SIZE + messageSize;
+
+	if (_readPos == _writePos)
+	{
+		// all messages handed out, the next data is received at the front
+		_readPos = 0;
+		_writePos = 0;
+	}
+
+	// the scalars are read in place, they have to be aligned
+	if (reinterpret_cast<uintptr_t>(data) % MESSAGE_ALIGNMENT != 0)
+	{
+		_alignedMessage.assign(data, data + messageSize);
+		data = _alignedMessage.data();
+	}
+
+	return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+///
+/// @brief Receive buffer of a flatbuffer connection, messages are framed by a 4 byte big endian size
+///
+/// The socket reads directly into the free space at the end of the buffer and complete messages are handed out
+/// in place, so they are neither copied out nor removed from the front one by one. Only an incomplete message
+/// is moved to the front of the buffer, when the space behind it runs out. The buffer grows with the data
+/// received, up to the size of the largest message, and is reused for all following ones.
+///
+class FlatBufferReceiveBuffer
+{
+public:
+	/// The largest message accepted, a raw 4K image fits
+	static const uint32_t MAX_MESSAGE_SIZE = 32 * 1024 * 1024;
+
+	FlatBufferReceiveBuffer();
+
+	///
+	/// @brief Get space to receive data into
+	/// @param size  The number of bytes to be received
+	/// @return The space for at least size bytes, valid until the next call
+	///
+	uint8_t* reserve(size_t size);
+
+	///
+	/// @brief Add the bytes received into the reserved space
+	/// @param size  The number of bytes received
+	///
+	void commit(size_t size);
+
+	///
+	/// @brief Get the next complete message
+	/// @param[out] data  The message, valid until the next reserve()
+	/// @param[out] size  The size of the message
+	/// @return False, if no complete message was received or the next message is too large
+	///
+	bool nextMessage(const uint8_t*& data, uint32_t& size);
+
+	///
+	/// @return True, if the size of the next message exceeds MAX_MESSAGE_SIZE. The stream can't be continued
+	///
+	bool isMessageTooLarge() const { return _messageTooLarge; }
+
+	///
+	/// @return The number of bytes received but not handed out as a message yet
+	///
+	size_t pending() const { return _writePos - _readPos; }
+
+private:
+	std::vector<uint8_t> _buffer;
+
+	/// The start of the first message not handed out
+	size_t _readPos;
+
+	/// The end of the received data
+	size_t _writePos;
+
+	/// Messages are handed out 4 byte aligned, a misaligned one is copied here
+	std::vector<uint8_t> _alignedMessage;
+
+	/// The size in the header of the next message exceeds MAX_MESSAGE_SIZE
+	bool _messageTooLarge;
+};
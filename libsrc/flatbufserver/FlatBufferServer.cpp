@@ -1,5 +1,7 @@
 #include <flatbufserver/FlatBufferServer.h>
 #include "FlatBufferClient.h"
+#include "FlatBufferImageDecoder.h"
+#include "SharedMemoryServer.h"
 #include "HyperionConfig.h"
 
 // util
@@ -15,12 +17,23 @@
 #include <QJsonObject>
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QThread>
+
+namespace {
+
+/// The interval of the images taken from a client while its priority is hidden in all instances [ms]
+const int STANDBY_INTERVAL_MS = 1000;
+
+} // namespace
 
 FlatBufferServer::FlatBufferServer(const QJsonDocument& config, QObject* parent)
 	: QObject(parent)
 	, _server(new QTcpServer(this))
+	, _sharedMemoryServer(nullptr)
+	, _imageDecoder(nullptr)
 	, _log(Logger::getInstance("FLATBUFSERVER"))
 	, _timeout(5000)
+	, _sharedMemory(false)
 	, _config(config)
 {
 
@@ -30,6 +43,14 @@ FlatBufferServer::~FlatBufferServer()
 {
 	stopServer();
 	delete _server;
+
+	if(_imageDecoder != nullptr)
+	{
+		QThread* thread = _imageDecoder->thread();
+		thread->quit();
+		thread->wait();
+		delete thread;
+	}
 }
 
 void FlatBufferServer::initServer()
@@ -37,6 +58,21 @@ void FlatBufferServer::initServer()
 	_netOrigin = NetOrigin::getInstance();
 	connect(_server, &QTcpServer::newConnection, this, &FlatBufferServer::newConnection);
 
+	_sharedMemoryServer = new SharedMemoryServer(this);
+	connect(_sharedMemoryServer, &SharedMemoryServer::imageReceived, this, &FlatBufferServer::handleClientImage);
+
+	// encoded images are decoded on a worker thread, the clients keep reading their sockets
+	QThread* thread = new QThread(this);
+	thread->setObjectName("FlatBufferDecoderThread");
+	_imageDecoder = new FlatBufferImageDecoder();
+	_imageDecoder->moveToThread(thread);
+	connect(thread, &QThread::finished, _imageDecoder, &QObject::deleteLater);
+	connect(_imageDecoder, &FlatBufferImageDecoder::imageDecoded, this, &FlatBufferServer::handleClientImage);
+	thread->start();
+
+	// clients of hidden priorities take keep-alive images only
+	connect(GlobalSignals::getInstance(), &GlobalSignals::inputStandby, this, &FlatBufferServer::handleInputStandby);
+
 	// apply config
 	handleSettingsUpdate(settings::FLATBUFSERVER, _config);
 }
@@ -56,6 +92,14 @@ void FlatBufferServer::handleSettingsUpdate(settings::type type, const QJsonDocu
 			_port = port;
 		}
 
+		// the shared memory is named by the port, it is started and stopped with the server
+		const bool sharedMemory = obj["sharedMemory"].toBool(false);
+		if(sharedMemory != _sharedMemory)
+		{
+			stopServer();
+			_sharedMemory = sharedMemory;
+		}
+
 		// new timeout just for new connections
 		_timeout = obj["timeout"].toInt(5000);
 		// enable check
@@ -72,7 +116,7 @@ void FlatBufferServer::newConnection()
 			if(_netOrigin->accessAllowed(socket->peerAddress(), socket->localAddress()))
 			{
 				Debug(_log, "New connection from %s", QSTRING_CSTR(socket->peerAddress().toString()));
-				FlatBufferClient *client = new FlatBufferClient(socket, _timeout, this);
+				FlatBufferClient *client = new FlatBufferClient(socket, _timeout, _imageDecoder, this);
 				// internal
 				connect(client, &FlatBufferClient::clientDisconnected, this, &FlatBufferServer::clientDisconnected);
 				connect(client, &FlatBufferClient::registerGlobalInput, GlobalSignals::getInstance(), &GlobalSignals::registerGlobalInput);
@@ -95,6 +139,48 @@ void FlatBufferServer::clientDisconnected()
 	_openConnections.removeAll(client);
 }
 
+void FlatBufferServer::handleClientImage(int priority, const Image<ColorRgb>& image, int duration)
+{
+	// the priority is registered by the producer's connection, which is kept alive by the images
+	// a decoded image of a client disconnected meanwhile is dropped
+	for(const auto& client : _openConnections)
+	{
+		if(client->getPriority() == priority)
+		{
+			client->keepAlive();
+			emit GlobalSignals::getInstance()->setGlobalImage(priority, image, duration, false);
+			return;
+		}
+	}
+}
+
+void FlatBufferServer::handleInputStandby(int hyperionInd, int priority, hyperion::Components component, bool standby)
+{
+	if(component != hyperion::COMP_FLATBUFSERVER)
+		return;
+
+	_inputStandby[priority][hyperionInd] = standby;
+	updateClientStandby(priority);
+}
+
+void FlatBufferServer::updateClientStandby(int priority)
+{
+	// every instance reports a registered priority, instances without it (e.g. a disabled component) do not show it
+	bool standby = true;
+	for(bool instanceStandby : _inputStandby.value(priority))
+	{
+		standby &= instanceStandby;
+	}
+
+	for(const auto& client : _openConnections)
+	{
+		if(client->getPriority() == priority)
+		{
+			client->setStandbyInterval(standby ? STANDBY_INTERVAL_MS : 0);
+		}
+	}
+}
+
 void FlatBufferServer::startServer()
 {
 	if(!_server->isListening())
@@ -106,6 +192,10 @@ void FlatBufferServer::startServer()
 		else
 		{
 			Info(_log,"Started on port %d", _port);
+			if(_sharedMemory && _sharedMemoryServer != nullptr)
+			{
+				_sharedMemoryServer->start(_port);
+			}
 #ifdef ENABLE_AVAHI
 			if(_serviceRegister == nullptr)
 			{
@@ -133,6 +223,10 @@ void FlatBufferServer::stopServer()
 			client->forceClose();
 		}
 		_server->close();
+		if(_sharedMemoryServer != nullptr)
+		{
+			_sharedMemoryServer->stop();
+		}
 		Info(_log, "Stopped");
 	}
 }
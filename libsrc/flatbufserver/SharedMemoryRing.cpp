@@ -0,0 +1,472 @@
+#include "SharedMemoryRing.h"
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifdef FLATBUF_SHARED_MEMORY
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint32_t RING_MAGIC = 0x48595052; // "HYPR"
+const uint32_t RING_VERSION = 1;
+
+/// Slot states
+const uint32_t SLOT_FREE = 0;
+const uint32_t SLOT_WRITING = 1;
+const uint32_t SLOT_READY = 2;
+const uint32_t SLOT_READING = 3;
+
+/// The pixels start page aligned after the header
+const size_t SEGMENT_ALIGNMENT = 4096;
+
+#ifdef FLATBUF_SHARED_MEMORY
+/// The access of the segment, producers must run as the user or group of the server
+const mode_t SEGMENT_MODE = 0660;
+#endif
+
+/// The priority range of flatbuffer inputs, see FlatBufferClient
+const int PRIORITY_MIN = 100;
+const int PRIORITY_MAX = 199;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "The shared memory ring requires lock-free atomics");
+
+} // namespace
+
+SharedMemoryRing::SharedMemoryRing()
+	: _header(nullptr)
+	, _size(0)
+	, _createdName()
+{
+	std::fill(_writeSlot, _writeSlot + CHANNELS, -1);
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+	close();
+}
+
+QString SharedMemoryRing::segmentName(quint16 port)
+{
+	return QString("/hyperion-flatbuf-%1").arg(port);
+}
+
+bool SharedMemoryRing::create(const QString& name, QString& error)
+{
+	close();
+
+#ifdef FLATBUF_SHARED_MEMORY
+	const QByteArray path = name.toLocal8Bit();
+	const size_t size = segmentSize();
+
+	// a segment of a server which did not exit properly is replaced
+	shm_unlink(path.constData());
+
+	int fd = shm_open(path.constData(), O_CREAT | O_EXCL | O_RDWR, SEGMENT_MODE);
+	if (fd < 0)
+	{
+		error = QString("Failed to create shared memory %1: %2").arg(name, strerror(errno));
+		return false;
+	}
+
+	// the segment is not world-writable, producers of the group are accepted regardless of the umask
+	fchmod(fd, SEGMENT_MODE);
+
+	// the pixels are not backed by memory until a frame is written
+	if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+	{
+		error = QString("Failed to size shared memory %1: %2").arg(name, strerror(errno));
+		::close(fd);
+		shm_unlink(path.constData());
+		return false;
+	}
+
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED)
+	{
+		error = QString("Failed to map shared memory %1: %2").arg(name, strerror(errno));
+		shm_unlink(path.constData());
+		return false;
+	}
+
+	_header = new (memory) Header();
+	_header->magic = RING_MAGIC;
+	_header->version = RING_VERSION;
+	_size = size;
+	_createdName = name;
+	return true;
+#else
+	error = QString("Shared memory %1 is not supported on this platform").arg(name);
+	return false;
+#endif
+}
+
+bool SharedMemoryRing::attach(const QString& name, QString& error)
+{
+	close();
+
+#ifdef FLATBUF_SHARED_MEMORY
+	const QByteArray path = name.toLocal8Bit();
+	int fd = shm_open(path.constData(), O_RDWR, 0);
+	if (fd < 0)
+	{
+		error = QString("Failed to open shared memory %1: %2").arg(name, strerror(errno));
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(Header))
+	{
+		error = QString("Shared memory %1 has an invalid size").arg(name);
+		::close(fd);
+		return false;
+	}
+
+	const size_t size = static_cast<size_t>(status.st_size);
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED)
+	{
+		error = QString("Failed to map shared memory %1: %2").arg(name, strerror(errno));
+		return false;
+	}
+
+	Header* header = static_cast<Header*>(memory);
+	if (header->magic != RING_MAGIC || header->version != RING_VERSION || size != segmentSize())
+	{
+		error = QString("Shared memory %1 has an incompatible layout").arg(name);
+		munmap(memory, size);
+		return false;
+	}
+
+	_header = header;
+	_size = size;
+	return true;
+#else
+	error = QString("Shared memory %1 is not supported on this platform").arg(name);
+	return false;
+#endif
+}
+
+void SharedMemoryRing::close()
+{
+	if (_header == nullptr)
+	{
+		return;
+	}
+
+	for (int channel = 0; channel < CHANNELS; ++channel)
+	{
+		if (_writeSlot[channel] >= 0)
+		{
+			releaseChannel(channel);
+		}
+	}
+
+#ifdef FLATBUF_SHARED_MEMORY
+	munmap(_header, _size);
+	if (!_createdName.isEmpty())
+	{
+		shm_unlink(_createdName.toLocal8Bit().constData());
+	}
+#endif
+
+	_header = nullptr;
+	_size = 0;
+	_createdName.clear();
+}
+
+int SharedMemoryRing::claimChannel(int priority)
+{
+	if (_header == nullptr)
+	{
+		return -1;
+	}
+
+#ifdef FLATBUF_SHARED_MEMORY
+	const int32_t owner = static_cast<int32_t>(getpid());
+#else
+	const int32_t owner = 1;
+#endif
+
+	for (int channel = 0; channel < CHANNELS; ++channel)
+	{
+		Channel& ch = _header->channels[channel];
+		int32_t free = 0;
+		if (ch.owner.compare_exchange_strong(free, owner, std::memory_order_acq_rel))
+		{
+			ch.priority = priority;
+
+			// frames left by a previous producer, a slot read by the server is freed by the server
+			for (Slot& slot : ch.slots)
+			{
+				uint32_t writing = SLOT_WRITING;
+				uint32_t ready = SLOT_READY;
+				slot.state.compare_exchange_strong(writing, SLOT_FREE, std::memory_order_acq_rel);
+				slot.state.compare_exchange_strong(ready, SLOT_FREE, std::memory_order_acq_rel);
+			}
+			_writeSlot[channel] = SLOTS;
+			return channel;
+		}
+	}
+	return -1;
+}
+
+void SharedMemoryRing::releaseChannel(int channel)
+{
+	if (_header == nullptr || channel < 0 || channel >= CHANNELS)
+	{
+		return;
+	}
+
+	_writeSlot[channel] = -1;
+	_header->channels[channel].owner.store(0, std::memory_order_release);
+}
+
+ColorRgb* SharedMemoryRing::beginFrame(int channel, unsigned width, unsigned height)
+{
+	if (_header == nullptr || channel < 0 || channel >= CHANNELS || _writeSlot[channel] < 0
+		|| static_cast<size_t>(width) * height * sizeof(ColorRgb) > MAX_FRAME_BYTES)
+	{
+		return nullptr;
+	}
+
+	Channel& ch = _header->channels[channel];
+
+	// a free slot, otherwise the oldest frame not taken by the server yet is replaced
+	int target = -1;
+	for (int slot = 0; slot < SLOTS && target < 0; ++slot)
+	{
+		uint32_t expected = SLOT_FREE;
+		if (ch.slots[slot].state.compare_exchange_strong(expected, SLOT_WRITING, std::memory_order_acq_rel))
+		{
+			target = slot;
+		}
+	}
+	while (target < 0)
+	{
+		int oldest = -1;
+		for (int slot = 0; slot < SLOTS; ++slot)
+		{
+			if (ch.slots[slot].state.load(std::memory_order_acquire) == SLOT_READY
+				&& (oldest < 0 || ch.slots[slot].sequence < ch.slots[oldest].sequence))
+			{
+				oldest = slot;
+			}
+		}
+		if (oldest < 0)
+		{
+			// the server takes the ready frames right now
+			return nullptr;
+		}
+
+		uint32_t expected = SLOT_READY;
+		if (ch.slots[oldest].state.compare_exchange_strong(expected, SLOT_WRITING, std::memory_order_acq_rel))
+		{
+			_header->dropped.fetch_add(1, std::memory_order_relaxed);
+			target = oldest;
+		}
+	}
+
+	Slot& slot = ch.slots[target];
+	slot.width = width;
+	slot.height = height;
+	_writeSlot[channel] = target;
+
+	return reinterpret_cast<ColorRgb*>(slotData(channel, target));
+}
+
+void SharedMemoryRing::commitFrame(int channel, int duration)
+{
+	if (_header == nullptr || channel < 0 || channel >= CHANNELS || _writeSlot[channel] < 0 || _writeSlot[channel] >= SLOTS)
+	{
+		return;
+	}
+
+	Channel& ch = _header->channels[channel];
+	Slot& slot = ch.slots[_writeSlot[channel]];
+	slot.duration = duration;
+	slot.sequence = ++ch.sequence;
+	slot.state.store(SLOT_READY, std::memory_order_release);
+	_writeSlot[channel] = SLOTS;
+
+	_header->published.fetch_add(1, std::memory_order_release);
+	wakeServer();
+}
+
+uint32_t SharedMemoryRing::publishCount() const
+{
+	return _header != nullptr ? _header->published.load(std::memory_order_acquire) : 0;
+}
+
+void SharedMemoryRing::waitForFrames(uint32_t publishCount, int timeout_ms)
+{
+	if (_header == nullptr)
+	{
+		return;
+	}
+
+#ifdef FLATBUF_SHARED_MEMORY
+	// returns at once, if a frame was published since the count was read
+	struct timespec timeout;
+	timeout.tv_sec = timeout_ms / 1000;
+	timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_header->published), FUTEX_WAIT, publishCount, &timeout, nullptr, 0);
+#endif
+}
+
+void SharedMemoryRing::wakeUp()
+{
+	if (_header != nullptr)
+	{
+		_header->published.fetch_add(1, std::memory_order_release);
+		wakeServer();
+	}
+}
+
+void SharedMemoryRing::wakeServer()
+{
+#ifdef FLATBUF_SHARED_MEMORY
+	// the futex is shared between processes, so it must not be a private one
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_header->published), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+bool SharedMemoryRing::takeFrame(int channel, int& priority, int& duration, Image<ColorRgb>& image)
+{
+	if (_header == nullptr || channel < 0 || channel >= CHANNELS)
+	{
+		return false;
+	}
+
+	// the segment is writable by the producers, nothing read from it is trusted
+	Channel& ch = _header->channels[channel];
+	const int32_t owner = ch.owner.load(std::memory_order_acquire);
+	if (owner <= 0 || !isProcessAlive(owner))
+	{
+		return false;
+	}
+
+	for (;;)
+	{
+		int latest = -1;
+		for (int slot = 0; slot < SLOTS; ++slot)
+		{
+			if (ch.slots[slot].state.load(std::memory_order_acquire) == SLOT_READY
+				&& (latest < 0 || ch.slots[slot].sequence > ch.slots[latest].sequence))
+			{
+				latest = slot;
+			}
+		}
+		if (latest < 0)
+		{
+			return false;
+		}
+
+		uint32_t expected = SLOT_READY;
+		if (!ch.slots[latest].state.compare_exchange_strong(expected, SLOT_READING, std::memory_order_acq_rel))
+		{
+			// the producer replaced the frame meanwhile
+			continue;
+		}
+
+		// the older frames are outdated
+		for (int slot = 0; slot < SLOTS; ++slot)
+		{
+			uint32_t ready = SLOT_READY;
+			if (slot != latest && ch.slots[slot].state.compare_exchange_strong(ready, SLOT_FREE, std::memory_order_acq_rel))
+			{
+				_header->dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		// the values are read once, the producer may change them while they are checked
+		const Slot& slot = ch.slots[latest];
+		const int32_t framePriority = ch.priority;
+		const int32_t frameDuration = slot.duration;
+		const uint32_t width = slot.width;
+		const uint32_t height = slot.height;
+
+		const bool valid = width > 0 && height > 0
+			&& static_cast<uint64_t>(width) * height * sizeof(ColorRgb) <= MAX_FRAME_BYTES
+			&& framePriority >= PRIORITY_MIN && framePriority <= PRIORITY_MAX
+			&& frameDuration >= -1;
+
+		if (valid)
+		{
+			priority = framePriority;
+			duration = frameDuration;
+			image.resize(width, height);
+			memcpy(image.memptr(), slotData(channel, latest), static_cast<size_t>(width) * height * sizeof(ColorRgb));
+		}
+		else
+		{
+			_header->dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		ch.slots[latest].state.store(SLOT_FREE, std::memory_order_release);
+		return valid;
+	}
+}
+
+void SharedMemoryRing::releaseOrphanedChannels()
+{
+	if (_header == nullptr)
+	{
+		return;
+	}
+
+	for (Channel& ch : _header->channels)
+	{
+		// a negative owner is not a process id, the channel is released as well
+		const int32_t owner = ch.owner.load(std::memory_order_acquire);
+		if (owner < 0 || (owner > 0 && !isProcessAlive(owner)))
+		{
+			int32_t expected = owner;
+			ch.owner.compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+		}
+	}
+}
+
+bool SharedMemoryRing::isProcessAlive(int32_t pid)
+{
+#ifdef FLATBUF_SHARED_MEMORY
+	// a process of another user exists as well (EPERM)
+	return kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+#else
+	return pid > 0;
+#endif
+}
+
+uint64_t SharedMemoryRing::droppedFrames() const
+{
+	return _header != nullptr ? _header->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+size_t SharedMemoryRing::dataOffset()
+{
+	return (sizeof(Header) + SEGMENT_ALIGNMENT - 1) & ~(SEGMENT_ALIGNMENT - 1);
+}
+
+size_t SharedMemoryRing::segmentSize()
+{
+	return dataOffset() + CHANNELS * SLOTS * MAX_FRAME_BYTES;
+}
+
+uint8_t* SharedMemoryRing::slotData(int channel, int slot) const
+{
+	return reinterpret_cast<uint8_t*>(_header) + dataOffset() + (static_cast<size_t>(channel) * SLOTS + slot) * MAX_FRAME_BYTES;
+}
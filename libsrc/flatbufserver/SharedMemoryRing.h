@@ -0,0 +1,197 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Qt includes
+#include <QString>
+
+// util
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+#if defined(__linux__)
+	#define FLATBUF_SHARED_MEMORY
+#endif
+
+///
+/// @brief Ring of image frames in POSIX shared memory between local producers and the FlatBufferServer
+///
+/// The server creates the segment, producers on the same host attach to it and claim a channel. A channel has
+/// a few frame slots, the producer writes a frame in place into a free slot and publishes it, the server takes the
+/// latest published frame. Frames which were not taken before a newer one was published are dropped. The slot
+/// states are atomics in the segment, the server waits for published frames on a futex.
+///
+/// Only the pixels pass the shared memory, priorities are registered by the producer's TCP connection.
+///
+class SharedMemoryRing
+{
+public:
+	/// Number of producers which can send at the same time
+	static const int CHANNELS = 4;
+
+	/// Frame slots per channel: one read by the server, one ready and one written by the producer
+	static const int SLOTS = 3;
+
+	/// Size of the largest frame, larger frames are sent via TCP
+	static const size_t MAX_FRAME_BYTES = 1920 * 1080 * sizeof(ColorRgb);
+
+	SharedMemoryRing();
+	~SharedMemoryRing();
+
+	SharedMemoryRing(const SharedMemoryRing&) = delete;
+	SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+	///
+	/// @brief Get the name of the segment of a FlatBufferServer
+	/// @param port  The port of the FlatBufferServer
+	///
+	static QString segmentName(quint16 port);
+
+	///
+	/// @brief Create the segment, a segment left by a previous server is replaced
+	/// @param[in]  name   The segment name
+	/// @param[out] error  The reason, if failed
+	/// @return True, if success
+	///
+	bool create(const QString& name, QString& error);
+
+	///
+	/// @brief Attach to the segment of a server
+	/// @param[in]  name   The segment name
+	/// @param[out] error  The reason, if failed
+	/// @return True, if success
+	///
+	bool attach(const QString& name, QString& error);
+
+	///
+	/// @brief Detach from the segment, the creator removes it
+	///
+	void close();
+
+	bool isOpen() const { return _header != nullptr; }
+
+	// Producer
+
+	///
+	/// @brief Claim a free channel
+	/// @param priority  The priority the frames are shown with
+	/// @return The channel, -1 if all channels are in use
+	///
+	int claimChannel(int priority);
+
+	///
+	/// @brief Give a channel back
+	///
+	void releaseChannel(int channel);
+
+	///
+	/// @brief Start writing a frame, the pixels are written in place
+	/// @param channel  The claimed channel
+	/// @param width    The width of the frame
+	/// @param height   The height of the frame
+	/// @return The pixels of the frame, nullptr if the frame is too large
+	///
+	ColorRgb* beginFrame(int channel, unsigned width, unsigned height);
+
+	///
+	/// @brief Publish the frame written since beginFrame()
+	/// @param channel  The claimed channel
+	/// @param duration The duration in milliseconds, -1 for infinite
+	///
+	void commitFrame(int channel, int duration);
+
+	// Server
+
+	///
+	/// @return The number of frames published, used to wait for the next one
+	///
+	uint32_t publishCount() const;
+
+	///
+	/// @brief Wait until a frame is published
+	/// @param publishCount  The publish count seen last
+	/// @param timeout_ms    The maximum time to wait
+	///
+	void waitForFrames(uint32_t publishCount, int timeout_ms);
+
+	///
+	/// @brief Wake up waitForFrames()
+	///
+	void wakeUp();
+
+	///
+	/// @brief Take the latest published frame of a channel, older ones are dropped
+	/// @param[in]  channel   The channel
+	/// @param[out] priority  The priority of the channel
+	/// @param[out] duration  The duration of the frame
+	/// @param[out] image     The frame
+	/// @return True, if a valid frame was published. Frames with an invalid size, priority or duration are dropped
+	///
+	bool takeFrame(int channel, int& priority, int& duration, Image<ColorRgb>& image);
+
+	///
+	/// @brief Release the channels of producers which exited without giving them back
+	///
+	void releaseOrphanedChannels();
+
+	///
+	/// @return The number of frames dropped, as a newer one was published before the server took them
+	///
+	uint64_t droppedFrames() const;
+
+private:
+	struct Slot
+	{
+		std::atomic<uint32_t> state;
+		uint32_t width;
+		uint32_t height;
+		int32_t duration;
+		uint64_t sequence;
+	};
+
+	struct Channel
+	{
+		/// The process id of the producer, 0 if free
+		std::atomic<int32_t> owner;
+		int32_t priority;
+		uint64_t sequence;
+		Slot slots[SLOTS];
+	};
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		/// Incremented with every published frame, the futex the server waits on
+		std::atomic<uint32_t> published;
+		uint32_t reserved;
+		std::atomic<uint64_t> dropped;
+		Channel channels[CHANNELS];
+	};
+
+	/// @return The size of the segment, the pixels start page aligned after the header
+	static size_t segmentSize();
+	static size_t dataOffset();
+
+	/// @return True, if the process of a producer exists
+	static bool isProcessAlive(int32_t pid);
+
+	/// @return The pixels of a slot
+	uint8_t* slotData(int channel, int slot) const;
+
+	/// Wake up a server waiting for frames
+	void wakeServer();
+
+	/// The mapped segment
+	Header* _header;
+	size_t _size;
+
+	/// The name of the segment, if created by this instance
+	QString _createdName;
+
+	/// The slot written by this producer per channel
+	int _writeSlot[CHANNELS];
+};
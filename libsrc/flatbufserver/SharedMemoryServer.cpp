@@ -0,0 +1,142 @@
+#include "SharedMemoryServer.h"
+
+// qt
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+/// The waiter thread checks for a stop request at least this often
+const int WAIT_TIMEOUT_MS = 500;
+
+/// Interval of the check for channels of exited producers
+const int ORPHAN_CHECK_INTERVAL_MS = 2000;
+
+} // namespace
+
+///
+/// Waits on the futex of the ring for published frames
+///
+class SharedMemoryServer::Waiter : public QThread
+{
+public:
+	explicit Waiter(SharedMemoryServer* server)
+		: _server(server)
+		, _stopped(false)
+	{
+		setObjectName("SharedMemoryWaiter");
+	}
+
+	void stop()
+	{
+		_stopped = true;
+		_server->_ring.wakeUp();
+		wait();
+	}
+
+protected:
+	void run() override
+	{
+		uint32_t seen = _server->_ring.publishCount();
+		while (!_stopped)
+		{
+			_server->_ring.waitForFrames(seen, WAIT_TIMEOUT_MS);
+
+			const uint32_t published = _server->_ring.publishCount();
+			if (published != seen && !_stopped)
+			{
+				seen = published;
+				_server->notifyFrames();
+			}
+		}
+	}
+
+private:
+	SharedMemoryServer* _server;
+	std::atomic<bool> _stopped;
+};
+
+SharedMemoryServer::SharedMemoryServer(QObject* parent)
+	: QObject(parent)
+	, _log(Logger::getInstance("FLATBUFSERVER"))
+	, _ring()
+	, _waiter(nullptr)
+	, _orphanTimer(new QTimer(this))
+	, _processPending(false)
+{
+	_orphanTimer->setInterval(ORPHAN_CHECK_INTERVAL_MS);
+	connect(_orphanTimer, &QTimer::timeout, this, &SharedMemoryServer::releaseOrphanedChannels);
+}
+
+SharedMemoryServer::~SharedMemoryServer()
+{
+	stop();
+}
+
+bool SharedMemoryServer::start(quint16 port)
+{
+	stop();
+
+	const QString name = SharedMemoryRing::segmentName(port);
+	QString error;
+	if (!_ring.create(name, error))
+	{
+		Error(_log, "Shared memory input not available: %s", QSTRING_CSTR(error));
+		return false;
+	}
+
+	_waiter = new Waiter(this);
+	_waiter->start();
+	_orphanTimer->start();
+
+	Info(_log, "Shared memory input started (%s)", QSTRING_CSTR(name));
+	return true;
+}
+
+void SharedMemoryServer::stop()
+{
+	if (_waiter != nullptr)
+	{
+		_waiter->stop();
+		delete _waiter;
+		_waiter = nullptr;
+	}
+
+	_orphanTimer->stop();
+
+	if (_ring.isOpen())
+	{
+		_ring.close();
+		Info(_log, "Shared memory input stopped");
+	}
+}
+
+void SharedMemoryServer::notifyFrames()
+{
+	// a pending call takes the frames published meanwhile as well
+	if (!_processPending.exchange(true))
+	{
+		QMetaObject::invokeMethod(this, "processFrames", Qt::QueuedConnection);
+	}
+}
+
+void SharedMemoryServer::processFrames()
+{
+	_processPending = false;
+
+	int priority;
+	int duration;
+	for (int channel = 0; channel < SharedMemoryRing::CHANNELS; ++channel)
+	{
+		Image<ColorRgb> image;
+		if (_ring.takeFrame(channel, priority, duration, image))
+		{
+			emit imageReceived(priority, image, duration);
+		}
+	}
+}
+
+void SharedMemoryServer::releaseOrphanedChannels()
+{
+	_ring.releaseOrphanedChannels();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+
+// util
+#include <utils/Logger.h>
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+#include "SharedMemoryRing.h"
+
+class QTimer;
+
+///
+/// @brief Receives the images of producers on the same host via the SharedMemoryRing of the FlatBufferServer
+///
+/// A thread waits for published frames and notifies the server's thread, which takes the latest frame of every
+/// channel. The images bypass the socket, the flatbuffer serialisation and the receive buffer of the TCP clients.
+///
+class SharedMemoryServer : public QObject
+{
+	Q_OBJECT
+public:
+	explicit SharedMemoryServer(QObject* parent = nullptr);
+	~SharedMemoryServer() override;
+
+	///
+	/// @brief Create the shared memory of a FlatBufferServer and start waiting for frames
+	/// @param port  The port of the FlatBufferServer, producers find the shared memory by it
+	/// @return True, if success
+	///
+	bool start(quint16 port);
+
+	///
+	/// @brief Stop waiting for frames and remove the shared memory
+	///
+	void stop();
+
+	///
+	/// @return True, if started
+	///
+	bool isActive() const { return _ring.isOpen(); }
+
+signals:
+	///
+	/// @brief Emits with the latest frame of a producer
+	/// @param priority  The priority of the producer
+	/// @param image     The frame
+	/// @param duration  The duration in milliseconds
+	///
+	void imageReceived(int priority, const Image<ColorRgb>& image, int duration);
+
+private slots:
+	///
+	/// @brief Take the latest frames of all channels
+	///
+	void processFrames();
+
+	///
+	/// @brief Release the channels of producers which exited
+	///
+	void releaseOrphanedChannels();
+
+private:
+	class Waiter;
+
+	///
+	/// @brief Request processFrames() on the server's thread, called by the waiter thread
+	///
+	void notifyFrames();
+
+	Logger* _log;
+	SharedMemoryRing _ring;
+	Waiter* _waiter;
+	QTimer* _orphanTimer;
+
+	/// Is a call of processFrames() pending?
+	std::atomic<bool> _processPending;
+};
@@ -0,0 +1,344 @@
+#include "MjpegDecoder.h"
+
+// stl includes
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+// Qt includes
+#include <QThread>
+#include <QMutexLocker>
+#include <QMetaType>
+
+// System JPEG decoder
+#ifdef HAVE_JPEG
+	#include <jpeglib.h>
+	#include <csetjmp>
+#endif
+
+// TurboJPEG decoder
+#ifdef HAVE_TURBO_JPEG
+	#include <turbojpeg.h>
+#endif
+
+namespace {
+
+/// The DCT scaling supported by both JPEG libraries, the largest one not exceeding the pixel decimation is used
+int scaleDenominator(int pixelDecimation)
+{
+	for (int denom : {8, 4, 2})
+	{
+		if (pixelDecimation >= denom)
+			return denom;
+	}
+	return 1;
+}
+
+} // namespace
+
+class MjpegDecoder::Worker : public QThread
+{
+public:
+	explicit Worker(MjpegDecoder* decoder);
+	~Worker() override;
+
+protected:
+	void run() override;
+
+private:
+	///
+	/// @brief Decompress a frame into the RGB buffer
+	/// @param      job           The frame
+	/// @param      scaleDenom    The DCT scaling denominator
+	/// @param[out] sourceWidth   The width of the frame
+	/// @param[out] sourceHeight  The height of the frame
+	/// @param[out] width         The width of the decompressed (scaled) frame
+	/// @param[out] height        The height of the decompressed (scaled) frame
+	/// @return True on success
+	///
+	bool decompress(const Job& job, int scaleDenom, int& sourceWidth, int& sourceHeight, int& width, int& height);
+
+	///
+	/// @brief Decode, crop and decimate a frame
+	///
+	bool decodeFrame(const Job& job, Image<ColorRgb>& image);
+
+	MjpegDecoder* _decoder;
+
+	/// The decompressed frame, reused between frames
+	std::vector<uint8_t> _rgb;
+
+	/// Byte offsets of the output columns into a decompressed row
+	std::vector<int> _xOffsets;
+
+#ifdef HAVE_JPEG
+	struct errorManager
+	{
+		jpeg_error_mgr pub;
+		jmp_buf setjmp_buffer;
+	};
+
+	static void errorHandler(j_common_ptr cInfo)
+	{
+		errorManager* mgr = reinterpret_cast<errorManager*>(cInfo->err);
+		longjmp(mgr->setjmp_buffer, 1);
+	}
+
+	static void outputHandler(j_common_ptr cInfo)
+	{
+		// Suppress fprintf warnings.
+	}
+
+	jpeg_decompress_struct _decompress;
+	errorManager _error;
+#endif
+
+#ifdef HAVE_TURBO_JPEG
+	tjhandle _decompress;
+#endif
+};
+
+MjpegDecoder::Worker::Worker(MjpegDecoder* decoder)
+	: QThread()
+	, _decoder(decoder)
+	, _rgb()
+	, _xOffsets()
+{
+#ifdef HAVE_JPEG
+	_decompress.err = jpeg_std_error(&_error.pub);
+	_error.pub.error_exit = &errorHandler;
+	_error.pub.output_message = &outputHandler;
+	jpeg_create_decompress(&_decompress);
+#endif
+
+#ifdef HAVE_TURBO_JPEG
+	_decompress = tjInitDecompress();
+#endif
+}
+
+MjpegDecoder::Worker::~Worker()
+{
+#ifdef HAVE_JPEG
+	jpeg_destroy_decompress(&_decompress);
+#endif
+
+#ifdef HAVE_TURBO_JPEG
+	if (_decompress != nullptr)
+		tjDestroy(_decompress);
+#endif
+}
+
+void MjpegDecoder::Worker::run()
+{
+	Job job;
+	while (_decoder->takeJob(job))
+	{
+		Image<ColorRgb> image;
+		if (decodeFrame(job, image))
+		{
+			emit _decoder->frameDecoded(job.sequence, image);
+		}
+		_decoder->recycle(job.data);
+	}
+}
+
+bool MjpegDecoder::Worker::decompress(const Job& job, int scaleDenom, int& sourceWidth, int& sourceHeight, int& width, int& height)
+{
+#ifdef HAVE_JPEG
+	if (setjmp(_error.setjmp_buffer))
+	{
+		jpeg_abort_decompress(&_decompress);
+		return false;
+	}
+
+	_error.pub.num_warnings = 0;
+	jpeg_mem_src(&_decompress, const_cast<uint8_t*>(job.data.data()), job.data.size());
+
+	if (jpeg_read_header(&_decompress, TRUE) != JPEG_HEADER_OK)
+	{
+		jpeg_abort_decompress(&_decompress);
+		return false;
+	}
+
+	_decompress.scale_num = 1;
+	_decompress.scale_denom = scaleDenom;
+	_decompress.out_color_space = JCS_RGB;
+	_decompress.dct_method = JDCT_IFAST;
+
+	if (!jpeg_start_decompress(&_decompress) || _decompress.out_color_components != 3)
+	{
+		jpeg_abort_decompress(&_decompress);
+		return false;
+	}
+
+	sourceWidth = _decompress.image_width;
+	sourceHeight = _decompress.image_height;
+	width = _decompress.output_width;
+	height = _decompress.output_height;
+	_rgb.resize(static_cast<size_t>(width) * height * 3);
+
+	while (_decompress.output_scanline < _decompress.output_height)
+	{
+		JSAMPROW row = &_rgb[static_cast<size_t>(_decompress.output_scanline) * width * 3];
+		jpeg_read_scanlines(&_decompress, &row, 1);
+	}
+
+	jpeg_finish_decompress(&_decompress);
+	return _error.pub.num_warnings == 0;
+#endif
+
+#ifdef HAVE_TURBO_JPEG
+	if (_decompress == nullptr)
+		return false;
+
+	int subsamp;
+	if (tjDecompressHeader2(_decompress, const_cast<uint8_t*>(job.data.data()), job.data.size(), &sourceWidth, &sourceHeight, &subsamp) != 0)
+		return false;
+
+	width = sourceWidth;
+	height = sourceHeight;
+
+	int factorCount = 0;
+	tjscalingfactor* factors = tjGetScalingFactors(&factorCount);
+	for (int i = 0; factors != nullptr && i < factorCount; ++i)
+	{
+		if (factors[i].num == 1 && factors[i].denom == scaleDenom)
+		{
+			width = TJSCALED(sourceWidth, factors[i]);
+			height = TJSCALED(sourceHeight, factors[i]);
+			break;
+		}
+	}
+
+	_rgb.resize(static_cast<size_t>(width) * height * 3);
+	return tjDecompress2(_decompress, const_cast<uint8_t*>(job.data.data()), job.data.size(), _rgb.data(), width, 0, height, TJPF_RGB, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) == 0;
+#endif
+}
+
+bool MjpegDecoder::Worker::decodeFrame(const Job& job, Image<ColorRgb>& image)
+{
+	const Settings& settings = job.settings;
+	const int decimation = std::max(settings.pixelDecimation, 1);
+
+	int sourceWidth = 0, sourceHeight = 0, width = 0, height = 0;
+	if (!decompress(job, scaleDenominator(decimation), sourceWidth, sourceHeight, width, height) || width <= 0 || height <= 0)
+		return false;
+
+	// crop and decimation refer to the full resolution frame
+	const int outputWidth = (sourceWidth - settings.cropLeft - settings.cropRight) / decimation;
+	const int outputHeight = (sourceHeight - settings.cropTop - settings.cropBottom) / decimation;
+	if (outputWidth <= 0 || outputHeight <= 0)
+		return false;
+
+	_xOffsets.resize(outputWidth);
+	for (int x = 0; x < outputWidth; ++x)
+	{
+		_xOffsets[x] = std::min((settings.cropLeft + x * decimation) * width / sourceWidth, width - 1) * 3;
+	}
+
+	image.resize(outputWidth, outputHeight);
+	ColorRgb* dest = image.memptr();
+	for (int y = 0; y < outputHeight; ++y)
+	{
+		const int ySource = std::min((settings.cropTop + y * decimation) * height / sourceHeight, height - 1);
+		const uint8_t* row = &_rgb[static_cast<size_t>(ySource) * width * 3];
+		for (int x = 0; x < outputWidth; ++x)
+		{
+			const uint8_t* pixel = row + _xOffsets[x];
+			*dest++ = ColorRgb{pixel[0], pixel[1], pixel[2]};
+		}
+	}
+
+	return true;
+}
+
+MjpegDecoder::MjpegDecoder(int workerCount, Logger* log, QObject* parent)
+	: QObject(parent)
+	, _log(log)
+	, _jobs()
+	, _freeBuffers()
+	, _stopped(false)
+	, _sequence(0)
+	, _droppedFrames(0)
+	, _workers()
+{
+	// frames are delivered queued to the grabber thread
+	qRegisterMetaType<Image<ColorRgb>>("Image<ColorRgb>");
+
+	for (int i = 0; i < std::max(workerCount, 1); ++i)
+	{
+		Worker* worker = new Worker(this);
+		_workers.push_back(worker);
+		worker->start();
+	}
+	Debug(_log, "MJPEG decoder started with %d threads", int(_workers.size()));
+}
+
+MjpegDecoder::~MjpegDecoder()
+{
+	{
+		QMutexLocker locker(&_mutex);
+		_stopped = true;
+		_jobAvailable.wakeAll();
+	}
+
+	for (Worker* worker : _workers)
+	{
+		worker->wait();
+		delete worker;
+	}
+
+	if (_droppedFrames > 0)
+		Debug(_log, "MJPEG decoder stopped, %llu frames dropped", static_cast<unsigned long long>(_droppedFrames));
+}
+
+quint64 MjpegDecoder::decode(const uint8_t* data, int size, const Settings& settings)
+{
+	QMutexLocker locker(&_mutex);
+
+	Job job;
+	job.sequence = ++_sequence;
+	job.settings = settings;
+	if (!_freeBuffers.empty())
+	{
+		job.data = std::move(_freeBuffers.back());
+		_freeBuffers.pop_back();
+	}
+	job.data.assign(data, data + size);
+
+	// all workers are busy, the oldest frame is outdated anyway
+	if (_jobs.size() >= _workers.size())
+	{
+		_freeBuffers.push_back(std::move(_jobs.front().data));
+		_jobs.pop_front();
+		if (_droppedFrames++ % 100 == 0)
+			Debug(_log, "MJPEG decoder is too slow, %llu frames dropped", static_cast<unsigned long long>(_droppedFrames));
+	}
+
+	_jobs.push_back(std::move(job));
+	_jobAvailable.wakeOne();
+	return _sequence;
+}
+
+bool MjpegDecoder::takeJob(Job& job)
+{
+	QMutexLocker locker(&_mutex);
+	while (!_stopped && _jobs.empty())
+	{
+		_jobAvailable.wait(&_mutex);
+	}
+
+	if (_stopped)
+		return false;
+
+	job = std::move(_jobs.front());
+	_jobs.pop_front();
+	return true;
+}
+
+void MjpegDecoder::recycle(std::vector<uint8_t>& data)
+{
+	QMutexLocker locker(&_mutex);
+	if (_freeBuffers.size() < _workers.size() * 2)
+		_freeBuffers.push_back(std::move(data));
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+// stl includes
+#include <deque>
+#include <vector>
+
+// Qt includes
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+
+// util includes
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+#include <utils/Logger.h>
+
+///
+/// Decodes MJPEG frames on a pool of worker threads.
+///
+/// Frames are queued together with the crop and decimation of the grabber. A worker decodes a frame with the
+/// DCT scaling of the JPEG library (1/2, 1/4, 1/8) closest to the pixel decimation, so the decoded frame is
+/// already near the output resolution, and samples the cropped output image from it.
+/// The queue holds one frame per worker, if it is full the oldest queued frame is dropped in favour of the new one.
+///
+class MjpegDecoder : public QObject
+{
+	Q_OBJECT
+
+public:
+	/// Crop and decimation of a frame, taken from the grabber when the frame is queued
+	struct Settings
+	{
+		int cropLeft;
+		int cropRight;
+		int cropTop;
+		int cropBottom;
+		int pixelDecimation;
+	};
+
+	///
+	/// @param workerCount  The number of decoder threads
+	/// @param log          The logger of the grabber
+	///
+	MjpegDecoder(int workerCount, Logger* log, QObject* parent = nullptr);
+	~MjpegDecoder() override;
+
+	///
+	/// @brief Queue a compressed frame for decoding, the data is copied
+	/// @param data      The MJPEG frame
+	/// @param size      The size of the frame in bytes
+	/// @param settings  The crop and decimation of the frame
+	/// @return The sequence number of the frame
+	///
+	quint64 decode(const uint8_t* data, int size, const Settings& settings);
+
+signals:
+	///
+	/// @brief Emitted from a worker thread, frames might be finished out of order
+	/// @param sequence  The sequence number given by decode()
+	/// @param image     The decoded, cropped and decimated frame
+	///
+	void frameDecoded(quint64 sequence, const Image<ColorRgb>& image);
+
+private:
+	class Worker;
+
+	struct Job
+	{
+		quint64 sequence;
+		std::vector<uint8_t> data;
+		Settings settings;
+	};
+
+	///
+	/// @brief Wait for a queued frame
+	/// @param[out] job  The frame to decode
+	/// @return False if the decoder is stopped
+	///
+	bool takeJob(Job& job);
+
+	///
+	/// @brief Give the buffer of a decoded frame back for the next frames
+	///
+	void recycle(std::vector<uint8_t>& data);
+
+	Logger* _log;
+
+	QMutex _mutex;
+	QWaitCondition _jobAvailable;
+	std::deque<Job> _jobs;
+	std::vector<std::vector<uint8_t>> _freeBuffers;
+	bool _stopped;
+
+	quint64 _sequence;
+	quint64 _droppedFrames;
+
+	std::vector<Worker*> _workers;
+};
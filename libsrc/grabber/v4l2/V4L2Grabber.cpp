@@ -21,9 +21,14 @@
 
 #include <QDirIterator>
 #include <QFileInfo>
+#include <QThread>
 
 #include "grabber/V4L2Grabber.h"
 
+#ifdef HAVE_JPEG_DECODER
+	#include "MjpegDecoder.h"
+#endif
+
 #define CLEAR(x) memset(&(x), 0, sizeof(x))
 
 #ifndef V4L2_CAP_META_CAPTURE
@@ -61,6 +66,10 @@ V4L2Grabber::V4L2Grabber(const QString & device
 	, _x_frac_max(0.75)
 	, _y_frac_max(0.75)
 	, _streamNotifier(nullptr)
+	, _directMappings()
+	, _imageRequired(true)
+	, _standbyInterval_ms(0)
+	, _standbyTimer()
 	, _initialized(false)
 	, _deviceAutoDiscoverEnabled(false)
 {
@@ -322,6 +331,11 @@ void V4L2Grabber::stop()
 	{
 		stop_capturing();
 		_streamNotifier->setEnabled(false);
+#ifdef HAVE_JPEG_DECODER
+		// joins the decoder threads, frames still queued for this grabber are ignored
+		delete _mjpegDecoder;
+		_mjpegDecoder = nullptr;
+#endif
 		uninit_device();
 		close_device();
 		_initialized = false;
@@ -1036,7 +1050,25 @@ void V4L2Grabber::process_image(const uint8_t * data, int size)
 	if (_cecDetectionEnabled && _cecStandbyActivated)
 		return;
 
-	Image<ColorRgb> image(_width, _height);
+	// the capture is hidden by a higher priority, a keep-alive frame is processed once per interval
+	if (_standbyInterval_ms > 0)
+	{
+		if (_standbyTimer.isValid() && _standbyTimer.elapsed() < _standbyInterval_ms)
+			return;
+
+		_standbyTimer.start();
+	}
+
+	// direct mapping without an image, if no listener requires it
+#ifdef HAVE_JPEG_DECODER
+	if (!_imageRequired && !_signalDetectionEnabled && _pixelFormat != PixelFormat::MJPEG)
+#else
+	if (!_imageRequired && !_signalDetectionEnabled)
+#endif
+	{
+		forwardLedColors(data);
+		return;
+	}
 
 /* ----------------------------------------------------------
  * ----------- BEGIN of JPEG decoder related code -----------
@@ -1045,128 +1077,60 @@ void V4L2Grabber::process_image(const uint8_t * data, int size)
 #ifdef HAVE_JPEG_DECODER
 	if (_pixelFormat == PixelFormat::MJPEG)
 	{
-#endif
-#ifdef HAVE_JPEG
-		_decompress = new jpeg_decompress_struct;
-		_error = new errorManager;
-
-		_decompress->err = jpeg_std_error(&_error->pub);
-		_error->pub.error_exit = &errorHandler;
-		_error->pub.output_message = &outputHandler;
-
-		jpeg_create_decompress(_decompress);
-
-		if (setjmp(_error->setjmp_buffer))
-		{
-			jpeg_abort_decompress(_decompress);
-			jpeg_destroy_decompress(_decompress);
-			delete _decompress;
-			delete _error;
-			return;
-		}
-
-		jpeg_mem_src(_decompress, const_cast<uint8_t*>(data), size);
-
-		if (jpeg_read_header(_decompress, (bool) TRUE) != JPEG_HEADER_OK)
-		{
-			jpeg_abort_decompress(_decompress);
-			jpeg_destroy_decompress(_decompress);
-			delete _decompress;
-			delete _error;
-			return;
-		}
-
-		_decompress->scale_num = 1;
-		_decompress->scale_denom = 1;
-		_decompress->out_color_space = JCS_RGB;
-		_decompress->dct_method = JDCT_IFAST;
-
-		if (!jpeg_start_decompress(_decompress))
+		if (_mjpegDecoder == nullptr)
 		{
-			jpeg_abort_decompress(_decompress);
-			jpeg_destroy_decompress(_decompress);
-			delete _decompress;
-			delete _error;
-			return;
-		}
-
-		if (_decompress->out_color_components != 3)
-		{
-			jpeg_abort_decompress(_decompress);
-			jpeg_destroy_decompress(_decompress);
-			delete _decompress;
-			delete _error;
-			return;
+			// the grabber thread keeps reading frames, decoding uses the remaining cores
+			_mjpegDecoder = new MjpegDecoder(qBound(1, QThread::idealThreadCount() - 1, 4), _log, this);
+			_mjpegSequence = 0;
+			connect(_mjpegDecoder, &MjpegDecoder::frameDecoded, this, &V4L2Grabber::handleDecodedFrame, Qt::QueuedConnection);
 		}
 
-		QImage imageFrame = QImage(_decompress->output_width, _decompress->output_height, QImage::Format_RGB888);
-
-		int y = 0;
-		while (_decompress->output_scanline < _decompress->output_height)
-		{
-			uchar *row = imageFrame.scanLine(_decompress->output_scanline);
-			jpeg_read_scanlines(_decompress, &row, 1);
-			y++;
-		}
-
-		jpeg_finish_decompress(_decompress);
-		jpeg_destroy_decompress(_decompress);
-		delete _decompress;
-		delete _error;
-
-		if (imageFrame.isNull() || _error->pub.num_warnings > 0)
-			return;
+		MjpegDecoder::Settings settings;
+		settings.cropLeft = _cropLeft;
+		settings.cropRight = _cropRight;
+		settings.cropTop = _cropTop;
+		settings.cropBottom = _cropBottom;
+		settings.pixelDecimation = _pixelDecimation;
+		_mjpegDecoder->decode(data, size, settings);
+		return;
+	}
 #endif
-#ifdef HAVE_TURBO_JPEG
-		_decompress = tjInitDecompress();
-		if (_decompress == nullptr)
-			return;
 
-		if (tjDecompressHeader2(_decompress, const_cast<uint8_t*>(data), size, &_width, &_height, &_subsamp) != 0)
-		{
-			tjDestroy(_decompress);
-			return;
-		}
+/* ----------------------------------------------------------
+ * ------------ END of JPEG decoder related code ------------
+ * --------------------------------------------------------*/
 
-		QImage imageFrame = QImage(_width, _height, QImage::Format_RGB888);
-		if (tjDecompress2(_decompress, const_cast<uint8_t*>(data), size, imageFrame.bits(), _width, 0, _height, TJPF_RGB, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0)
-		{
-			tjDestroy(_decompress);
-			return;
-		}
+	// allocated in the final size, the pixel buffer is recycled by the image pool in steady state
+	int outputWidth;
+	int outputHeight;
+	_imageResampler.getOutputSize(_width, _height, outputWidth, outputHeight);
+	Image<ColorRgb> image(std::max(outputWidth, 1), std::max(outputHeight, 1));
+	_imageResampler.processImage(data, _width, _height, _lineLength, _pixelFormat, image);
 
-		tjDestroy(_decompress);
+	processFrame(image);
+}
 
-		if (imageFrame.isNull())
-			return;
-#endif
+void V4L2Grabber::handleDecodedFrame(quint64 sequence, const Image<ColorRgb> & image)
+{
 #ifdef HAVE_JPEG_DECODER
-		QRect rect(_cropLeft, _cropTop, imageFrame.width() - _cropLeft - _cropRight, imageFrame.height() - _cropTop - _cropBottom);
-		imageFrame = imageFrame.copy(rect);
-		imageFrame = imageFrame.scaled(imageFrame.width() / _pixelDecimation, imageFrame.height() / _pixelDecimation,Qt::KeepAspectRatio);
+	// frames of several decoder threads might arrive out of order
+	if (sequence <= _mjpegSequence || _mjpegDecoder == nullptr)
+		return;
 
-		if ((image.width() != unsigned(imageFrame.width())) || (image.height() != unsigned(imageFrame.height())))
-			image.resize(imageFrame.width(), imageFrame.height());
+	_mjpegSequence = sequence;
 
-		for (int y=0; y<imageFrame.height(); ++y)
-			for (int x=0; x<imageFrame.width(); ++x)
-			{
-				QColor inPixel(imageFrame.pixel(x,y));
-				ColorRgb & outPixel = image(x,y);
-				outPixel.red   = inPixel.red();
-				outPixel.green = inPixel.green();
-				outPixel.blue  = inPixel.blue();
-			}
-	}
-	else
-#endif
-
-/* ----------------------------------------------------------
- * ------------ END of JPEG decoder related code ------------
- * --------------------------------------------------------*/
+	if (_cecDetectionEnabled && _cecStandbyActivated)
+		return;
 
-	_imageResampler.processImage(data, _width, _height, _lineLength, _pixelFormat, image);
+	processFrame(image);
+#else
+	Q_UNUSED(sequence);
+	Q_UNUSED(image);
+#endif
+}
 
+void V4L2Grabber::processFrame(const Image<ColorRgb> & image)
+{
 	if (_signalDetectionEnabled)
 	{
 		// check signal (only in center of the resulting image, because some grabbers have noise values along the borders)
@@ -1206,7 +1170,7 @@ void V4L2Grabber::process_image(const uint8_t * data, int size)
 
 		if ( _noSignalCounter < _noSignalCounterThreshold)
 		{
-			emit newFrame(image);
+			forwardFrame(image);
 		}
 		else if (_noSignalCounter == _noSignalCounterThreshold)
 		{
@@ -1215,11 +1179,97 @@ void V4L2Grabber::process_image(const uint8_t * data, int size)
 		}
 	}
 	else
+	{
+		forwardFrame(image);
+	}
+}
+
+void V4L2Grabber::forwardFrame(const Image<ColorRgb> & image)
+{
+	for (auto& mapping : _directMappings)
+	{
+		DirectMapping& directMapping = mapping.second;
+		const hyperion::ImageToLedsMap& map = directMapping.getMap(image.width(), image.height());
+
+		switch (directMapping.mappingType)
+		{
+			case 1: map.getUniLedColor(image, directMapping.ledColors); break;
+			default: map.getMeanLedColor(image, directMapping.ledColors);
+		}
+		emit newLedColors(mapping.first, directMapping.ledColors);
+	}
+
+	if (_imageRequired)
 	{
 		emit newFrame(image);
 	}
 }
 
+void V4L2Grabber::forwardLedColors(const uint8_t * data)
+{
+	int outputWidth;
+	int outputHeight;
+	_imageResampler.getOutputSize(_width, _height, outputWidth, outputHeight);
+
+	if (outputWidth <= 0 || outputHeight <= 0)
+	{
+		return;
+	}
+
+	for (auto& mapping : _directMappings)
+	{
+		DirectMapping& directMapping = mapping.second;
+		const hyperion::ImageToLedsMap& map = directMapping.getMap(outputWidth, outputHeight);
+
+		switch (directMapping.mappingType)
+		{
+			case 1: map.getUniLedColor(_imageResampler, data, _lineLength, _pixelFormat, directMapping.ledColors); break;
+			default: map.getMeanLedColor(_imageResampler, data, _lineLength, _pixelFormat, directMapping.ledColors);
+		}
+		emit newLedColors(mapping.first, directMapping.ledColors);
+	}
+}
+
+const hyperion::ImageToLedsMap& V4L2Grabber::DirectMapping::getMap(unsigned width, unsigned height)
+{
+	if (map == nullptr || map->width() != width || map->height() != height)
+	{
+		// the mapping is kept until the output size or the led layout changes, the areas are reduced from a summed area table
+		map.reset(new hyperion::ImageToLedsMap(width, height, 0, 0, leds, hyperion::SUMMED_AREA));
+	}
+	return *map;
+}
+
+void V4L2Grabber::setDirectMapping(int hyperionInd, const std::vector<Led>& leds, int mappingType)
+{
+	if (leds.empty())
+	{
+		if (_directMappings.erase(hyperionInd) > 0)
+		{
+			Debug(_log, "Instance %d receives images", hyperionInd);
+		}
+		return;
+	}
+
+	DirectMapping& directMapping = _directMappings[hyperionInd];
+	directMapping.leds = leds;
+	directMapping.mappingType = mappingType;
+	directMapping.map.reset();
+	directMapping.ledColors.assign(leds.size(), ColorRgb::BLACK);
+	Debug(_log, "Instance %d receives direct mapped led colors", hyperionInd);
+}
+
+void V4L2Grabber::setImageRequired(bool required)
+{
+	_imageRequired = required;
+}
+
+void V4L2Grabber::setStandbyInterval(int interval_ms)
+{
+	_standbyInterval_ms = interval_ms;
+	_standbyTimer.invalidate();
+}
+
 int V4L2Grabber::xioctl(int request, void *arg)
 {
 	int r;
@@ -5,6 +5,8 @@
 // qt
 #include <QTimer>
 
+#include <utils/GlobalSignals.h>
+
 V4L2Wrapper::V4L2Wrapper(const QString &device,
 		unsigned grabWidth,
 		unsigned grabHeight,
@@ -30,7 +32,13 @@ V4L2Wrapper::V4L2Wrapper(const QString &device,
 
 	// Handle the image in the captured thread using a direct connection
 	connect(&_grabber, &V4L2Grabber::newFrame, this, &V4L2Wrapper::newFrame, Qt::DirectConnection);
+	connect(&_grabber, &V4L2Grabber::newLedColors, this, &V4L2Wrapper::newLedColors, Qt::DirectConnection);
 	connect(&_grabber, &V4L2Grabber::readError, this, &V4L2Wrapper::readError, Qt::DirectConnection);
+
+	// instances which listen to the v4l capture and those which want direct mapped led colors
+	connect(GlobalSignals::getInstance(), &GlobalSignals::requestSource, this, &V4L2Wrapper::handleV4lSourceRequest);
+	connect(GlobalSignals::getInstance(), &GlobalSignals::requestV4lDirectMapping, this, &V4L2Wrapper::handleDirectMappingRequest);
+	emit GlobalSignals::getInstance()->v4lDirectMappingReset();
 }
 
 V4L2Wrapper::~V4L2Wrapper()
@@ -69,6 +77,63 @@ void V4L2Wrapper::newFrame(const Image<ColorRgb> &image)
 	emit systemImage(_grabberName, image);
 }
 
+void V4L2Wrapper::newLedColors(int hyperionInd, const std::vector<ColorRgb>& ledColors)
+{
+	emit GlobalSignals::getInstance()->setV4lLedColors(_grabberName, hyperionInd, ledColors);
+}
+
+void V4L2Wrapper::handleV4lSourceRequest(hyperion::Components component, int hyperionInd, bool listen)
+{
+	if (component != hyperion::Components::COMP_V4L)
+		return;
+
+	if (listen)
+	{
+		_listeners.insert(hyperionInd);
+	}
+	else
+	{
+		_listeners.remove(hyperionInd);
+		if (_directMapped.remove(hyperionInd))
+		{
+			_grabber.setDirectMapping(hyperionInd, std::vector<Led>(), 0);
+		}
+	}
+	updateImageRequired();
+}
+
+void V4L2Wrapper::handleDirectMappingRequest(int hyperionInd, const std::vector<Led>& leds, int mappingType)
+{
+	if (leds.empty())
+		_directMapped.remove(hyperionInd);
+	else
+		_directMapped.insert(hyperionInd);
+
+	_grabber.setDirectMapping(hyperionInd, leds, mappingType);
+	updateImageRequired();
+}
+
+void V4L2Wrapper::updateImageRequired()
+{
+	// listeners which registered before this capture has been created are unknown, they still get images
+	bool required = _directMapped.isEmpty();
+	for (int ind : _listeners)
+	{
+		if (!_directMapped.contains(ind))
+		{
+			required = true;
+			break;
+		}
+	}
+	_grabber.setImageRequired(required);
+}
+
+void V4L2Wrapper::setStandby(bool standby)
+{
+	// the device keeps streaming at its frame rate, a restart would take too long on visibility changes
+	_grabber.setStandbyInterval(standby ? STANDBY_INTERVAL_MS : 0);
+}
+
 void V4L2Wrapper::readError(const char* err)
 {
 	Error(_log, "stop grabber, because reading device failed. (%s)", err);
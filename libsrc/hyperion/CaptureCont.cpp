@@ -2,6 +2,8 @@
 
 // hyperion includes
 #include <hyperion/Hyperion.h>
+#include <hyperion/ImageProcessor.h>
+#include <hyperion/FrameAnalysis.h>
 
 // utils includes
 #include <utils/GlobalSignals.h>
@@ -9,17 +11,34 @@
 // qt includes
 #include <QTimer>
 
+// stl includes
+#include <atomic>
+
+namespace {
+
+/// The number of instances which capture the system and v4l images, a frame captured by several of them is analysed once
+std::atomic<int> systemCaptures(0);
+std::atomic<int> v4lCaptures(0);
+
+} // namespace
+
 CaptureCont::CaptureCont(Hyperion* hyperion)
 	: QObject()
 	, _hyperion(hyperion)
+	, _captureLock()
+	, _closing(false)
 	, _systemCaptEnabled(false)
 	, _systemCaptPrio(0)
 	, _systemCaptName()
 	, _systemInactiveTimer(new QTimer(this))
+	, _systemCaptStandby(false)
 	, _v4lCaptEnabled(false)
 	, _v4lCaptPrio(0)
 	, _v4lCaptName()
 	, _v4lInactiveTimer(new QTimer(this))
+	, _v4lCaptStandby(false)
+	, _v4lDirectMappingEnabled(false)
+	, _v4lDirectMapping(false)
 {
 	// settings changes
 	connect(_hyperion, &Hyperion::settingsChanged, this, &CaptureCont::handleSettingsUpdate);
@@ -27,6 +46,27 @@ CaptureCont::CaptureCont(Hyperion* hyperion)
 	// comp changes
 	connect(_hyperion, &Hyperion::compStateChangeRequest, this, &CaptureCont::handleCompStateChangeRequest);
 
+	// hidden captures are not set inactive, they send keep-alive images only
+	connect(_hyperion->getMuxerInstance(), &PriorityMuxer::inputStandbyChanged, this, &CaptureCont::handleInputStandby);
+
+	// the led mapping of direct mapped v4l frames follows the led mapping type
+	connect(_hyperion, &Hyperion::imageToLedsMappingChanged, this, [=](){ updateV4lDirectMapping(true); });
+
+	// direct mapping is re-evaluated when an image consumer or the black border detection changes, not per frame.
+	// Queued, as the consumers are notified from the connecting thread and the detection is updated after the notification
+	connect(_hyperion, &Hyperion::imageConsumersChanged, this, [=](){ updateV4lDirectMapping(); }, Qt::QueuedConnection);
+	connect(&_hyperion->getComponentRegister(), &ComponentRegister::updatedComponentState, this, [=](hyperion::Components component, bool){
+		if(component == hyperion::COMP_BLACKBORDER)
+			updateV4lDirectMapping();
+	}, Qt::QueuedConnection);
+	connect(_hyperion->getMuxerInstance(), &PriorityMuxer::visibleComponentChanged, this, [=](){ updateV4lDirectMapping(); }, Qt::QueuedConnection);
+
+	// a new v4l capture does not know about the direct mapping yet
+	connect(GlobalSignals::getInstance(), &GlobalSignals::v4lDirectMappingReset, this, [=](){
+		_v4lDirectMapping = false;
+		updateV4lDirectMapping();
+	});
+
 	// inactive timer system
 	connect(_systemInactiveTimer, &QTimer::timeout, this, &CaptureCont::setSystemInactive);
 	_systemInactiveTimer->setSingleShot(true);
@@ -41,17 +81,144 @@ CaptureCont::CaptureCont(Hyperion* hyperion)
 	handleSettingsUpdate(settings::INSTCAPTURE, _hyperion->getSetting(settings::INSTCAPTURE));
 }
 
+CaptureCont::~CaptureCont()
+{
+	// no more images from the capture threads, an image put right now is waited for
+	disconnect(GlobalSignals::getInstance(), nullptr, this, nullptr);
+
+	QMutexLocker lock(&_captureLock);
+	_closing = true;
+
+	if(_systemCaptEnabled)
+		--systemCaptures;
+	if(_v4lCaptEnabled)
+		--v4lCaptures;
+}
+
+quint64 CaptureCont::getDroppedFrames(hyperion::Components component) const
+{
+	switch (component)
+	{
+		case hyperion::COMP_GRABBER: return _systemImages.dropped();
+		case hyperion::COMP_V4L: return _v4lImages.dropped();
+		default: return 0;
+	}
+}
+
+void CaptureCont::queueSystemImage(const QString& name, const Image<ColorRgb>& image)
+{
+	// called in the thread of the capture, the instance may be destructed meanwhile
+	QMutexLocker lock(&_captureLock);
+	if (_closing)
+	{
+		return;
+	}
+
+	// a pending image is replaced, the instance processes the latest one only
+	if (_systemImages.put(CapturedImage{name, image}))
+	{
+		QMetaObject::invokeMethod(this, "processSystemImage", Qt::QueuedConnection);
+	}
+}
+
+void CaptureCont::queueV4lImage(const QString& name, const Image<ColorRgb>& image)
+{
+	QMutexLocker lock(&_captureLock);
+	if (_closing)
+	{
+		return;
+	}
+
+	if (_v4lImages.put(CapturedImage{name, image}))
+	{
+		QMetaObject::invokeMethod(this, "processV4lImage", Qt::QueuedConnection);
+	}
+}
+
+void CaptureCont::processSystemImage()
+{
+	CapturedImage captured;
+	if (_systemImages.take(captured) && _systemCaptEnabled)
+	{
+		handleSystemImage(captured.name, captured.image);
+	}
+}
+
+void CaptureCont::processV4lImage()
+{
+	CapturedImage captured;
+	if (_v4lImages.take(captured) && _v4lCaptEnabled)
+	{
+		handleV4lImage(captured.name, captured.image);
+	}
+}
+
 void CaptureCont::handleV4lImage(const QString& name, const Image<ColorRgb> & image)
 {
+	// frames are mapped to led colors by the capture
+	if(_v4lDirectMapping)
+	{
+		return;
+	}
+
 	if(_v4lCaptName != name)
 	{
 		_hyperion->registerInput(_v4lCaptPrio, hyperion::COMP_V4L, "System", name);
 		_v4lCaptName = name;
 	}
-	_v4lInactiveTimer->start();
+	if(!_v4lCaptStandby)
+		_v4lInactiveTimer->start();
+
+	// the frame is shared by the instances capturing it
+	if(v4lCaptures > 1)
+		hyperion::FrameAnalysis::add(image);
+
 	_hyperion->setInputImage(_v4lCaptPrio, image);
 }
 
+void CaptureCont::handleV4lLedColors(const QString& name, int hyperionInd, const std::vector<ColorRgb>& ledColors)
+{
+	// led colors of other instances or outdated ones after the image is required again
+	if(hyperionInd != int(_hyperion->getInstanceIndex()) || !_v4lDirectMapping)
+	{
+		return;
+	}
+
+	// mapped with an outdated led layout
+	if(static_cast<int>(ledColors.size()) != _hyperion->getLedCount())
+	{
+		updateV4lDirectMapping(true);
+		return;
+	}
+
+	if(_v4lCaptName != name)
+	{
+		_hyperion->registerInput(_v4lCaptPrio, hyperion::COMP_V4L, "System", name);
+		_v4lCaptName = name;
+	}
+	if(!_v4lCaptStandby)
+		_v4lInactiveTimer->start();
+	_hyperion->setInput(_v4lCaptPrio, ledColors);
+}
+
+void CaptureCont::updateV4lDirectMapping(bool force)
+{
+	const bool directMapping = _v4lCaptEnabled
+			&& _v4lDirectMappingEnabled
+			&& !_hyperion->getImageProcessor()->blackBorderDetectorEnabled()
+			&& !_hyperion->hasImageConsumers();
+
+	if(directMapping == _v4lDirectMapping && !(force && directMapping))
+	{
+		return;
+	}
+
+	_v4lDirectMapping = directMapping;
+	emit GlobalSignals::getInstance()->requestV4lDirectMapping(int(_hyperion->getInstanceIndex()),
+		directMapping ? _hyperion->getLedString().leds() : std::vector<Led>(),
+		_hyperion->getImageProcessor()->ledMappingType());
+}
+
 void CaptureCont::handleSystemImage(const QString& name, const Image<ColorRgb>& image)
 {
 	if(_systemCaptName != name)
@@ -59,7 +226,12 @@ void CaptureCont::handleSystemImage(const QString& name, const Image<ColorRgb>&
 		_hyperion->registerInput(_systemCaptPrio, hyperion::COMP_GRABBER, "System", name);
 		_systemCaptName = name;
 	}
-	_systemInactiveTimer->start();
+	if(!_systemCaptStandby)
+		_systemInactiveTimer->start();
+
+	if(systemCaptures > 1)
+		hyperion::FrameAnalysis::add(image);
+
 	_hyperion->setInputImage(_systemCaptPrio, image);
 }
 
@@ -70,17 +242,21 @@ void CaptureCont::setSystemCaptureEnable(bool enable)
 		if(enable)
 		{
 			_hyperion->registerInput(_systemCaptPrio, hyperion::COMP_GRABBER);
-			connect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, this, &CaptureCont::handleSystemImage);
+			connect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, this, &CaptureCont::queueSystemImage, Qt::DirectConnection);
 			connect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, _hyperion, &Hyperion::forwardSystemProtoMessage);
 		}
 		else
 		{
-			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, 0, 0);
+			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, this, 0);
+			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, _hyperion, 0);
+			_systemImages.clear();
 			_hyperion->clear(_systemCaptPrio);
 			_systemInactiveTimer->stop();
+			_systemCaptStandby = false;
 			_systemCaptName = "";
 		}
 		_systemCaptEnabled = enable;
+		systemCaptures += enable ? 1 : -1;
 		_hyperion->setNewComponentState(hyperion::COMP_GRABBER, enable);
 		emit GlobalSignals::getInstance()->requestSource(hyperion::COMP_GRABBER, int(_hyperion->getInstanceIndex()), enable);
 	}
@@ -93,19 +269,28 @@ void CaptureCont::setV4LCaptureEnable(bool enable)
 		if(enable)
 		{
 			_hyperion->registerInput(_v4lCaptPrio, hyperion::COMP_V4L);
-			connect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, this, &CaptureCont::handleV4lImage);
+			connect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, this, &CaptureCont::queueV4lImage, Qt::DirectConnection);
 			connect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, _hyperion, &Hyperion::forwardV4lProtoMessage);
+			connect(GlobalSignals::getInstance(), &GlobalSignals::setV4lLedColors, this, &CaptureCont::handleV4lLedColors);
 		}
 		else
 		{
-			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, 0, 0);
+			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, this, 0);
+			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, _hyperion, 0);
+			_v4lImages.clear();
+			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setV4lLedColors, this, 0);
+			_v4lDirectMapping = false;
 			_hyperion->clear(_v4lCaptPrio);
 			_v4lInactiveTimer->stop();
+			_v4lCaptStandby = false;
 			_v4lCaptName = "";
 		}
 		_v4lCaptEnabled = enable;
+		v4lCaptures += enable ? 1 : -1;
 		_hyperion->setNewComponentState(hyperion::COMP_V4L, enable);
 		emit GlobalSignals::getInstance()->requestSource(hyperion::COMP_V4L, int(_hyperion->getInstanceIndex()), enable);
+
+		updateV4lDirectMapping();
 	}
 }
 
@@ -127,6 +312,14 @@ void CaptureCont::handleSettingsUpdate(settings::type type, const QJsonDocument&
 
 		setV4LCaptureEnable(obj["v4lEnable"].toBool(true));
 		setSystemCaptureEnable(obj["systemEnable"].toBool(true));
+
+		_v4lDirectMappingEnabled = obj["v4lDirectMapping"].toBool(false);
+		updateV4lDirectMapping();
+	}
+	else if(type == settings::LEDS)
+	{
+		// direct mapping depends on the led layout, which is applied by Hyperion after this notification
+		QTimer::singleShot(0, this, [=](){ updateV4lDirectMapping(true); });
 	}
 }
 
@@ -142,6 +335,26 @@ void CaptureCont::handleCompStateChangeRequest(hyperion::Components component, b
 	}
 }
 
+void CaptureCont::handleInputStandby(int priority, hyperion::Components component, bool standby)
+{
+	if(component == hyperion::COMP_GRABBER && priority == _systemCaptPrio)
+	{
+		_systemCaptStandby = standby;
+		if(standby)
+			_systemInactiveTimer->stop();
+		else if(_systemCaptEnabled)
+			_systemInactiveTimer->start();
+	}
+	else if(component == hyperion::COMP_V4L && priority == _v4lCaptPrio)
+	{
+		_v4lCaptStandby = standby;
+		if(standby)
+			_v4lInactiveTimer->stop();
+		else if(_v4lCaptEnabled)
+			_v4lInactiveTimer->start();
+	}
+}
+
 void CaptureCont::setV4lInactive()
 {
 	_hyperion->setInputInactive(_v4lCaptPrio);
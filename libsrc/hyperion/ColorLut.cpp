@@ -0,0 +1,97 @@
+// Hyperion includes
+#include <hyperion/ColorLut.h>
+
+namespace {
+
+/// Weighted sum of the 4 nodes of a tetrahedron, the weights sum up to 256
+inline uint8_t interpolate(uint8_t c0, uint8_t c1, uint8_t c2, uint8_t c3, int w0, int w1, int w2, int w3)
+{
+	return static_cast<uint8_t>((c0 * w0 + c1 * w1 + c2 * w2 + c3 * w3 + 128) >> 8);
+}
+
+inline ColorRgb interpolate(const ColorRgb& c0, const ColorRgb& c1, const ColorRgb& c2, const ColorRgb& c3, int w0, int w1, int w2, int w3)
+{
+	return ColorRgb{
+		interpolate(c0.red,   c1.red,   c2.red,   c3.red,   w0, w1, w2, w3),
+		interpolate(c0.green, c1.green, c2.green, c3.green, w0, w1, w2, w3),
+		interpolate(c0.blue,  c1.blue,  c2.blue,  c3.blue,  w0, w1, w2, w3)
+	};
+}
+
+} // namespace
+
+ColorLut::ColorLut()
+	: _size(0)
+	, _buildSize(0)
+	, _buildPlane(0)
+	, _table()
+	, _nodeValues()
+	, _lowerNode()
+	, _weight()
+{
+}
+
+void ColorLut::invalidate()
+{
+	_size = 0;
+	_buildSize = 0;
+	_buildPlane = 0;
+}
+
+void ColorLut::initNodes(int size)
+{
+	_nodeValues.resize(size);
+	for (int i = 0; i < size; ++i)
+	{
+		_nodeValues[i] = static_cast<uint8_t>((i * 255 + (size - 1) / 2) / (size - 1));
+	}
+
+	// the nodes hit their values exactly, the last node is reached with the full weight of the upper one
+	int node = 0;
+	for (int value = 0; value < 256; ++value)
+	{
+		while (node < size - 2 && value >= _nodeValues[node + 1])
+		{
+			++node;
+		}
+		_lowerNode[value] = static_cast<uint8_t>(node);
+		_weight[value] = static_cast<uint16_t>(((value - _nodeValues[node]) * 256) / (_nodeValues[node + 1] - _nodeValues[node]));
+	}
+}
+
+void ColorLut::apply(ColorRgb* colors, size_t count) const
+{
+	const size_t strideR = static_cast<size_t>(_size) * _size;
+	const size_t strideG = _size;
+	const ColorRgb* table = _table.data();
+
+	for (ColorRgb* color = colors; color != colors + count; ++color)
+	{
+		const int fr = _weight[color->red];
+		const int fg = _weight[color->green];
+		const int fb = _weight[color->blue];
+
+		const ColorRgb* c000 = table + _lowerNode[color->red] * strideR + _lowerNode[color->green] * strideG + _lowerNode[color->blue];
+		const ColorRgb& c111 = c000[strideR + strideG + 1];
+
+		// the cube is split into 6 tetrahedra along its diagonal, the order of the weights selects one
+		if (fr >= fg)
+		{
+			if (fg >= fb)
+				*color = interpolate(c000[0], c000[strideR], c000[strideR + strideG], c111, 256 - fr, fr - fg, fg - fb, fb);
+			else if (fr >= fb)
+				*color = interpolate(c000[0], c000[strideR], c000[strideR + 1], c111, 256 - fr, fr - fb, fb - fg, fg);
+			else
+				*color = interpolate(c000[0], c000[1], c000[strideR + 1], c111, 256 - fb, fb - fr, fr - fg, fg);
+		}
+		else
+		{
+			if (fr >= fb)
+				*color = interpolate(c000[0], c000[strideG], c000[strideR + strideG], c111, 256 - fg, fg - fr, fr - fb, fb);
+			else if (fg >= fb)
+				*color = interpolate(c000[0], c000[strideG], c000[strideG + 1], c111, 256 - fg, fg - fb, fb - fr, fr);
+			else
+				*color = interpolate(c000[0], c000[1], c000[strideG + 1], c111, 256 - fb, fb - fg, fg - fr, fr);
+		}
+	}
+}
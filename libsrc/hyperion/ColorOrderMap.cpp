@@ -0,0 +1,157 @@
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+// Hyperion includes
+#include <hyperion/ColorOrderMap.h>
+
+#if defined(__SSSE3__)
+	#include <tmmintrin.h>
+	#define COLORORDERMAP_SSSE3
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define COLORORDERMAP_NEON
+#endif
+
+namespace {
+
+/// The source channel (0 = red, 1 = green, 2 = blue) of the first, second and third output byte
+struct Swizzle
+{
+	int first;
+	int second;
+	int third;
+};
+
+Swizzle swizzleOf(ColorOrder order)
+{
+	switch (order)
+	{
+	case ColorOrder::ORDER_RBG: return {0, 2, 1};
+	case ColorOrder::ORDER_GRB: return {1, 0, 2};
+	case ColorOrder::ORDER_BRG: return {2, 0, 1};
+	case ColorOrder::ORDER_GBR: return {1, 2, 0};
+	case ColorOrder::ORDER_BGR: return {2, 1, 0};
+	case ColorOrder::ORDER_RGB:
+	default:                    return {0, 1, 2};
+	}
+}
+
+///
+/// Reorders the bytes of count colors, returns the number of converted colors. The remaining colors are left to the caller.
+///
+#if defined(COLORORDERMAP_SSSE3)
+
+size_t swizzleVector(const uint8_t* src, uint8_t* dest, size_t count, const Swizzle& swizzle)
+{
+	// 5 colors per 16 byte register, the 16th byte is overwritten by the next store
+	const __m128i mask = _mm_setr_epi8(
+		static_cast<char>(swizzle.first),      static_cast<char>(swizzle.second),      static_cast<char>(swizzle.third),
+		static_cast<char>(swizzle.first + 3),  static_cast<char>(swizzle.second + 3),  static_cast<char>(swizzle.third + 3),
+		static_cast<char>(swizzle.first + 6),  static_cast<char>(swizzle.second + 6),  static_cast<char>(swizzle.third + 6),
+		static_cast<char>(swizzle.first + 9),  static_cast<char>(swizzle.second + 9),  static_cast<char>(swizzle.third + 9),
+		static_cast<char>(swizzle.first + 12), static_cast<char>(swizzle.second + 12), static_cast<char>(swizzle.third + 12),
+		15);
+
+	size_t done = 0;
+	// 16 bytes have to be readable and writable, so one more color has to follow
+	for (; done + 6 <= count; done += 5)
+	{
+		const __m128i colors = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + done * 3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + done * 3), _mm_shuffle_epi8(colors, mask));
+	}
+	return done;
+}
+
+#elif defined(COLORORDERMAP_NEON)
+
+size_t swizzleVector(const uint8_t* src, uint8_t* dest, size_t count, const Swizzle& swizzle)
+{
+	size_t done = 0;
+	for (; done + 16 <= count; done += 16)
+	{
+		const uint8x16x3_t colors = vld3q_u8(src + done * 3);
+		uint8x16x3_t ordered;
+		ordered.val[0] = colors.val[swizzle.first];
+		ordered.val[1] = colors.val[swizzle.second];
+		ordered.val[2] = colors.val[swizzle.third];
+		vst3q_u8(dest + done * 3, ordered);
+	}
+	return done;
+}
+
+#else
+
+size_t swizzleVector(const uint8_t* /*src*/, uint8_t* /*dest*/, size_t /*count*/, const Swizzle& /*swizzle*/)
+{
+	return 0;
+}
+
+#endif
+
+void swizzleRun(const ColorRgb* src, ColorRgb* dest, size_t count, ColorOrder order)
+{
+	if (order == ColorOrder::ORDER_RGB)
+	{
+		memcpy(dest, src, count * sizeof(ColorRgb));
+		return;
+	}
+
+	const Swizzle swizzle = swizzleOf(order);
+	const uint8_t* srcBytes = reinterpret_cast<const uint8_t*>(src);
+	uint8_t* destBytes = reinterpret_cast<uint8_t*>(dest);
+
+	for (size_t i = swizzleVector(srcBytes, destBytes, count, swizzle); i < count; ++i)
+	{
+		const uint8_t* color = srcBytes + i * 3;
+		destBytes[i * 3]     = color[swizzle.first];
+		destBytes[i * 3 + 1] = color[swizzle.second];
+		destBytes[i * 3 + 2] = color[swizzle.third];
+	}
+}
+
+} // namespace
+
+ColorOrderMap::ColorOrderMap()
+	: _runs()
+	, _ledCount(0)
+{
+}
+
+void ColorOrderMap::setLeds(const std::vector<Led>& leds)
+{
+	_runs.clear();
+	_ledCount = leds.size();
+
+	for (size_t i = 0; i < leds.size(); ++i)
+	{
+		if (!_runs.empty() && _runs.back().order == leds[i].colorOrder)
+		{
+			_runs.back().end = i + 1;
+		}
+		else
+		{
+			_runs.push_back({i, i + 1, leds[i].colorOrder});
+		}
+	}
+}
+
+void ColorOrderMap::apply(const std::vector<ColorRgb>& colors, size_t hwLedCount, std::vector<ColorRgb>& output) const
+{
+	output.resize(std::max(colors.size(), hwLedCount));
+
+	for (const Run& run : _runs)
+	{
+		if (run.begin >= colors.size())
+		{
+			break;
+		}
+		const size_t end = std::min(run.end, colors.size());
+		swizzleRun(colors.data() + run.begin, output.data() + run.begin, end - run.begin, run.order);
+	}
+
+	// colors beyond the led string are kept, additional hardware leds are black
+	const size_t converted = std::min(_ledCount, colors.size());
+	std::copy(colors.begin() + converted, colors.end(), output.begin() + converted);
+	std::fill(output.begin() + colors.size(), output.end(), ColorRgb::BLACK);
+}
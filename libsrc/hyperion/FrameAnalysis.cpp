@@ -0,0 +1,104 @@
+// Hyperion includes
+#include <hyperion/FrameAnalysis.h>
+
+// STL includes
+#include <deque>
+
+// QT includes
+#include <QMutexLocker>
+
+using namespace hyperion;
+
+namespace {
+
+/// The bytes the kept analyses may hold, instances lagging behind by a few frames still share their analysis.
+/// The latest analysis is always kept, large frames replace each other.
+const size_t MAX_MEMORY_USAGE = 16 * 1024 * 1024;
+
+QMutex framesMutex;
+std::deque<std::shared_ptr<FrameAnalysis>> frames;
+
+} // namespace
+
+FrameAnalysis::FrameAnalysis(const Image<ColorRgb> & image)
+	: _image(image)
+	, _summedAreas()
+	, _blackBorders()
+	, _memoryUsage(static_cast<size_t>(image.size()))
+{
+}
+
+void FrameAnalysis::add(const Image<ColorRgb> & image)
+{
+	QMutexLocker locker(&framesMutex);
+
+	// the instances sharing the frame add it each
+	if (find(image) != nullptr)
+	{
+		return;
+	}
+
+	frames.emplace_front(new FrameAnalysis(image));
+
+	// the latest analysis is always kept
+	size_t memoryUsage = 0;
+	for (auto it = frames.begin(); it != frames.end(); ++it)
+	{
+		memoryUsage += (*it)->_memoryUsage;
+		if (memoryUsage > MAX_MEMORY_USAGE && it != frames.begin())
+		{
+			frames.erase(it, frames.end());
+			break;
+		}
+	}
+}
+
+std::shared_ptr<FrameAnalysis> FrameAnalysis::get(const Image<ColorRgb> & image)
+{
+	QMutexLocker locker(&framesMutex);
+	return find(image);
+}
+
+std::shared_ptr<FrameAnalysis> FrameAnalysis::find(const Image<ColorRgb> & image)
+{
+	// images of the same frame share their pixels
+	for (const auto& frame : frames)
+	{
+		if (frame->_image.memptr() == image.memptr() && frame->_image.width() == image.width() && frame->_image.height() == image.height())
+		{
+			return frame;
+		}
+	}
+	return nullptr;
+}
+
+const std::vector<uint32_t> & FrameAnalysis::summedAreaTable(const std::shared_ptr<const SummedAreaLayout> & layout)
+{
+	QMutexLocker locker(&_mutex);
+	for (const auto& summedArea : _summedAreas)
+	{
+		if (summedArea.first == layout || *summedArea.first == *layout)
+		{
+			return summedArea.second;
+		}
+	}
+
+	_summedAreas.emplace_back(layout, std::vector<uint32_t>());
+	std::vector<uint32_t>& summedArea = _summedAreas.back().second;
+	integrate(*layout, _image, summedArea);
+	_memoryUsage += summedArea.size() * sizeof(uint32_t);
+	return summedArea;
+}
+
+BlackBorder FrameAnalysis::blackBorder(const BlackBorderDetector & detector, const QString & mode)
+{
+	QMutexLocker locker(&_mutex);
+	const auto key = std::make_pair(detector.threshold(), mode);
+
+	auto it = _blackBorders.find(key);
+	if (it == _blackBorders.end())
+	{
+		it = _blackBorders.emplace(key, detector.process(_image, mode)).first;
+	}
+	return it->second;
+}
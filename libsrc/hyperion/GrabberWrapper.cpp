@@ -10,6 +10,7 @@
 #include <QTimer>
 
 GrabberWrapper* GrabberWrapper::instance = nullptr;
+const int GrabberWrapper::STANDBY_INTERVAL_MS = 1000;
 
 GrabberWrapper::GrabberWrapper(const QString& grabberName, Grabber * ggrabber, unsigned width, unsigned height, unsigned updateRate_Hz)
 	: _grabberName(grabberName)
@@ -18,6 +19,8 @@ GrabberWrapper::GrabberWrapper(const QString& grabberName, Grabber * ggrabber, u
 	, _log(Logger::getInstance(grabberName))
 	, _ggrabber(ggrabber)
 	, _image(0,0)
+	, _standbyClients()
+	, _standby(false)
 {
 	GrabberWrapper::instance = this;
 
@@ -35,6 +38,9 @@ GrabberWrapper::GrabberWrapper(const QString& grabberName, Grabber * ggrabber, u
 
 	// listen for source requests
 	connect(GlobalSignals::getInstance(), &GlobalSignals::requestSource, this, &GrabberWrapper::handleSourceRequest);
+
+	// listen for the standby state of the capture inputs
+	connect(GlobalSignals::getInstance(), &GlobalSignals::inputStandby, this, &GrabberWrapper::handleInputStandby);
 }
 
 GrabberWrapper::~GrabberWrapper()
@@ -135,7 +141,7 @@ void GrabberWrapper::updateTimer(int interval)
 
 		const bool& timerWasActive = _timer->isActive();
 		_timer->stop();
-		_timer->setInterval(_updateInterval_ms);
+		_timer->setInterval(_standby ? qMax(_updateInterval_ms, STANDBY_INTERVAL_MS) : _updateInterval_ms);
 
 		if(timerWasActive)
 			_timer->start();
@@ -182,6 +188,10 @@ void GrabberWrapper::handleSourceRequest(hyperion::Components component, int hyp
 		else if (!listen)
 			GRABBER_SYS_CLIENTS.removeOne(hyperionInd);
 
+		if(!listen)
+			_standbyClients.remove(hyperionInd);
+		updateStandby();
+
 		if(GRABBER_SYS_CLIENTS.empty())
 			stop();
 		else
@@ -194,6 +204,10 @@ void GrabberWrapper::handleSourceRequest(hyperion::Components component, int hyp
 		else if (!listen)
 			GRABBER_V4L_CLIENTS.removeOne(hyperionInd);
 
+		if(!listen)
+			_standbyClients.remove(hyperionInd);
+		updateStandby();
+
 		if(GRABBER_V4L_CLIENTS.empty())
 			stop();
 		else
@@ -201,6 +215,54 @@ void GrabberWrapper::handleSourceRequest(hyperion::Components component, int hyp
 	}
 }
 
+void GrabberWrapper::handleInputStandby(int hyperionInd, int priority, hyperion::Components component, bool standby)
+{
+	Q_UNUSED(priority);
+
+	// an instance has one input per capture component
+	if(component != (_grabberName.startsWith("V4L") ? hyperion::Components::COMP_V4L : hyperion::Components::COMP_GRABBER))
+		return;
+
+	if(standby)
+		_standbyClients.insert(hyperionInd);
+	else
+		_standbyClients.remove(hyperionInd);
+
+	updateStandby();
+}
+
+void GrabberWrapper::updateStandby()
+{
+	const QList<int>& clients = _grabberName.startsWith("V4L") ? GRABBER_V4L_CLIENTS : GRABBER_SYS_CLIENTS;
+
+	bool standby = !clients.empty();
+	for(int hyperionInd : clients)
+	{
+		if(!_standbyClients.contains(hyperionInd))
+		{
+			standby = false;
+			break;
+		}
+	}
+
+	if(standby != _standby)
+	{
+		_standby = standby;
+		Debug(_log, "Capture %s", standby ? "hidden by a higher priority, keep-alive rate" : "visible, full rate");
+		setStandby(standby);
+	}
+}
+
+void GrabberWrapper::setStandby(bool standby)
+{
+	const bool& timerWasActive = _timer->isActive();
+	_timer->stop();
+	_timer->setInterval(standby ? qMax(_updateInterval_ms, STANDBY_INTERVAL_MS) : _updateInterval_ms);
+
+	if(timerWasActive)
+		_timer->start();
+}
+
 void GrabberWrapper::tryStart()
 {
 	// verify start condition
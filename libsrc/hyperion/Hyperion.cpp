@@ -6,12 +6,14 @@
 #include <QString>
 #include <QStringList>
 #include <QThread>
+#include <QMetaMethod>
 
 // hyperion include
 #include <hyperion/Hyperion.h>
 #include <hyperion/MessageForwarder.h>
 #include <hyperion/ImageProcessor.h>
 #include <hyperion/ColorAdjustment.h>
+#include <hyperion/ImageStream.h>
 
 // utils
 #include <utils/hyperion.h>
@@ -23,6 +25,7 @@
 
 #include <hyperion/MultiColorAdjustment.h>
 #include "LinearColorSmoothing.h"
+#include "LedBlender.h"
 
 // effect engine includes
 #include <effectengine/EffectEngine.h>
@@ -46,6 +49,7 @@ Hyperion::Hyperion(quint8 instance, bool readonlyMode)
 	, _componentRegister(this)
 	, _ledString(hyperion::createLedString(getSetting(settings::LEDS).array(), hyperion::createColorOrder(getSetting(settings::DEVICE).object())))
 	, _imageProcessor(new ImageProcessor(_ledString, this))
+	, _layerProcessor(nullptr)
 	, _muxer(static_cast<int>(_ledString.leds().size()), this)
 	, _raw2ledAdjustment(hyperion::createLedColorsAdjustment(static_cast<int>(_ledString.leds().size()), getSetting(settings::COLOR).object()))
 	, _ledDeviceWrapper(nullptr)
@@ -57,7 +61,13 @@ Hyperion::Hyperion(quint8 instance, bool readonlyMode)
 	, _ledGridSize(hyperion::getLedLayoutGridSize(getSetting(settings::LEDS).array()))
 	, _BGEffectHandler(nullptr)
 	,_captureCont(nullptr)
+	, _imageStream(nullptr)
 	, _ledBuffer(_ledString.leds().size(), ColorRgb::BLACK)
+	, _layerBuffer()
+	, _ledOutput()
+	, _lastLedOutput()
+	, _lastSmoothCfg(0)
+	, _ledOutputValid(false)
 	, _boblightServer(nullptr)
 	, _readOnlyMode(readonlyMode)
 {
@@ -85,17 +95,20 @@ void Hyperion::start()
 	// handle hwLedCount
 	_hwLedCount = getSetting(settings::DEVICE).object()["hardwareLedCount"].toInt(getLedCount());
 
-	// Initialize colororder vector
-	for (const Led& led : _ledString.leds())
-	{
-		_ledStringColorOrder.push_back(led.colorOrder);
-	}
+	// Initialize colororder runs
+	_colorOrderMap.setLeds(_ledString.leds());
 
 	// connect Hyperion::update with Muxer visible priority changes as muxer updates independent
 	connect(&_muxer, &PriorityMuxer::visiblePriorityChanged, this, &Hyperion::update);
+	connect(&_muxer, &PriorityMuxer::layersChanged, this, &Hyperion::update);
 	connect(&_muxer, &PriorityMuxer::visiblePriorityChanged, this, &Hyperion::handlePriorityChangedLedDevice);
 	connect(&_muxer, &PriorityMuxer::visibleComponentChanged, this, &Hyperion::handleVisibleComponentChanged);
 
+	// producers of hidden inputs may reduce their rate
+	connect(&_muxer, &PriorityMuxer::inputStandbyChanged, this, [=](int priority, hyperion::Components component, bool standby) {
+		emit GlobalSignals::getInstance()->inputStandby(int(_instIndex), priority, component, standby);
+	});
+
 	// listens for ComponentRegister changes of COMP_ALL to perform core enable/disable actions
 	// connect(&_componentRegister, &ComponentRegister::updatedComponentState, this, &Hyperion::updatedComponentState);
 
@@ -113,9 +126,21 @@ void Hyperion::start()
 
 	_ledDeviceWrapper = new LedDeviceWrapper(this);
 	connect(this, &Hyperion::compStateChangeRequest, _ledDeviceWrapper, &LedDeviceWrapper::handleComponentState);
-	connect(this, &Hyperion::ledDeviceData, _ledDeviceWrapper, &LedDeviceWrapper::updateLeds);
+	// the smoothing writes from its own thread, the wrapper forwards queued to the device thread
+	connect(this, &Hyperion::ledDeviceData, _ledDeviceWrapper, &LedDeviceWrapper::updateLeds, Qt::DirectConnection);
 	_ledDeviceWrapper->createLedDevice(ledDevice);
 
+	// a component state change (LED device, smoothing) requires to write the current colors again
+	connect(this, &Hyperion::compStateChangeRequest, this, [=]() { _ledOutputValid = false; });
+
+	// as well as a LED device which is ready (enabled) again, e.g. after an error, or a smoothing enabled again
+	connect(&_componentRegister, &ComponentRegister::updatedComponentState, this, [=](hyperion::Components component, bool state) {
+		if (state && (component == hyperion::COMP_LEDDEVICE || component == hyperion::COMP_SMOOTHING))
+		{
+			_ledOutputValid = false;
+		}
+	});
+
 	// smoothing
 	_deviceSmooth = new LinearColorSmoothing(getSetting(settings::SMOOTHING), this);
 	connect(this, &Hyperion::settingsChanged, _deviceSmooth, &LinearColorSmoothing::handleSettingsUpdate);
@@ -139,6 +164,15 @@ void Hyperion::start()
 	// create the Daemon capture interface
 	_captureCont = new CaptureCont(this);
 
+	// the live image preview is encoded on its own thread
+	QThread* imageStreamThread = new QThread(this);
+	imageStreamThread->setObjectName("ImageStreamThread");
+	_imageStream = new ImageStream(this, getSetting(settings::WEBSERVER));
+	_imageStream->moveToThread(imageStreamThread);
+	connect(imageStreamThread, &QThread::finished, _imageStream, &QObject::deleteLater);
+	connect(this, &Hyperion::settingsChanged, _imageStream, &ImageStream::handleSettingsUpdate);
+	imageStreamThread->start();
+
 	// forwards global signals to the corresponding slots
 	connect(GlobalSignals::getInstance(), &GlobalSignals::registerGlobalInput, this, &Hyperion::registerInput);
 	connect(GlobalSignals::getInstance(), &GlobalSignals::clearGlobalInput, this, &Hyperion::clear);
@@ -170,10 +204,20 @@ void Hyperion::freeObjects()
 	// delete components on exit of hyperion core
 	delete _boblightServer;
 	delete _captureCont;
+
+	if (_imageStream != nullptr)
+	{
+		QThread* imageStreamThread = _imageStream->thread();
+		imageStreamThread->quit();
+		imageStreamThread->wait();
+		delete imageStreamThread;
+		_imageStream = nullptr;
+	}
 	delete _effectEngine;
 	delete _raw2ledAdjustment;
 	delete _messageForwarder;
 	delete _settingsManager;
+	delete _deviceSmooth;
 	delete _ledDeviceWrapper;
 }
 
@@ -182,6 +226,9 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 //	std::cout << "Hyperion::handleSettingsUpdate" << std::endl;
 //	std::cout << config.toJson().toStdString() << std::endl;
 
+	// the next update writes to the (recreated) device in any case
+	_ledOutputValid = false;
+
 	if(type == settings::COLOR)
 	{
 		const QJsonObject obj = config.object();
@@ -204,17 +251,15 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 		// ledstring, img processor, muxer, ledGridSize (effect-engine image based effects), _ledBuffer and ByteOrder of ledstring
 		_ledString = hyperion::createLedString(leds, hyperion::createColorOrder(getSetting(settings::DEVICE).object()));
 		_imageProcessor->setLedString(_ledString);
+		if (_layerProcessor != nullptr)
+			_layerProcessor->setLedString(_ledString);
 		_muxer.updateLedColorsLength(static_cast<int>(_ledString.leds().size()));
 		_ledGridSize = hyperion::getLedLayoutGridSize(leds);
 
 		std::vector<ColorRgb> color(_ledString.leds().size(), ColorRgb{0,0,0});
 		_ledBuffer = color;
 
-		_ledStringColorOrder.clear();
-		for (const Led& led : _ledString.leds())
-		{
-			_ledStringColorOrder.push_back(led.colorOrder);
-		}
+		_colorOrderMap.setLeds(_ledString.leds());
 
 		// handle hwLedCount update
 		_hwLedCount = getSetting(settings::DEVICE).object()["hardwareLedCount"].toInt(getLedCount());
@@ -238,12 +283,10 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 		{
 			_ledString = hyperion::createLedString(getSetting(settings::LEDS).array(), hyperion::createColorOrder(dev));
 			_imageProcessor->setLedString(_ledString);
+			if (_layerProcessor != nullptr)
+				_layerProcessor->setLedString(_ledString);
 
-			_ledStringColorOrder.clear();
-			for (const Led& led : _ledString.leds())
-			{
-				_ledStringColorOrder.push_back(led.colorOrder);
-			}
+			_colorOrderMap.setLeds(_ledString.leds());
 		}
 
 		// do always reinit until the led devices can handle dynamic changes
@@ -276,14 +319,60 @@ int Hyperion::getLatchTime() const
 	return _ledDeviceWrapper->getLatchTime();
 }
 
-unsigned Hyperion::addSmoothingConfig(int settlingTime_ms, double ledUpdateFrequency_hz, unsigned updateDelay)
+unsigned Hyperion::addSmoothingConfig(int settlingTime_ms, double ledUpdateFrequency_hz, unsigned updateDelay, const QString& smoothingType)
+{
+	return _deviceSmooth->addConfig(settlingTime_ms, ledUpdateFrequency_hz, updateDelay, LinearColorSmoothing::smoothingTypeFromString(smoothingType));
+}
+
+unsigned Hyperion::updateSmoothingConfig(unsigned id, int settlingTime_ms, double ledUpdateFrequency_hz, unsigned updateDelay, const QString& smoothingType)
+{
+	// the config id may be unchanged, the colors have to be handed to the updated smoothing anyway
+	_ledOutputValid = false;
+	return _deviceSmooth->updateConfig(id, settlingTime_ms, ledUpdateFrequency_hz, updateDelay, LinearColorSmoothing::smoothingTypeFromString(smoothingType));
+}
+
+bool Hyperion::hasImageConsumers() const
+{
+	return isSignalConnected(QMetaMethod::fromSignal(&Hyperion::currentImage))
+		|| isSignalConnected(QMetaMethod::fromSignal(&Hyperion::forwardSystemProtoMessage))
+		|| isSignalConnected(QMetaMethod::fromSignal(&Hyperion::forwardV4lProtoMessage));
+}
+
+void Hyperion::connectNotify(const QMetaMethod& signal)
+{
+	if (signal == QMetaMethod::fromSignal(&Hyperion::currentImage)
+		|| signal == QMetaMethod::fromSignal(&Hyperion::forwardSystemProtoMessage)
+		|| signal == QMetaMethod::fromSignal(&Hyperion::forwardV4lProtoMessage))
+	{
+		emit imageConsumersChanged();
+	}
+}
+
+void Hyperion::disconnectNotify(const QMetaMethod& signal)
+{
+	// an invalid method disconnects all signals
+	if (!signal.isValid()
+		|| signal == QMetaMethod::fromSignal(&Hyperion::currentImage)
+		|| signal == QMetaMethod::fromSignal(&Hyperion::forwardSystemProtoMessage)
+		|| signal == QMetaMethod::fromSignal(&Hyperion::forwardV4lProtoMessage))
+	{
+		emit imageConsumersChanged();
+	}
+}
+
+quint64 Hyperion::getCaptureDroppedFrames(hyperion::Components component) const
+{
+	return _captureCont->getDroppedFrames(component);
+}
+
+QJsonObject Hyperion::getSmoothingStatistics() const
 {
-	return _deviceSmooth->addConfig(settlingTime_ms, ledUpdateFrequency_hz, updateDelay);
+	return _deviceSmooth->getStatistics();
 }
 
-unsigned Hyperion::updateSmoothingConfig(unsigned id, int settlingTime_ms, double ledUpdateFrequency_hz, unsigned updateDelay)
+QJsonObject Hyperion::getLedDeviceStatistics() const
 {
-	return _deviceSmooth->updateConfig(id, settlingTime_ms, ledUpdateFrequency_hz, updateDelay);
+	return _ledDeviceWrapper->getStatistics();
 }
 
 int Hyperion::getLedCount() const
@@ -336,8 +425,8 @@ bool Hyperion::setInput(int priority, const std::vector<ColorRgb>& ledColors, in
 			_effectEngine->channelCleared(priority);
 		}
 
-		// if this priority is visible, update immediately
-		if(priority == _muxer.getCurrentPriority())
+		// if this priority is visible (or blended into the visible colors), update immediately
+		if(_muxer.isInputVisible(priority))
 		{
 			update();
 		}
@@ -363,8 +452,8 @@ bool Hyperion::setInputImage(int priority, const Image<ColorRgb>& image, int64_t
 			_effectEngine->channelCleared(priority);
 		}
 
-		// if this priority is visible, update immediately
-		if(priority == _muxer.getCurrentPriority())
+		// if this priority is visible (or blended into the visible colors), update immediately
+		if(_muxer.isInputVisible(priority))
 		{
 			update();
 		}
@@ -374,6 +463,11 @@ bool Hyperion::setInputImage(int priority, const Image<ColorRgb>& image, int64_t
 	return false;
 }
 
+bool Hyperion::setInputBlending(int priority, int blendMode, int opacity)
+{
+	return _muxer.setInputBlending(priority, PriorityMuxer::BlendMode(qBound(0, blendMode, int(PriorityMuxer::BLEND_MAX))), static_cast<uint8_t>(qBound(0, opacity, 255)));
+}
+
 bool Hyperion::setInputInactive(quint8 priority)
 {
 	return _muxer.setInputInactive(priority);
@@ -427,6 +521,7 @@ ColorAdjustment * Hyperion::getAdjustment(const QString& id) const
 
 void Hyperion::adjustmentsUpdated()
 {
+	_raw2ledAdjustment->invalidateLuts();
 	emit adjustmentChanged();
 	update();
 }
@@ -521,6 +616,8 @@ void Hyperion::setLedMappingType(int mappingType)
 	if(mappingType != _imageProcessor->getUserLedMappingType())
 	{
 		_imageProcessor->setLedMappingType(mappingType);
+		if (_layerProcessor != nullptr)
+			_layerProcessor->setLedMappingType(mappingType);
 		emit imageToLedsMappingChanged(mappingType);
 	}
 }
@@ -555,6 +652,7 @@ void Hyperion::handleVisibleComponentChanged(hyperion::Components comp)
 void Hyperion::handlePriorityChangedLedDevice(const quint8& priority)
 {
 	int previousPriority = _muxer.getPreviousPriority();
+	_ledOutputValid = false;
 
 	Debug(_log,"priority[%d], previousPriority[%d]", priority, previousPriority);
 	if ( priority == PriorityMuxer::LOWEST_PRIORITY)
@@ -572,22 +670,70 @@ void Hyperion::handlePriorityChangedLedDevice(const quint8& priority)
 	}
 }
 
+std::vector<ColorRgb> Hyperion::processLayerImage(const PriorityMuxer::InputInfo& layerInfo)
+{
+	// the image of a blended layer is mapped without black border detection, which belongs to the base
+	if (_layerProcessor == nullptr)
+	{
+		_layerProcessor = new ImageProcessor(_ledString, this);
+		_layerProcessor->setBlackbarDetectDisable(true);
+		_layerProcessor->setLedMappingType(_imageProcessor->getUserLedMappingType());
+	}
+	_layerProcessor->setHardLedMappingType((layerInfo.componentId == hyperion::COMP_EFFECT) ? 0 : -1);
+
+	return _layerProcessor->process(layerInfo.image);
+}
+
 void Hyperion::update()
 {
 	// Obtain the current priority channel
 	int priority = _muxer.getCurrentPriority();
 	const PriorityMuxer::InputInfo priorityInfo = _muxer.getInputInfo(priority);
 
-	// copy image & process OR copy ledColors from muxer
-	Image<ColorRgb> image = priorityInfo.image;
-	if(image.size() > 3)
+	const QList<int> layers = _muxer.getLayers();
+	if (layers.size() > 1)
 	{
-		emit currentImage(image);
-		_ledBuffer = _imageProcessor->process(image);
+		// the current priority is blended onto the priorities below, composite them from the base upwards
+		Image<ColorRgb> topImage;
+		for (int i = 0; i < layers.size(); ++i)
+		{
+			const PriorityMuxer::InputInfo layerInfo = _muxer.getInputInfo(layers[i]);
+			std::vector<ColorRgb>& colors = (i == 0) ? _ledBuffer : _layerBuffer;
+
+			if (layerInfo.image.size() > 3)
+			{
+				topImage = layerInfo.image;
+				colors = (i == 0) ? _imageProcessor->process(layerInfo.image) : processLayerImage(layerInfo);
+			}
+			else
+			{
+				colors = layerInfo.ledColors;
+			}
+
+			if (i > 0)
+			{
+				hyperion::blendLedColors(layerInfo.blendMode, layerInfo.opacity, _layerBuffer, _ledBuffer);
+			}
+		}
+
+		if (topImage.size() > 3)
+		{
+			emit currentImage(topImage);
+		}
 	}
 	else
 	{
-		_ledBuffer = priorityInfo.ledColors;
+		// copy image & process OR copy ledColors from muxer
+		Image<ColorRgb> image = priorityInfo.image;
+		if(image.size() > 3)
+		{
+			emit currentImage(image);
+			_ledBuffer = _imageProcessor->process(image);
+		}
+		else
+		{
+			_ledBuffer = priorityInfo.ledColors;
+		}
 	}
 
 	// emit rawLedColors before transform
@@ -595,51 +741,26 @@ void Hyperion::update()
 
 	_raw2ledAdjustment->applyAdjustment(_ledBuffer);
 
-	int i = 0;
-	for (ColorRgb& color : _ledBuffer)
-	{
-		// correct the color byte order
-		switch (_ledStringColorOrder.at(i))
-		{
-		case ColorOrder::ORDER_RGB:
-			// leave as it is
-			break;
-		case ColorOrder::ORDER_BGR:
-			std::swap(color.red, color.blue);
-			break;
-		case ColorOrder::ORDER_RBG:
-			std::swap(color.green, color.blue);
-			break;
-		case ColorOrder::ORDER_GRB:
-			std::swap(color.red, color.green);
-			break;
-		case ColorOrder::ORDER_GBR:
-			std::swap(color.red, color.green);
-			std::swap(color.green, color.blue);
-			break;
-
-		case ColorOrder::ORDER_BRG:
-			std::swap(color.red, color.blue);
-			std::swap(color.green, color.blue);
-			break;
-		}
-		i++;
-	}
-
-	// fill additional hardware LEDs with black
-	if ( _hwLedCount > static_cast<int>(_ledBuffer.size()) )
-	{
-		_ledBuffer.resize(_hwLedCount, ColorRgb::BLACK);
-	}
+	// correct the color byte order and fill additional hardware LEDs with black
+	_colorOrderMap.apply(_ledBuffer, static_cast<size_t>(qMax(_hwLedCount, 0)), _ledOutput);
 
 	// Write the data to the device
 	if (_ledDeviceWrapper->enabled())
 	{
+		// Nothing changed since the last write, the device keeps (and refreshes) the current colors
+		if (_ledOutputValid && priorityInfo.smooth_cfg == _lastSmoothCfg && _ledOutput == _lastLedOutput)
+		{
+			return;
+		}
+		_lastLedOutput = _ledOutput;
+		_lastSmoothCfg = priorityInfo.smooth_cfg;
+		_ledOutputValid = true;
+
 		// Smoothing is disabled
 		if  (! _deviceSmooth->enabled())
 		{
-			//std::cout << "Hyperion::update()> Non-Smoothing - "; LedDevice::printLedValues ( _ledBuffer);
-			emit ledDeviceData(_ledBuffer);
+			//std::cout << "Hyperion::update()> Non-Smoothing - "; LedDevice::printLedValues ( _ledOutput);
+			emit ledDeviceData(_ledOutput);
 		}
 		else
 		{
@@ -648,7 +769,7 @@ void Hyperion::update()
 			// feed smoothing in pause mode to maintain a smooth transition back to smooth mode
 			if (_deviceSmooth->enabled() || _deviceSmooth->pause())
 			{
-				_deviceSmooth->updateLedValues(_ledBuffer);
+				_deviceSmooth->updateLedValues(_ledOutput);
 			}
 		}
 	}
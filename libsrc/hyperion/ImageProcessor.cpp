@@ -1,3 +1,5 @@
+// STL includes
+#include <cstring>
 
 // Hyperion includes
 #include <hyperion/Hyperion.h>
@@ -26,6 +28,23 @@ QString ImageProcessor::mappingTypeToStr(int mappingType)
 	return "multicolor_mean";
 }
 
+// global transform method
+MappingEngine ImageProcessor::mappingEngineFromStr(const QString& mappingEngine)
+{
+	if (mappingEngine == "summed_area" )
+		return SUMMED_AREA;
+
+	return PIXEL_INDEX;
+}
+// global transform method
+QString ImageProcessor::mappingEngineToStr(MappingEngine mappingEngine)
+{
+	if (mappingEngine == SUMMED_AREA )
+		return "summed_area";
+
+	return "pixel_index";
+}
+
 ImageProcessor::ImageProcessor(const LedString& ledString, Hyperion* hyperion)
 	: QObject(hyperion)
 	, _log(Logger::getInstance("BLACKBORDER"))
@@ -35,6 +54,10 @@ ImageProcessor::ImageProcessor(const LedString& ledString, Hyperion* hyperion)
 	, _mappingType(0)
 	, _userMappingType(0)
 	, _hardMappingType(0)
+	, _mappingEngine(PIXEL_INDEX)
+	, _lastImage()
+	, _lastColors()
+	, _lastMappingType(0)
 	, _hyperion(hyperion)
 {
 	// init
@@ -58,6 +81,8 @@ void ImageProcessor::handleSettingsUpdate(settings::type type, const QJsonDocume
 		{
 			setLedMappingType(newType);
 		}
+
+		setLedMappingEngine(mappingEngineFromStr(obj["imageToLedMappingEngine"].toString()));
 	}
 }
 
@@ -70,10 +95,11 @@ void ImageProcessor::setSize(unsigned width, unsigned height)
 	}
 
 	// Clean up the old buffer and mapping
+	clearLastFrame();
 	delete _imageToLeds;
 
 	// Construct a new buffer and mapping
-	_imageToLeds = (width>0 && height>0) ? (new ImageToLedsMap(width, height, 0, 0, _ledString.leds())) : nullptr;
+	_imageToLeds = (width>0 && height>0) ? (new ImageToLedsMap(width, height, 0, 0, _ledString.leds(), _mappingEngine)) : nullptr;
 }
 
 void ImageProcessor::setLedString(const LedString& ledString)
@@ -87,10 +113,35 @@ void ImageProcessor::setLedString(const LedString& ledString)
 		unsigned height = _imageToLeds->height();
 
 		// Clean up the old buffer and mapping
+		clearLastFrame();
 		delete _imageToLeds;
 
 		// Construct a new buffer and mapping
-		_imageToLeds = new ImageToLedsMap(width, height, 0, 0, _ledString.leds());
+		_imageToLeds = new ImageToLedsMap(width, height, 0, 0, _ledString.leds(), _mappingEngine);
+	}
+}
+
+void ImageProcessor::setLedMappingEngine(MappingEngine mappingEngine)
+{
+	if (_mappingEngine == mappingEngine)
+	{
+		return;
+	}
+
+	_mappingEngine = mappingEngine;
+	Debug(_log, "set led mapping engine to %s", QSTRING_CSTR(mappingEngineToStr(mappingEngine)));
+
+	if ( _imageToLeds != nullptr)
+	{
+		// keep the current dimensions and borders, just rebuild the mapping
+		unsigned width = _imageToLeds->width();
+		unsigned height = _imageToLeds->height();
+		unsigned horizontalBorder = _imageToLeds->horizontalBorder();
+		unsigned verticalBorder = _imageToLeds->verticalBorder();
+
+		clearLastFrame();
+		delete _imageToLeds;
+		_imageToLeds = new ImageToLedsMap(width, height, horizontalBorder, verticalBorder, _ledString.leds(), _mappingEngine);
 	}
 }
 
@@ -104,6 +155,35 @@ bool ImageProcessor::blackBorderDetectorEnabled() const
 	return _borderProcessor->enabled();
 }
 
+bool ImageProcessor::isLastFrame(const Image<ColorRgb>& image) const
+{
+	if (_lastColors.empty() || _lastMappingType != _mappingType || !_borderProcessor->isSettled())
+	{
+		return false;
+	}
+
+	if (_lastImage.width() != image.width() || _lastImage.height() != image.height())
+	{
+		return false;
+	}
+
+	// images of the same frame share their pixels, otherwise compare them
+	return _lastImage.memptr() == image.memptr() || std::memcmp(_lastImage.memptr(), image.memptr(), image.size()) == 0;
+}
+
+void ImageProcessor::setLastFrame(const Image<ColorRgb>& image, const std::vector<ColorRgb>& colors)
+{
+	_lastImage = image;
+	_lastColors = colors;
+	_lastMappingType = _mappingType;
+}
+
+void ImageProcessor::clearLastFrame()
+{
+	_lastImage = Image<ColorRgb>();
+	_lastColors.clear();
+}
+
 void ImageProcessor::setLedMappingType(int mapType)
 {
 	// if the _hardMappingType is >-1 we aren't allowed to overwrite it
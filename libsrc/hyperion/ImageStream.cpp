@@ -0,0 +1,107 @@
+#include <hyperion/ImageStream.h>
+#include <hyperion/Hyperion.h>
+
+// Qt includes
+#include <QBuffer>
+#include <QImage>
+#include <QJsonObject>
+#include <QMetaMethod>
+#include <QTimer>
+
+namespace {
+
+/// The defaults of the webConfig settings
+const int DEFAULT_FPS = 10;
+const int DEFAULT_WIDTH = 480;
+
+/// The JPEG quality of the preview
+const int JPEG_QUALITY = 75;
+
+} // namespace
+
+ImageStream::ImageStream(Hyperion* hyperion, const QJsonDocument& config)
+	: QObject()
+	, _hyperion(hyperion)
+	, _log(Logger::getInstance("HYPERION"))
+	, _timer(new QTimer(this))
+	, _maxWidth(DEFAULT_WIDTH)
+	, _image()
+	, _hasNewImage(false)
+	, _active(false)
+{
+	connect(_timer, &QTimer::timeout, this, &ImageStream::encodeImage);
+	handleSettingsUpdate(settings::WEBSERVER, config);
+}
+
+void ImageStream::handleSettingsUpdate(settings::type type, const QJsonDocument& config)
+{
+	if (type == settings::WEBSERVER)
+	{
+		const QJsonObject& obj = config.object();
+		const int fps = qBound(1, obj["imageStreamFps"].toInt(DEFAULT_FPS), 30);
+		_maxWidth = qMax(obj["imageStreamWidth"].toInt(DEFAULT_WIDTH), 16);
+		_timer->setInterval(1000 / fps);
+	}
+}
+
+void ImageStream::subscriptionChanged()
+{
+	const bool subscribed = isSignalConnected(QMetaMethod::fromSignal(&ImageStream::imageEncoded));
+	if (subscribed == _active)
+	{
+		return;
+	}
+	_active = subscribed;
+
+	if (_active)
+	{
+		// the images are only emitted by the instance while somebody is connected
+		connect(_hyperion, &Hyperion::currentImage, this, &ImageStream::handleImage, Qt::UniqueConnection);
+		_timer->start();
+		Debug(_log, "Image stream started, %d ms interval, max. width %d", _timer->interval(), _maxWidth);
+	}
+	else
+	{
+		disconnect(_hyperion, &Hyperion::currentImage, this, &ImageStream::handleImage);
+		_timer->stop();
+		_image = Image<ColorRgb>();
+		_hasNewImage = false;
+		Debug(_log, "Image stream stopped");
+	}
+}
+
+void ImageStream::handleImage(const Image<ColorRgb>& image)
+{
+	// the image data is shared, images between two ticks are replaced without being encoded
+	_image = image;
+	_hasNewImage = true;
+}
+
+void ImageStream::encodeImage()
+{
+	// the last subscriber may have disconnected without notification, e.g. on a closed connection
+	if (!isSignalConnected(QMetaMethod::fromSignal(&ImageStream::imageEncoded)))
+	{
+		subscriptionChanged();
+		return;
+	}
+
+	if (!_hasNewImage)
+	{
+		return;
+	}
+	_hasNewImage = false;
+
+	QImage image(reinterpret_cast<const uchar*>(_image.memptr()), _image.width(), _image.height(), 3 * _image.width(), QImage::Format_RGB888);
+	if (image.width() > _maxWidth)
+	{
+		image = image.scaledToWidth(_maxWidth, Qt::FastTransformation);
+	}
+
+	QByteArray jpeg;
+	QBuffer buffer(&jpeg);
+	buffer.open(QIODevice::WriteOnly);
+	image.save(&buffer, "jpg", JPEG_QUALITY);
+
+	emit imageEncoded(jpeg);
+}
@@ -7,12 +7,19 @@ ImageToLedsMap::ImageToLedsMap(
 		unsigned height,
 		unsigned horizontalBorder,
 		unsigned verticalBorder,
-		const std::vector<Led>& leds)
+		const std::vector<Led>& leds,
+		const MappingEngine engine)
 	: _width(width)
 	, _height(height)
 	, _horizontalBorder(horizontalBorder)
 	, _verticalBorder(verticalBorder)
+	, _engine(engine)
+	, _ledAreas()
 	, _colorsMap()
+	, _summedAreaLayout()
+	, _summedArea()
+	, _frameAnalysis()
+	, _lineBuffer()
 {
 	// Sanity check of the size of the borders (and width and height)
 	Q_ASSERT(_width  > 2*_verticalBorder);
@@ -21,7 +28,7 @@ ImageToLedsMap::ImageToLedsMap(
 	Q_ASSERT(_height < 10000);
 
 	// Reserve enough space in the map for the leds
-	_colorsMap.reserve(leds.size());
+	_ledAreas.reserve(leds.size());
 
 	const unsigned xOffset      = _verticalBorder;
 	const unsigned actualWidth  = _width  - 2 * _verticalBorder;
@@ -33,7 +40,7 @@ ImageToLedsMap::ImageToLedsMap(
 		// skip leds without area
 		if ((led.maxX_frac-led.minX_frac) < 1e-6 || (led.maxY_frac-led.minY_frac) < 1e-6)
 		{
-			_colorsMap.emplace_back();
+			_ledAreas.push_back({0, 0, 0, 0, 0, 0});
 			continue;
 		}
 
@@ -55,23 +62,66 @@ ImageToLedsMap::ImageToLedsMap(
 			maxY_idx++;
 		}
 
-		// Add all the indices in the above defined rectangle to the indices for this led
-		const auto maxYLedCount = qMin(maxY_idx, yOffset+actualHeight);
-		const auto maxXLedCount = qMin(maxX_idx, xOffset+actualWidth);
+		// Clip the area to the image without borders
+		const unsigned maxYLedCount = qMin(maxY_idx, yOffset+actualHeight);
+		const unsigned maxXLedCount = qMin(maxX_idx, xOffset+actualWidth);
 
+		_ledAreas.push_back({minX_idx, qMax(minX_idx, maxXLedCount), minY_idx, qMax(minY_idx, maxYLedCount), 0, 0});
+	}
+
+	// the summed area table holds the rows at the edges of the led areas, only the covered pixels are integrated
+	std::shared_ptr<SummedAreaLayout> layout(new SummedAreaLayout());
+	layout->coveredMinX = _width;
+	layout->coveredMaxX = 0;
+	for (const LedArea& area : _ledAreas)
+	{
+		if (area.minX < area.maxX && area.minY < area.maxY)
+		{
+			layout->tableRows.push_back(area.minY);
+			layout->tableRows.push_back(area.maxY);
+			layout->coveredMinX = qMin(layout->coveredMinX, area.minX);
+			layout->coveredMaxX = qMax(layout->coveredMaxX, area.maxX);
+		}
+	}
+	layout->coveredMinX = qMin(layout->coveredMinX, layout->coveredMaxX);
+
+	std::sort(layout->tableRows.begin(), layout->tableRows.end());
+	layout->tableRows.erase(std::unique(layout->tableRows.begin(), layout->tableRows.end()), layout->tableRows.end());
+	layout->coveredRows.assign(layout->tableRows.empty() ? 0 : layout->tableRows.back(), false);
+
+	for (LedArea& area : _ledAreas)
+	{
+		if (area.minX < area.maxX && area.minY < area.maxY)
+		{
+			std::fill(layout->coveredRows.begin() + area.minY, layout->coveredRows.begin() + area.maxY, true);
+			area.topRow = unsigned(std::lower_bound(layout->tableRows.begin(), layout->tableRows.end(), area.minY) - layout->tableRows.begin());
+			area.bottomRow = unsigned(std::lower_bound(layout->tableRows.begin(), layout->tableRows.end(), area.maxY) - layout->tableRows.begin());
+		}
+	}
+	_summedAreaLayout = layout;
+
+	if (_engine == SUMMED_AREA)
+	{
+		return;
+	}
+
+	// Add all the indices in the above defined rectangles to the indices for each led
+	_colorsMap.reserve(_ledAreas.size());
+	for (const LedArea& area : _ledAreas)
+	{
 		std::vector<unsigned> ledColors;
-		ledColors.reserve((size_t) maxXLedCount*maxYLedCount);
+		ledColors.reserve(static_cast<size_t>(area.maxX - area.minX) * (area.maxY - area.minY));
 
-		for (unsigned y = minY_idx; y < maxYLedCount; ++y)
+		for (unsigned y = area.minY; y < area.maxY; ++y)
 		{
-			for (unsigned x = minX_idx; x < maxXLedCount; ++x)
+			for (unsigned x = area.minX; x < area.maxX; ++x)
 			{
 				ledColors.push_back(y*width + x);
 			}
 		}
 
 		// Add the constructed vector to the map
-		_colorsMap.push_back(ledColors);
+		_colorsMap.push_back(std::move(ledColors));
 	}
 }
 
@@ -84,3 +134,89 @@ unsigned ImageToLedsMap::height() const
 {
 	return _height;
 }
+
+void ImageToLedsMap::getMeanLedColor(const ImageResampler & resampler, const uint8_t * data, int lineLength, PixelFormat pixelFormat, std::vector<ColorRgb> & ledColors) const
+{
+	// Sanity check for the number of leds
+	if(_ledAreas.size() != ledColors.size())
+	{
+		Debug(Logger::getInstance("HYPERION"), "ImageToLedsMap: ledAreas.size != ledColors.size -> %d != %d", _ledAreas.size(), ledColors.size());
+		return;
+	}
+
+	// Integrate the frame once, every led area is then reduced in constant time
+	const uint32_t* summedArea = summedAreaTable(resampler, data, lineLength, pixelFormat);
+
+	auto led = ledColors.begin();
+	for (auto area = _ledAreas.begin(); area != _ledAreas.end(); ++area, ++led)
+	{
+		*led = calcMeanColor(*area, summedArea);
+	}
+}
+
+const uint32_t* ImageToLedsMap::summedAreaTable(const ImageResampler & resampler, const uint8_t * data, int lineLength, PixelFormat pixelFormat) const
+{
+	// convert just the covered part of a line
+	const SummedAreaLayout& layout = *_summedAreaLayout;
+	const int count = static_cast<int>(layout.coveredMaxX - layout.coveredMinX);
+	_lineBuffer.resize(static_cast<size_t>(count));
+
+	ColorRgb* lineBuffer = _lineBuffer.data();
+	FrameAnalysis::integrate(layout, _width, [&](unsigned y) -> const ColorRgb* {
+		resampler.processLine(data, lineLength, pixelFormat, static_cast<int>(y), static_cast<int>(layout.coveredMinX), count, lineBuffer);
+		return lineBuffer;
+	}, _summedArea);
+
+	return _summedArea.data();
+}
+
+void ImageToLedsMap::getUniLedColor(const ImageResampler & resampler, const uint8_t * data, int lineLength, PixelFormat pixelFormat, std::vector<ColorRgb> & ledColors) const
+{
+	// Sanity check for the number of leds
+	if(_ledAreas.size() != ledColors.size())
+	{
+		Debug(Logger::getInstance("HYPERION"), "ImageToLedsMap: ledAreas.size != ledColors.size -> %d != %d", _ledAreas.size(), ledColors.size());
+		return;
+	}
+
+	// calculate uni color over the whole frame
+	const ColorRgb color = calcMeanColor(resampler, data, lineLength, pixelFormat, LedArea{0, _width, 0, _height});
+	std::fill(ledColors.begin(),ledColors.end(), color);
+}
+
+ColorRgb ImageToLedsMap::calcMeanColor(const ImageResampler & resampler, const uint8_t * data, int lineLength, PixelFormat pixelFormat, const LedArea & area) const
+{
+	const unsigned areaWidth = area.maxX - area.minX;
+	const unsigned pixelCount = areaWidth * (area.maxY - area.minY);
+	if (pixelCount == 0)
+	{
+		return ColorRgb::BLACK;
+	}
+
+	// Accumulate the sum of each separate color channel
+	uint_fast32_t cummRed   = 0;
+	uint_fast32_t cummGreen = 0;
+	uint_fast32_t cummBlue  = 0;
+
+	_lineBuffer.resize(areaWidth);
+	for (unsigned y = area.minY; y < area.maxY; ++y)
+	{
+		// convert just the part of the line covered by the led
+		resampler.processLine(data, lineLength, pixelFormat, static_cast<int>(y), static_cast<int>(area.minX), static_cast<int>(areaWidth), _lineBuffer.data());
+
+		for (const ColorRgb& pixel : _lineBuffer)
+		{
+			cummRed   += pixel.red;
+			cummGreen += pixel.green;
+			cummBlue  += pixel.blue;
+		}
+	}
+
+	// Compute the average of each color channel
+	const uint8_t avgRed   = uint8_t(cummRed/pixelCount);
+	const uint8_t avgGreen = uint8_t(cummGreen/pixelCount);
+	const uint8_t avgBlue  = uint8_t(cummBlue/pixelCount);
+
+	// Return the computed color
+	return {avgRed, avgGreen, avgBlue};
+}
@@ -0,0 +1,193 @@
+#include "LedBlender.h"
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define LEDBLENDER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define LEDBLENDER_NEON
+#endif
+
+namespace {
+
+/// The number of bytes blended at once
+const size_t VECTOR_SIZE = 16;
+
+///
+/// x / 255 rounded, exact for x <= 255 * 255
+///
+inline unsigned div255(unsigned x)
+{
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+///
+/// The blending of a single byte, the tail of a loop or the loop without SIMD
+///
+template <PriorityMuxer::BlendMode MODE>
+inline uint8_t blendByte(uint8_t src, uint8_t dest, unsigned opacity)
+{
+	switch (MODE)
+	{
+		case PriorityMuxer::BLEND_ALPHA: return uint8_t(div255(src * opacity + dest * (255 - opacity)));
+		case PriorityMuxer::BLEND_ADD: return uint8_t(std::min(255U, dest + div255(src * opacity)));
+		case PriorityMuxer::BLEND_MAX: return uint8_t(std::max(unsigned(dest), div255(src * opacity)));
+		default: return src;
+	}
+}
+
+#if defined(LEDBLENDER_SSE2)
+
+/// x / 255 rounded per 16 bit lane, see div255()
+inline __m128i div255(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+/// The bytes scaled by the opacity
+inline __m128i scale(__m128i src, __m128i opacity)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = div255(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), opacity));
+	const __m128i hi = div255(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), opacity));
+	return _mm_packus_epi16(lo, hi);
+}
+
+template <PriorityMuxer::BlendMode MODE>
+inline void blendVector(const uint8_t* src, uint8_t* dest, unsigned opacity)
+{
+	const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+	const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest));
+	const __m128i op = _mm_set1_epi16(static_cast<short>(opacity));
+	__m128i result;
+
+	switch (MODE)
+	{
+		case PriorityMuxer::BLEND_ALPHA:
+		{
+			// the products are unsigned, the low 16 bit of the signed multiplication are the same
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i inv = _mm_set1_epi16(static_cast<short>(255 - opacity));
+			const __m128i lo = div255(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), op), _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv)));
+			const __m128i hi = div255(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), op), _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv)));
+			result = _mm_packus_epi16(lo, hi);
+			break;
+		}
+		case PriorityMuxer::BLEND_ADD:
+			result = _mm_adds_epu8(d, opacity == 255 ? s : scale(s, op));
+			break;
+		case PriorityMuxer::BLEND_MAX:
+			result = _mm_max_epu8(d, opacity == 255 ? s : scale(s, op));
+			break;
+		default:
+			result = s;
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), result);
+}
+
+#elif defined(LEDBLENDER_NEON)
+
+/// x / 255 rounded per 16 bit lane and narrowed to bytes, see div255()
+inline uint8x8_t div255(uint16x8_t x)
+{
+	x = vaddq_u16(x, vdupq_n_u16(128));
+	return vshrn_n_u16(vsraq_n_u16(x, x, 8), 8);
+}
+
+/// The bytes scaled by the opacity
+inline uint8x16_t scale(uint8x16_t src, uint8x8_t opacity)
+{
+	return vcombine_u8(div255(vmull_u8(vget_low_u8(src), opacity)), div255(vmull_u8(vget_high_u8(src), opacity)));
+}
+
+template <PriorityMuxer::BlendMode MODE>
+inline void blendVector(const uint8_t* src, uint8_t* dest, unsigned opacity)
+{
+	const uint8x16_t s = vld1q_u8(src);
+	const uint8x16_t d = vld1q_u8(dest);
+	const uint8x8_t op = vdup_n_u8(static_cast<uint8_t>(opacity));
+	uint8x16_t result;
+
+	switch (MODE)
+	{
+		case PriorityMuxer::BLEND_ALPHA:
+		{
+			const uint8x8_t inv = vdup_n_u8(static_cast<uint8_t>(255 - opacity));
+			const uint8x8_t lo = div255(vmlal_u8(vmull_u8(vget_low_u8(s), op), vget_low_u8(d), inv));
+			const uint8x8_t hi = div255(vmlal_u8(vmull_u8(vget_high_u8(s), op), vget_high_u8(d), inv));
+			result = vcombine_u8(lo, hi);
+			break;
+		}
+		case PriorityMuxer::BLEND_ADD:
+			result = vqaddq_u8(d, opacity == 255 ? s : scale(s, op));
+			break;
+		case PriorityMuxer::BLEND_MAX:
+			result = vmaxq_u8(d, opacity == 255 ? s : scale(s, op));
+			break;
+		default:
+			result = s;
+	}
+
+	vst1q_u8(dest, result);
+}
+
+#endif
+
+template <PriorityMuxer::BlendMode MODE>
+void blendBytes(const uint8_t* src, uint8_t* dest, size_t count, unsigned opacity)
+{
+	size_t i = 0;
+#if defined(LEDBLENDER_SSE2) || defined(LEDBLENDER_NEON)
+	for (; i + VECTOR_SIZE <= count; i += VECTOR_SIZE)
+	{
+		blendVector<MODE>(src + i, dest + i, opacity);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		dest[i] = blendByte<MODE>(src[i], dest[i], opacity);
+	}
+}
+
+} // namespace
+
+namespace hyperion {
+
+void blendLedColors(PriorityMuxer::BlendMode blendMode, uint8_t opacity, const std::vector<ColorRgb>& layer, std::vector<ColorRgb>& colors)
+{
+	const size_t count = std::min(layer.size(), colors.size()) * 3;
+	const uint8_t* src = reinterpret_cast<const uint8_t*>(layer.data());
+	uint8_t* dest = reinterpret_cast<uint8_t*>(colors.data());
+
+	if (count == 0 || (opacity == 0 && blendMode != PriorityMuxer::BLEND_NONE))
+	{
+		return;
+	}
+
+	switch (blendMode)
+	{
+		case PriorityMuxer::BLEND_ALPHA:
+			if (opacity == 255)
+				memcpy(dest, src, count);
+			else
+				blendBytes<PriorityMuxer::BLEND_ALPHA>(src, dest, count, opacity);
+			break;
+		case PriorityMuxer::BLEND_ADD:
+			blendBytes<PriorityMuxer::BLEND_ADD>(src, dest, count, opacity);
+			break;
+		case PriorityMuxer::BLEND_MAX:
+			blendBytes<PriorityMuxer::BLEND_MAX>(src, dest, count, opacity);
+			break;
+		default:
+			memcpy(dest, src, count);
+	}
+}
+
+} // namespace hyperion
@@ -0,0 +1,26 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <vector>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+
+// Hyperion includes
+#include <hyperion/PriorityMuxer.h>
+
+namespace hyperion {
+
+///
+/// @brief Blend the led colors of a priority channel onto the led colors of the channels below it. The loops work
+/// on the color bytes and use SSE2 or NEON if available, 16 bytes at once.
+///
+/// @param      blendMode  How the layer is blended, see PriorityMuxer::BlendMode
+/// @param      opacity    The opacity of the layer (0-255)
+/// @param      layer      The led colors of the channel
+/// @param[in,out] colors  The led colors of the channels below, the result. Leds without a layer color are kept
+///
+void blendLedColors(PriorityMuxer::BlendMode blendMode, uint8_t opacity, const std::vector<ColorRgb>& layer, std::vector<ColorRgb>& colors);
+
+} // namespace hyperion
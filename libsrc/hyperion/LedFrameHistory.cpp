@@ -0,0 +1,126 @@
+#include "LedFrameHistory.h"
+
+// STL includes
+#include <algorithm>
+
+namespace {
+
+/// The number of frames preallocated, 500 ms at 60 Hz
+const size_t INITIAL_CAPACITY = 32;
+
+} // namespace
+
+LedFrameHistory::LedFrameHistory()
+	: _ledCount(0)
+	, _capacity(0)
+	, _head(0)
+	, _size(0)
+	, _times()
+	, _colors()
+	, _closedSums()
+{
+}
+
+void LedFrameHistory::clear()
+{
+	_size = 0;
+	std::fill(_closedSums.begin(), _closedSums.end(), 0);
+}
+
+void LedFrameHistory::push(int64_t time, const std::vector<ColorRgb>& colors, int64_t windowStart)
+{
+	if (colors.size() != _ledCount || _capacity == 0)
+	{
+		_ledCount = colors.size();
+		_capacity = INITIAL_CAPACITY;
+		_head = 0;
+		_size = 0;
+		_times.assign(_capacity, 0);
+		_colors.assign(_capacity * _ledCount, ColorRgb::BLACK);
+		_closedSums.assign(3 * _ledCount, 0);
+	}
+
+	evict(windowStart);
+
+	if (_size == _capacity)
+	{
+		grow();
+	}
+
+	// the display time of the previous latest frame ends now
+	if (_size > 0)
+	{
+		accumulate(this->colors(0), time - this->time(0), _closedSums);
+	}
+
+	_head = (_head + 1) % _capacity;
+	_times[_head] = time;
+	std::copy(colors.begin(), colors.end(), _colors.begin() + _head * _ledCount);
+	++_size;
+}
+
+void LedFrameHistory::evict(int64_t windowStart)
+{
+	// the oldest frame is removed, if the next one was shown at the window start already
+	while (_size > 1 && time(_size - 2) < windowStart)
+	{
+		const size_t oldest = _size - 1;
+		accumulate(colors(oldest), time(oldest) - time(oldest - 1), _closedSums);
+		--_size;
+	}
+}
+
+int64_t LedFrameHistory::weightedSums(int64_t now, int64_t windowStart, std::vector<int64_t>& sums)
+{
+	evict(windowStart);
+	sums.assign(_closedSums.begin(), _closedSums.end());
+	if (_size == 0)
+	{
+		return 0;
+	}
+
+	// the latest frame is shown till now
+	const int64_t latest = time(0);
+	accumulate(colors(0), now - std::max(latest, windowStart), sums);
+
+	// the oldest frame is clipped at the window start
+	const size_t oldest = _size - 1;
+	const int64_t oldestStart = time(oldest);
+	if (oldest > 0 && oldestStart < windowStart)
+	{
+		accumulate(colors(oldest), oldestStart - windowStart, sums);
+	}
+
+	return now - std::max(oldestStart, windowStart);
+}
+
+void LedFrameHistory::grow()
+{
+	const size_t capacity = _capacity * 2;
+	std::vector<int64_t> times(capacity, 0);
+	std::vector<ColorRgb> colors(capacity * _ledCount, ColorRgb::BLACK);
+
+	// keep the frames in chronological order at the start of the new buffer
+	for (size_t age = 0; age < _size; ++age)
+	{
+		const size_t target = _size - 1 - age;
+		times[target] = time(age);
+		std::copy(this->colors(age), this->colors(age) + _ledCount, colors.begin() + target * _ledCount);
+	}
+
+	_times.swap(times);
+	_colors.swap(colors);
+	_capacity = capacity;
+	_head = _size - 1;
+}
+
+void LedFrameHistory::accumulate(const ColorRgb* colors, int64_t duration, std::vector<int64_t>& sums) const
+{
+	int64_t* sum = sums.data();
+	for (size_t i = 0; i < _ledCount; ++i, sum += 3)
+	{
+		sum[0] += colors[i].red   * duration;
+		sum[1] += colors[i].green * duration;
+		sum[2] += colors[i].blue  * duration;
+	}
+}
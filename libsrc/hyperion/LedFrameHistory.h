@@ -0,0 +1,92 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+
+///
+/// The LedFrameHistory keeps the led frames received during the smoothing window in a ring buffer.
+/// The colors of all frames are stored in one contiguous buffer next to the array of receive times, so
+/// remembering a frame is a copy into a preallocated slot. The buffer only grows if more frames than
+/// ever before are part of the window.
+///
+/// For linear weighting the history maintains the sum of the colors weighted by the time every frame was
+/// shown. Frames entering and leaving the window update the sum, so the mean of the window is computed in
+/// O(leds) regardless of the number of frames.
+///
+class LedFrameHistory
+{
+public:
+	LedFrameHistory();
+
+	///
+	/// @brief Remove all frames
+	///
+	void clear();
+
+	///
+	/// @brief Remember a frame and remove the frames which ended before the window start.
+	/// The frames are expected in chronological order, a frame with a different number of leds clears the history.
+	///
+	/// @param time         The time the frame was received
+	/// @param colors       The led colors
+	/// @param windowStart  The start of the smoothing window
+	///
+	void push(int64_t time, const std::vector<ColorRgb>& colors, int64_t windowStart);
+
+	///
+	/// @brief Remove the frames which ended before the window start, the last frame before the start is kept
+	/// as it is shown at the window start
+	///
+	void evict(int64_t windowStart);
+
+	/// @return The number of frames
+	size_t size() const { return _size; }
+
+	/// @return The number of leds of every frame
+	size_t ledCount() const { return _ledCount; }
+
+	/// @return The receive time of a frame, age 0 is the latest frame
+	int64_t time(size_t age) const { return _times[slot(age)]; }
+
+	/// @return The led colors of a frame, age 0 is the latest frame
+	const ColorRgb* colors(size_t age) const { return &_colors[slot(age) * _ledCount]; }
+
+	///
+	/// @brief Sum of the color components of all frames weighted by the time (in microseconds) each frame
+	/// was shown within the window [windowStart, now]. Frames are removed as in evict().
+	///
+	/// @param      now          The end of the window
+	/// @param      windowStart  The start of the window
+	/// @param[out] sums         The weighted red, green and blue sums of every led
+	///
+	/// @return The time covered by frames, less than the window size if the history is shorter than the window
+	///
+	int64_t weightedSums(int64_t now, int64_t windowStart, std::vector<int64_t>& sums);
+
+private:
+	/// The buffer slot of a frame
+	size_t slot(size_t age) const { return (_head + _capacity - age) % _capacity; }
+
+	/// Double the capacity, keeping the frames
+	void grow();
+
+	/// Add the colors of a frame weighted by the duration, a negative duration removes them
+	void accumulate(const ColorRgb* colors, int64_t duration, std::vector<int64_t>& sums) const;
+
+	size_t _ledCount;
+	size_t _capacity;
+	/// The slot of the latest frame
+	size_t _head;
+	size_t _size;
+
+	std::vector<int64_t> _times;
+	std::vector<ColorRgb> _colors;
+
+	/// The colors weighted by their display time of all frames except the latest one, whose display time is still open
+	std::vector<int64_t> _closedSums;
+};
@@ -1,13 +1,13 @@
 // Qt includes
 #include <QDateTime>
-#include <QTimer>
 
 #include "LinearColorSmoothing.h"
+#include "SmoothingThread.h"
+#include "SmoothingKernel.h"
 #include <hyperion/Hyperion.h>
 
 #include <cmath>
 #include <chrono>
-#include <thread>
 
 /// The number of microseconds per millisecond = 1000.
 const int64_t MS_PER_MICRO = 1000;
@@ -39,22 +39,43 @@ const char* SETTINGS_KEY_INTERPOLATION_RATE = "interpolationRate";
 const char* SETTINGS_KEY_OUTPUT_RATE = "outputRate";
 const char* SETTINGS_KEY_DITHERING = "dithering";
 const char* SETTINGS_KEY_DECAY = "decay";
+const char* SETTINGS_KEY_REALTIME_PRIORITY = "realtimePriority";
+const char* SETTINGS_KEY_CPU_AFFINITY = "cpuAffinity";
 
 using namespace hyperion;
 
+namespace {
+
+/// The name of the smoothing type for the log
+const char* smoothingTypeName(SmoothingType type)
+{
+	switch (type)
+	{
+	case Decay:       return "decay";
+	case Exponential: return "exponential";
+	case Spring:      return "spring";
+	case Kalman:      return "kalman";
+	case Linear:
+	default:          return "linear";
+	}
+}
+
+} // namespace
+
 const int64_t DEFAUL_SETTLINGTIME = 200;													// settlingtime in ms
 const int DEFAUL_UPDATEFREQUENCY = 25;													// updatefrequncy in hz
 
-constexpr std::chrono::milliseconds DEFAUL_UPDATEINTERVALL{1000/ DEFAUL_UPDATEFREQUENCY};
+constexpr std::chrono::microseconds DEFAUL_UPDATEINTERVALL{1000000/ DEFAUL_UPDATEFREQUENCY};
 const unsigned DEFAUL_OUTPUTDEPLAY = 0;														// outputdelay in ms
 
 LinearColorSmoothing::LinearColorSmoothing(const QJsonDocument &config, Hyperion *hyperion)
 	: QObject(hyperion)
 	, _log(Logger::getInstance("SMOOTHING"))
 	, _hyperion(hyperion)
-	, _updateInterval(DEFAUL_UPDATEINTERVALL.count())
+	, _updateIntervalMicros(DEFAUL_UPDATEINTERVALL.count())
 	, _settlingTime(DEFAUL_SETTLINGTIME)
-	, _timer(new QTimer(this))
+	, _thread(new SmoothingThread([this]() { updateLeds(); }, _log))
+	, _mutex(QMutex::Recursive)
 	, _outputDelay(DEFAUL_OUTPUTDEPLAY)
 	, _smoothingType(SmoothingType::Linear)
 	, _writeToLedsEnable(false)
@@ -63,6 +84,8 @@ LinearColorSmoothing::LinearColorSmoothing(const QJsonDocument &config, Hyperion
 	, _currentConfigId(0)
 	, _enabled(false)
 	, tempValues(std::vector<uint64_t>(0, 0L))
+	, _kernel(nullptr)
+	, _linearDecay(true)
 {
 	// init cfg 0 (default)
 	addConfig(DEFAUL_SETTLINGTIME, DEFAUL_UPDATEFREQUENCY, DEFAUL_OUTPUTDEPLAY);
@@ -70,21 +93,29 @@ LinearColorSmoothing::LinearColorSmoothing(const QJsonDocument &config, Hyperion
 	selectConfig(0, true);
 
 	// add pause on cfg 1
-	SMOOTHING_CFG cfg = {SmoothingType::Linear, false, 0, 0, 0, 0, 0, false, 1};
+	SMOOTHING_CFG cfg = {SmoothingType::Linear, false, 0, DEFAUL_UPDATEINTERVALL.count(), 0, 0, 0, false, 1};
 	_cfgList.append(cfg);
 
 	// listen for comp changes
 	connect(_hyperion, &Hyperion::compStateChangeRequest, this, &LinearColorSmoothing::componentStateChange);
 	// timer
-	connect(_timer, &QTimer::timeout, this, &LinearColorSmoothing::updateLeds);
+	_thread->start();
 
 	//Debug(_log, "LinearColorSmoothing sizeof floatT == %d", (sizeof(floatT)));
 }
 
+LinearColorSmoothing::~LinearColorSmoothing()
+{
+	delete _thread;
+	delete _kernel;
+}
+
 void LinearColorSmoothing::handleSettingsUpdate(settings::type type, const QJsonDocument &config)
 {
 	if (type == settings::SMOOTHING)
 	{
+		QMutexLocker locker(&_mutex);
+
 		//	std::cout << "LinearColorSmoothing::handleSettingsUpdate" << std::endl;
 		//	std::cout << config.toJson().toStdString() << std::endl;
 
@@ -96,26 +127,21 @@ void LinearColorSmoothing::handleSettingsUpdate(settings::type type, const QJson
 
 		_continuousOutput = obj["continuousOutput"].toBool(true);
 
-		SMOOTHING_CFG cfg = {SmoothingType::Linear,true, 0, 0, 0, 0, 0, false, 1};
-
-		const QString typeString = obj[SETTINGS_KEY_SMOOTHING_TYPE].toString();
+		_thread->setScheduling(obj[SETTINGS_KEY_REALTIME_PRIORITY].toInt(0), obj[SETTINGS_KEY_CPU_AFFINITY].toInt(-1));
 
-		if(typeString == "linear") {
-			cfg.smoothingType = SmoothingType::Linear;
-		} else if(typeString == "decay") {
-			cfg.smoothingType = SmoothingType::Decay;
-		}
+		SMOOTHING_CFG cfg = {SmoothingType::Linear,true, 0, 0, 0, 0, 0, false, 1};
 
+		cfg.smoothingType = smoothingTypeFromString(obj[SETTINGS_KEY_SMOOTHING_TYPE].toString());
 		cfg.pause = false;
 		cfg.settlingTime = static_cast<int64_t>(obj["time_ms"].toInt(DEFAUL_SETTLINGTIME));
-		cfg.updateInterval = static_cast<int>(1000.0 / obj["updateFrequency"].toDouble(DEFAUL_UPDATEFREQUENCY));
+		cfg.updateIntervalMicros = static_cast<int64_t>(1000000.0 / obj["updateFrequency"].toDouble(DEFAUL_UPDATEFREQUENCY));
 		cfg.outputRate = obj[SETTINGS_KEY_OUTPUT_RATE].toDouble(DEFAUL_UPDATEFREQUENCY);
 		cfg.interpolationRate = obj[SETTINGS_KEY_INTERPOLATION_RATE].toDouble(DEFAUL_UPDATEFREQUENCY);
 		cfg.outputDelay = static_cast<unsigned>(obj["updateDelay"].toInt(DEFAUL_OUTPUTDEPLAY));
 		cfg.dithering = obj[SETTINGS_KEY_DITHERING].toBool(false);
 		cfg.decay = obj[SETTINGS_KEY_DECAY].toDouble(1.0);
 
-		//Debug( _log, "smoothing cfg_id %d: pause: %d bool, settlingTime: %d ms, interval: %d ms (%u Hz), updateDelay: %u frames",  _currentConfigId, cfg.pause, cfg.settlingTime, cfg.updateInterval, unsigned(1000.0/cfg.updateInterval), cfg.outputDelay );
+		//Debug( _log, "smoothing cfg_id %d: pause: %d bool, settlingTime: %d ms, interval: %d us, updateDelay: %u frames",  _currentConfigId, cfg.pause, cfg.settlingTime, cfg.updateIntervalMicros, cfg.outputDelay );
 		_cfgList[0] = cfg;
 
 		// if current id is 0, we need to apply the settings (forced)
@@ -146,8 +172,17 @@ int LinearColorSmoothing::write(const std::vector<ColorRgb> &ledValues)
 		_previousValues = ledValues;
 		_previousInterpolationTime = micros();
 
-		//Debug( _log, "Start Smoothing timer: settlingTime: %d ms, interval: %d ms (%u Hz), updateDelay: %u frames", _settlingTime, _updateInterval, unsigned(1000.0/_updateInterval), _outputDelay );
-		QMetaObject::invokeMethod(_timer, "start", Qt::QueuedConnection, Q_ARG(int, _updateInterval));
+		if (_kernel != nullptr)
+		{
+			_kernel->reset(ledValues);
+		}
+
+		//Debug( _log, "Start Smoothing timer: settlingTime: %d ms, interval: %d us, updateDelay: %u frames", _settlingTime, _updateIntervalMicros, _outputDelay );
+		_thread->startTimer(_updateIntervalMicros);
+	}
+	else if (_kernel != nullptr)
+	{
+		_kernel->setTarget(ledValues);
 	}
 
 	return 0;
@@ -155,6 +190,8 @@ int LinearColorSmoothing::write(const std::vector<ColorRgb> &ledValues)
 
 int LinearColorSmoothing::updateLedValues(const std::vector<ColorRgb> &ledValues)
 {
+	QMutexLocker locker(&_mutex);
+
 	int retval = 0;
 	if (!_enabled)
 	{
@@ -191,6 +228,12 @@ void LinearColorSmoothing::writeDirect()
 	_previousValues = _targetValues;
 	_previousWriteTime = now;
 
+	// the filter continues from the target without a transition
+	if (_kernel != nullptr)
+	{
+		_kernel->reset(_targetValues);
+	}
+
 	queueColors(_previousValues);
 	_writeToLedsEnable = _continuousOutput;
 }
@@ -207,7 +250,7 @@ void LinearColorSmoothing::writeFrame()
 
 ALWAYS_INLINE int64_t LinearColorSmoothing::micros() const
 {
-	const auto now = std::chrono::high_resolution_clock::now();
+	const auto now = std::chrono::steady_clock::now();
 	return (std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch())).count();
 }
 
@@ -271,13 +314,11 @@ void LinearColorSmoothing::assembleFrame()
 	}
 }
 
-ALWAYS_INLINE void LinearColorSmoothing::aggregateComponents(const std::vector<ColorRgb>& colors, std::vector<uint64_t>& weighted, const floatT weight) {
+ALWAYS_INLINE void LinearColorSmoothing::aggregateComponents(const ColorRgb* colors, size_t count, std::vector<uint64_t>& weighted, const floatT weight) {
 	// Determine the integer-scale by converting the weight to fixed point
 	const uint64_t scale = (static_cast<uint64_t>(1L)<<FPShift) * static_cast<double>(weight);
 
-	const size_t N = colors.size();
-
-	for (size_t i = 0; i < N; ++i)
+	for (size_t i = 0; i < count; ++i)
 	{
 		const ColorRgb &color = colors[i];
 
@@ -302,31 +343,51 @@ void LinearColorSmoothing::interpolateFrame()
 
 	intitializeComponentVectors(N);
 
+	/// Time where the current window has started
+	const int64_t windowStart = now - (MS_PER_MICRO * _settlingTime);
+
+	// The frames of the history have the same number of leds as the target, a changed led count resets the history
+	const size_t count = std::min(N, _frameHistory.ledCount());
+
+	if (_linearDecay)
+	{
+		// The frames are weighted by their display time, the history keeps the running sums of the window
+		_frameHistory.weightedSums(now, windowStart, _weightedSums);
+
+		// Normalize to the window, missing frames at the start of the window count as black
+		const floatT inv_time = 1.0F / std::max(now - windowStart, static_cast<int64_t>(1));
+
+		for (size_t i = 0; i < 3 * count; ++i)
+		{
+			meanValues[i] = _weightedSums[i] * inv_time;
+		}
+
+		_previousInterpolationTime = now;
+		return;
+	}
+
 	/// Time where the frame has been shown
 	int64_t frameStart;
 
 	/// Time where the frame display would have ended
 	int64_t frameEnd = now;
 
-	/// Time where the current window has started
-	const int64_t windowStart = now - (MS_PER_MICRO * _settlingTime);
-
 	/// The total weight of the frames that were included in our window; sum of the individual weights
 	floatT fs = 0.0F;
 
 	// To calculate the mean component we iterate over all relevant frames;
 	// from the most recent to the oldest frame that still clips our moving-average window given by time (now)
-	for (auto it = _frameQueue.rbegin(); it != _frameQueue.rend() && frameEnd > windowStart; ++it)
+	for (size_t age = 0; age < _frameHistory.size() && frameEnd > windowStart; ++age)
 	{
 		// Starting time of a frame in the window is clipped to the window start
-		frameStart = std::max(windowStart, it->time);
+		frameStart = std::max(windowStart, _frameHistory.time(age));
 
 		// Weight the current frame relative to the overall window based on start and end times
 		const floatT weight = _weightFrame(frameStart, frameEnd, windowStart);
 		fs += weight;
 
 		// Aggregate the RGB components of this frame's LED colors using the individual weighting
-		aggregateComponents(it->colors, tempValues, weight);
+		aggregateComponents(_frameHistory.colors(age), count, tempValues, weight);
 
 		// The previous (earlier) frame display has ended when the current frame stared to show,
 		// so we can use this as the frame-end time for next iteration
@@ -337,7 +398,7 @@ void LinearColorSmoothing::interpolateFrame()
 	const floatT inv_fs = ((fs < 1.0F) ? 1.0F : 1.0F / fs) / (1 << SmallShiftBis);
 
 	// Normalize the mean component values for the window (fs)
-	for (size_t i = 0; i < 3 * N; ++i)
+	for (size_t i = 0; i < 3 * count; ++i)
 	{
 		meanValues[i] = (tempValues[i] >> FPShiftSmall) * inv_fs;
 	}
@@ -382,22 +443,6 @@ void LinearColorSmoothing::performDecay(const int64_t now) {
 		++_renderedCounter;
 	}
 
-	// Check for sleep when no operation is pending.
-	// As our QTimer is not capable of sub 1ms timing but instead performs spinning -
-	// we have to do µsec-sleep to free CPU time; otherwise the thread would consume 100% CPU time.
-	if(_updateInterval <= 0 && !(interpolatePending || writePending)) {
-		const int64_t nextActionExpected = std::min(interpolationTarget, writeTarget);
-		const int64_t microsTillNextAction = nextActionExpected - now;
-		const int64_t SLEEP_MAX_MICROS = 1000L; // We want to use usleep for up to 1ms
-		const int64_t SLEEP_RES_MICROS = 100L; // Expected resolution is >= 100µs on stock linux
-
-		if(microsTillNextAction > SLEEP_RES_MICROS) {
-			const int64_t wait = std::min(microsTillNextAction - SLEEP_RES_MICROS, SLEEP_MAX_MICROS);
-			//usleep(wait);
-			std::this_thread::sleep_for(std::chrono::microseconds(wait));
-		}
-	}
-
 	// Write stats every 30 sec
 	if ((now > (_renderedStatTime + 30 * 1000000)) && (_renderedCounter > _renderedStatCounter))
 	{
@@ -436,8 +481,22 @@ void LinearColorSmoothing::performLinear(const int64_t now) {
 	writeFrame();
 }
 
+void LinearColorSmoothing::performKernel(const int64_t now) {
+	_kernel->step(now - _previousWriteTime, _previousValues);
+
+	writeFrame();
+}
+
 void LinearColorSmoothing::updateLeds()
 {
+	QMutexLocker locker(&_mutex);
+
+	// the timer was stopped, while this call was pending
+	if (_targetValues.empty())
+	{
+		return;
+	}
+
 	const int64_t now = micros();
 	const int64_t deltaTime = _targetTime - now;
 
@@ -454,6 +513,12 @@ void LinearColorSmoothing::updateLeds()
 		performDecay(now);
 		break;
 
+	case Exponential:
+	case Spring:
+	case Kalman:
+		performKernel(now);
+		break;
+
 	case Linear:
 		// Linear interpolation is default
 	default:
@@ -464,38 +529,16 @@ void LinearColorSmoothing::updateLeds()
 
 void LinearColorSmoothing::rememberFrame(const std::vector<ColorRgb> &ledColors)
 {
-	//Debug(_log, "rememberFrame -  before _frameQueue.size() [%d]", _frameQueue.size());
-
 	const int64_t now = micros();
 
-	// Maintain the queue by removing outdated frames
-	const int64_t windowStart = now - (MS_PER_MICRO * _settlingTime);
-
-	int p = -1; // Start with -1 instead of 0, so we keep the last frame at least partially clipping the window
-
-	// As the frames are ordered chronologically we scan from the front (oldest) till we find the first fresh frame
-	for (auto it = _frameQueue.begin(); it != _frameQueue.end() && it->time < windowStart; ++it)
-	{
-		++p;
-	}
-
-	if (p > 0)
-	{
-		//Debug(_log, "rememberFrame -  erasing %d frames", p);
-		_frameQueue.erase(_frameQueue.begin(), _frameQueue.begin() + p);
-	}
-
-	// Append the latest frame at back of the queue
-	const REMEMBERED_FRAME frame = REMEMBERED_FRAME(now, ledColors);
-	_frameQueue.push_back(frame);
-
-	//Debug(_log, "rememberFrame -  after _frameQueue.size() [%d]", _frameQueue.size());
+	// Append the latest frame and remove the outdated ones, the last frame at least partially clipping the window is kept
+	_frameHistory.push(now, ledColors, now - (MS_PER_MICRO * _settlingTime));
 }
 
 
 void LinearColorSmoothing::clearRememberedFrames()
 {
-	_frameQueue.clear();
+	_frameHistory.clear();
 
 	_ledCount = 0;
 	meanValues.clear();
@@ -542,7 +585,7 @@ void LinearColorSmoothing::queueColors(const std::vector<ColorRgb> &ledColors)
 
 void LinearColorSmoothing::clearQueuedColors()
 {
-	QMetaObject::invokeMethod(_timer, "stop", Qt::QueuedConnection);
+	_thread->stopTimer();
 	_previousValues.clear();
 
 	_targetValues.clear();
@@ -552,6 +595,8 @@ void LinearColorSmoothing::clearQueuedColors()
 
 void LinearColorSmoothing::componentStateChange(hyperion::Components component, bool state)
 {
+	QMutexLocker locker(&_mutex);
+
 	_writeToLedsEnable = state;
 	if (component == hyperion::COMP_LEDDEVICE)
 	{
@@ -566,10 +611,13 @@ void LinearColorSmoothing::componentStateChange(hyperion::Components component,
 
 void LinearColorSmoothing::setEnable(bool enable)
 {
-	_enabled = enable;
-	if (!_enabled)
 	{
-		clearQueuedColors();
+		QMutexLocker locker(&_mutex);
+		_enabled = enable;
+		if (!_enabled)
+		{
+			clearQueuedColors();
+		}
 	}
 	// update comp register
 	_hyperion->setNewComponentState(hyperion::COMP_SMOOTHING, enable);
@@ -577,16 +625,19 @@ void LinearColorSmoothing::setEnable(bool enable)
 
 void LinearColorSmoothing::setPause(bool pause)
 {
+	QMutexLocker locker(&_mutex);
 	_pause = pause;
 }
 
-unsigned LinearColorSmoothing::addConfig(int settlingTime_ms, double ledUpdateFrequency_hz, unsigned updateDelay)
+unsigned LinearColorSmoothing::addConfig(int settlingTime_ms, double ledUpdateFrequency_hz, unsigned updateDelay, SmoothingType smoothingType)
 {
+	QMutexLocker locker(&_mutex);
+
 	SMOOTHING_CFG cfg = {
-		SmoothingType::Linear,
+		smoothingType,
 		false,
 		settlingTime_ms,
-		static_cast<int>(1000.0 / ledUpdateFrequency_hz),
+		static_cast<int64_t>(1000000.0 / ledUpdateFrequency_hz),
 		ledUpdateFrequency_hz,
 		ledUpdateFrequency_hz,
 		updateDelay,
@@ -595,20 +646,22 @@ unsigned LinearColorSmoothing::addConfig(int settlingTime_ms, double ledUpdateFr
 	};
 	_cfgList.append(cfg);
 
-	//Debug( _log, "smoothing cfg %d: pause: %d bool, settlingTime: %d ms, interval: %d ms (%u Hz), updateDelay: %u frames",  _cfgList.count()-1, cfg.pause, cfg.settlingTime, cfg.updateInterval, unsigned(1000.0/cfg.updateInterval), cfg.outputDelay );
+	//Debug( _log, "smoothing cfg %d: pause: %d bool, settlingTime: %d ms, interval: %d us, updateDelay: %u frames",  _cfgList.count()-1, cfg.pause, cfg.settlingTime, cfg.updateIntervalMicros, cfg.outputDelay );
 	return _cfgList.count() - 1;
 }
 
-unsigned LinearColorSmoothing::updateConfig(unsigned cfgID, int settlingTime_ms, double ledUpdateFrequency_hz, unsigned updateDelay)
+unsigned LinearColorSmoothing::updateConfig(unsigned cfgID, int settlingTime_ms, double ledUpdateFrequency_hz, unsigned updateDelay, SmoothingType smoothingType)
 {
+	QMutexLocker locker(&_mutex);
+
 	unsigned updatedCfgID = cfgID;
 	if (cfgID < static_cast<unsigned>(_cfgList.count()))
 	{
 		SMOOTHING_CFG cfg = {
-			SmoothingType::Linear,
+			smoothingType,
 			false,
 			settlingTime_ms,
-			static_cast<int>(1000.0 / ledUpdateFrequency_hz),
+			static_cast<int64_t>(1000000.0 / ledUpdateFrequency_hz),
 			ledUpdateFrequency_hz,
 			ledUpdateFrequency_hz,
 			updateDelay,
@@ -618,7 +671,7 @@ unsigned LinearColorSmoothing::updateConfig(unsigned cfgID, int settlingTime_ms,
 	}
 	else
 	{
-		updatedCfgID = addConfig(settlingTime_ms, ledUpdateFrequency_hz, updateDelay);
+		updatedCfgID = addConfig(settlingTime_ms, ledUpdateFrequency_hz, updateDelay, smoothingType);
 	}
 	//	Debug( _log, "smoothing updatedCfgID %u: settlingTime: %d ms, "
 	//				 "interval: %d ms (%u Hz), updateDelay: %u frames",  cfgID, _settlingTime, int64_t(1000.0/ledUpdateFrequency_hz), unsigned(ledUpdateFrequency_hz), updateDelay );
@@ -627,10 +680,12 @@ unsigned LinearColorSmoothing::updateConfig(unsigned cfgID, int settlingTime_ms,
 
 bool LinearColorSmoothing::selectConfig(unsigned cfg, bool force)
 {
+	QMutexLocker locker(&_mutex);
+
 	if (_currentConfigId == cfg && !force)
 	{
 		//Debug( _log, "selectConfig SAME as before, not FORCED - _currentConfigId [%u], force [%d]", cfg, force);
-		//Debug( _log, "current smoothing cfg: %d, settlingTime: %d ms, interval: %d ms (%u Hz), updateDelay: %u frames",  _currentConfigId, _settlingTime, _updateInterval, unsigned(1000.0/_updateInterval), _outputDelay );
+		//Debug( _log, "current smoothing cfg: %d, settlingTime: %d ms, interval: %d us, updateDelay: %u frames",  _currentConfigId, _settlingTime, _updateIntervalMicros, _outputDelay );
 		return true;
 	}
 
@@ -654,7 +709,8 @@ bool LinearColorSmoothing::selectConfig(unsigned cfg, bool force)
 		const floatT inv_window = _invWindow;
 
 		// For decay != 1 use power-based approach for calculating the moving average values
-		if(std::abs(decay - 1.0F) > std::numeric_limits<float>::epsilon()) {
+		_linearDecay = std::abs(decay - 1.0F) <= std::numeric_limits<float>::epsilon();
+		if(!_linearDecay) {
 			// Exponential Decay
 			_weightFrame = [inv_window,decay](const int64_t fs, const int64_t fe, const int64_t ws) {
 				const floatT s = (fs - ws) * inv_window;
@@ -671,21 +727,44 @@ bool LinearColorSmoothing::selectConfig(unsigned cfg, bool force)
 			};
 		}
 
+		// The filter kernel continues from the current colors
+		delete _kernel;
+		switch (_smoothingType)
+		{
+		case Exponential:
+			_kernel = new ExponentialKernel(_settlingTime);
+			break;
+		case Spring:
+			_kernel = new SpringKernel(_settlingTime);
+			break;
+		case Kalman:
+			_kernel = new KalmanKernel(_settlingTime);
+			break;
+		default:
+			_kernel = nullptr;
+			break;
+		}
+		if (_kernel != nullptr && !_previousValues.empty())
+		{
+			_kernel->reset(_previousValues);
+			_kernel->setTarget(_targetValues);
+		}
+
 		_renderedStatTime = micros();
 		_renderedCounter = 0;
 		_renderedStatCounter = 0;
 		_interpolationCounter = 0;
 		_interpolationStatCounter = 0;
 
-		if (_cfgList[cfg].updateInterval != _updateInterval)
+		if (_cfgList[cfg].updateIntervalMicros != _updateIntervalMicros)
 		{
 
-			QMetaObject::invokeMethod(_timer, "stop", Qt::QueuedConnection);
-			_updateInterval = _cfgList[cfg].updateInterval;
+			_thread->stopTimer();
+			_updateIntervalMicros = _cfgList[cfg].updateIntervalMicros;
 			if (this->enabled() && this->_writeToLedsEnable)
 			{
-				//Debug( _log, "_cfgList[cfg].updateInterval != _updateInterval - Restart timer - _updateInterval [%d]", _updateInterval);
-				QMetaObject::invokeMethod(_timer, "start", Qt::QueuedConnection, Q_ARG(int, _updateInterval));
+				//Debug( _log, "_cfgList[cfg].updateIntervalMicros != _updateIntervalMicros - Restart timer - _updateIntervalMicros [%d]", _updateIntervalMicros);
+				_thread->startTimer(_updateIntervalMicros);
 			}
 			else
 			{
@@ -693,12 +772,12 @@ bool LinearColorSmoothing::selectConfig(unsigned cfg, bool force)
 			}
 		}
 		_currentConfigId = cfg;
-		// Debug( _log, "current smoothing cfg: %d, settlingTime: %d ms, interval: %d ms (%u Hz), updateDelay: %u frames",  _currentConfigId, _settlingTime, _updateInterval, unsigned(1000.0/_updateInterval), _outputDelay );
-		//	DebugIf( enabled() && !_pause, _log, "set smoothing cfg: %u settlingTime: %d ms, interval: %d ms,  updateDelay: %u frames",  _currentConfigId, _settlingTime, _updateInterval,  _outputDelay );
+		// Debug( _log, "current smoothing cfg: %d, settlingTime: %d ms, interval: %d us, updateDelay: %u frames",  _currentConfigId, _settlingTime, _updateIntervalMicros, _outputDelay );
+		//	DebugIf( enabled() && !_pause, _log, "set smoothing cfg: %u settlingTime: %d ms, interval: %d us,  updateDelay: %u frames",  _currentConfigId, _settlingTime, _updateIntervalMicros,  _outputDelay );
 		// DebugIf( _pause, _log, "set smoothing cfg: %d, pause",  _currentConfigId );
 
 		const float thalf = (1.0-std::pow(1.0/2, 1.0/_decay))*_settlingTime;
-		Debug( _log, "cfg [%d]:  Type: %s - Time: %d ms, outputRate %f Hz, interpolationRate: %f Hz, timer: %d ms, Dithering: %d, Decay: %f -> HalfTime: %f ms", cfg, _smoothingType == SmoothingType::Decay ? "decay" : "linear", _settlingTime, _outputRate, _interpolationRate, _updateInterval, _dithering ? 1 : 0, _decay, thalf);
+		Debug( _log, "cfg [%d]:  Type: %s - Time: %d ms, outputRate %f Hz, interpolationRate: %f Hz, timer: %f ms, Dithering: %d, Decay: %f -> HalfTime: %f ms", cfg, smoothingTypeName(_smoothingType), _settlingTime, _outputRate, _interpolationRate, _updateIntervalMicros / 1000.0, _dithering ? 1 : 0, _decay, thalf);
 
 		return true;
 	}
@@ -707,3 +786,37 @@ bool LinearColorSmoothing::selectConfig(unsigned cfg, bool force)
 	_currentConfigId = 0;
 	return false;
 }
+
+SmoothingType LinearColorSmoothing::smoothingTypeFromString(const QString &name)
+{
+	if (name == "decay")
+	{
+		return SmoothingType::Decay;
+	}
+	if (name == "exponential")
+	{
+		return SmoothingType::Exponential;
+	}
+	if (name == "spring")
+	{
+		return SmoothingType::Spring;
+	}
+	if (name == "kalman")
+	{
+		return SmoothingType::Kalman;
+	}
+	return SmoothingType::Linear;
+}
+
+QJsonObject LinearColorSmoothing::getStatistics() const
+{
+	const SmoothingThread::Statistics statistics = _thread->getStatistics();
+
+	QJsonObject obj;
+	obj["frames"] = static_cast<double>(statistics.frames);
+	obj["lateFrames"] = static_cast<double>(statistics.lateFrames);
+	obj["skippedFrames"] = static_cast<double>(statistics.skippedFrames);
+	obj["meanJitterMicros"] = statistics.meanJitterMicros;
+	obj["maxJitterMicros"] = static_cast<double>(statistics.maxJitterMicros);
+	return obj;
+}
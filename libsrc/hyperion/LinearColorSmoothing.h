@@ -6,10 +6,13 @@
 
 // Qt includes
 #include <QVector>
+#include <QMutex>
+#include <QJsonObject>
 
 // hyperion includes
 #include <leddevice/LedDevice.h>
 #include <utils/Components.h>
+#include "LedFrameHistory.h"
 
 // settings
 #include <utils/settings.h>
@@ -17,9 +20,10 @@
 // The type of float
 #define floatT float // Select double, float or __fp16
 
-class QTimer;
 class Logger;
 class Hyperion;
+class SmoothingThread;
+class SmoothingKernel;
 
 /// The type of smoothing to perform
 enum SmoothingType {
@@ -28,6 +32,15 @@ enum SmoothingType {
 
 	/// Decay based smoothing algorithm
 	Decay,
+
+	/// Exponential moving average (SmoothingKernel)
+	Exponential,
+
+	/// Critically damped spring (SmoothingKernel)
+	Spring,
+
+	/// Kalman filter per color channel (SmoothingKernel)
+	Kalman,
 };
 
 /// Linear Smoothing class
@@ -68,6 +81,12 @@ enum SmoothingType {
 ///           the average color values to the 8-bit RGB resolution of the LED-device. Effectively,
 ///           this performs diffusion of the residual errors across multiple egress frames.
 ///
+///  - Exponential, Spring, Kalman: Filters which move the colors towards the target colors with a state per
+///           color channel (see SmoothingKernel). They are cheaper than the decay smoothing and suited for high
+///           update frequencies on small devices.
+///
+/// The smoothing runs on its own thread (see SmoothingThread), which writes to the device at absolute
+/// deadlines independent of the load of the Hyperion instance thread.
 ///
 
 class LinearColorSmoothing : public QObject
@@ -80,6 +99,7 @@ public:
 	/// @param hyperion  The hyperion parent instance
 	///
 	LinearColorSmoothing(const QJsonDocument &config, Hyperion *hyperion);
+	~LinearColorSmoothing() override;
 
 	/// LED values as input for the smoothing filter
 	///
@@ -98,10 +118,11 @@ public:
 	/// @param   settlingTime_ms       The buffer time
 	/// @param   ledUpdateFrequency_hz The frequency of update
 	/// @param   updateDelay           The delay
+	/// @param   smoothingType         The type of smoothing
 	///
 	/// @return The index of the configuration, which can be passed to selectConfig()
 	///
-	unsigned addConfig(int settlingTime_ms, double ledUpdateFrequency_hz = 25.0, unsigned updateDelay = 0);
+	unsigned addConfig(int settlingTime_ms, double ledUpdateFrequency_hz = 25.0, unsigned updateDelay = 0, SmoothingType smoothingType = SmoothingType::Linear);
 
 	///
 	/// @brief Update a smoothing cfg which can be used with selectConfig()
@@ -111,10 +132,11 @@ public:
 	/// @param   settlingTime_ms       The buffer time
 	/// @param   ledUpdateFrequency_hz The frequency of update
 	/// @param   updateDelay           The delay
+	/// @param   smoothingType         The type of smoothing
 	///
 	/// @return The index of the configuration, which can be passed to selectConfig()
 	///
-	unsigned updateConfig(unsigned cfgID, int settlingTime_ms, double ledUpdateFrequency_hz = 25.0, unsigned updateDelay = 0);
+	unsigned updateConfig(unsigned cfgID, int settlingTime_ms, double ledUpdateFrequency_hz = 25.0, unsigned updateDelay = 0, SmoothingType smoothingType = SmoothingType::Linear);
 
 	///
 	/// @brief select a smoothing configuration given by cfg index from addConfig()
@@ -125,6 +147,22 @@ public:
 	///
 	bool selectConfig(unsigned cfg, bool force = false);
 
+	///
+	/// @brief Get the deviation of the device writes from their schedule
+	///
+	/// @return The number of frames, late and skipped frames and the mean and maximum jitter in microseconds
+	///
+	QJsonObject getStatistics() const;
+
+	///
+	/// @brief Get the type of smoothing by its name in the settings
+	///
+	/// @param   name    The name ("linear", "decay", "exponential", "spring" or "kalman")
+	///
+	/// @return  The type, Linear for an unknown name
+	///
+	static SmoothingType smoothingTypeFromString(const QString &name);
+
 public slots:
 	///
 	/// @brief Handle settings update from Hyperion Settingsmanager emit or this constructor
@@ -134,9 +172,6 @@ public slots:
 	void handleSettingsUpdate(settings::type type, const QJsonDocument &config);
 
 private slots:
-	/// Timer callback which writes updated led values to the led device
-	void updateLeds();
-
 	///
 	/// @brief Handle component state changes
 	/// @param component   The component
@@ -145,6 +180,9 @@ private slots:
 	void componentStateChange(hyperion::Components component, bool state);
 
 private:
+	/// Timer callback on the smoothing thread which writes updated led values to the led device
+	void updateLeds();
+
 	/**
 	 * Pushes the colors into the output queue and popping the head to the led-device
 	 *
@@ -166,14 +204,17 @@ private:
 	/// Hyperion instance
 	Hyperion *_hyperion;
 
-	/// The interval at which to update the leds (msec)
-	int _updateInterval;
+	/// The interval at which to update the leds (microseconds)
+	int64_t _updateIntervalMicros;
 
 	/// The time after which the updated led values have been fully applied (msec)
 	int64_t _settlingTime;
 
-	/// The Qt timer object
-	QTimer *_timer;
+	/// The thread which calls updateLeds() at the update interval
+	SmoothingThread *_thread;
+
+	/// Guards the smoothing state, which is accessed by the instance and the smoothing thread
+	mutable QMutex _mutex;
 
 	/// The timestamp at which the target data should be fully applied
 	int64_t _targetTime;
@@ -196,31 +237,14 @@ private:
 	/// The output queue
 	std::deque<std::vector<ColorRgb>> _outputQueue;
 
-	/// A frame of led colors used for temporal smoothing
-	class REMEMBERED_FRAME
-	{
-		public:
-		/// The time this frame was received
-		int64_t time;
-
-		/// The led colors
-		std::vector<ColorRgb> colors;
-
-		REMEMBERED_FRAME ( REMEMBERED_FRAME && ) = default;
-		REMEMBERED_FRAME ( const REMEMBERED_FRAME & ) = default;
-		REMEMBERED_FRAME & operator= ( const REMEMBERED_FRAME & ) = default;
-
-		REMEMBERED_FRAME(const int64_t time, const std::vector<ColorRgb> colors)
-		: time(time)
-		, colors(colors)
-		{}
-	};
-
 	/// The type of smoothing to perform
 	SmoothingType _smoothingType;
 
-	/// The queue of temporarily remembered frames
-	std::deque<REMEMBERED_FRAME> _frameQueue;
+	/// The temporarily remembered frames
+	LedFrameHistory _frameHistory;
+
+	/// The time weighted color sums of the remembered frames, used for linear decay
+	std::vector<int64_t> _weightedSums;
 
 	/// Prevent sending data to device when no intput data is sent
 	bool _writeToLedsEnable;
@@ -263,8 +287,8 @@ private:
 		/// The time of the smoothing window.
 		int64_t settlingTime;
 
-		/// The interval time in milliseconds of the timer used for scheduling LED update operations. A value of 0 indicates sub-millisecond timing.
-		int updateInterval;
+		/// The interval time in microseconds of the timer used for scheduling LED update operations.
+		int64_t updateIntervalMicros;
 
 		// The rate at which color frames should be written to LED device.
 		double outputRate;
@@ -341,14 +365,21 @@ private:
 	/// Performs a linear smoothing effect
 	void performLinear(const int64_t now);
 
+	/// Performs the smoothing by the filter kernel
+	void performKernel(const int64_t now);
+
+	/// The filter of the Exponential, Spring and Kalman smoothing, nullptr for the other types
+	SmoothingKernel *_kernel;
+
 	/// Aggregates the RGB components of the LED colors using the given weight and updates weighted accordingly
 	///
 	/// @param colors The LED colors to aggregate.
+	/// @param count The number of LED colors.
 	/// @param weighted The target vector, that accumulates the terms.
 	/// @param weight The weight to use.
-	static inline void aggregateComponents(const std::vector<ColorRgb>& colors, std::vector<uint64_t>& weighted, const floatT weight);
+	static inline void aggregateComponents(const ColorRgb* colors, size_t count, std::vector<uint64_t>& weighted, const floatT weight);
 
-	/// Gets the current time in microseconds from high precision system clock.
+	/// Gets the current time in microseconds from the monotonic clock, which is not affected by changes of the system time.
 	inline int64_t micros() const;
 
 	/// The time, when the rendering statistics were logged previously
@@ -373,4 +404,7 @@ private:
 	/// @param windowStart The window start time.
 	/// @returns The frame weight.
 	std::function<floatT(int64_t, int64_t, int64_t)> _weightFrame;
+
+	/// True if the frames are weighted linearly (decay == 1), the window mean is then taken from the running sums of the frame history
+	bool _linearDecay;
 };
@@ -214,6 +214,10 @@ void MessageForwarder::addFlatbufferSlave(const QString& slave)
 	{
 		_flatSlaves << slave;
 		FlatBufferConnection* flatbuf = new FlatBufferConnection("Forwarder", slave.toLocal8Bit().constData(), _priority, false);
+
+		// less bytes per pixel or compression for targets on slow networks
+		const QJsonObject &forwarderConfig = _hyperion->getSetting(settings::NETFORWARD).object();
+		flatbuf->setImageEncoding(forwarderConfig["imageFormat"].toString("rgb24"), forwarderConfig["imageCompression"].toString("none"));
 		_forwardClients << flatbuf;
 	}
 }
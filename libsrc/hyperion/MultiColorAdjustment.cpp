@@ -2,8 +2,20 @@
 #include <utils/Logger.h>
 #include <hyperion/MultiColorAdjustment.h>
 
+namespace {
+
+/// Time the adjustments have to be unchanged before the lookup tables are built, e.g. while a slider is moved
+const qint64 LUT_BUILD_DELAY_MS = 500;
+
+/// Nodes of a lookup table evaluated per update, a table is built over several updates
+const size_t LUT_NODES_PER_UPDATE = 8192;
+
+} // namespace
+
 MultiColorAdjustment::MultiColorAdjustment(int ledCnt)
 	: _ledAdjustments(ledCnt, nullptr)
+	, _lutSize(0)
+	, _lutChanged()
 	, _log(Logger::getInstance("ADJUSTMENT"))
 {
 }
@@ -93,11 +105,71 @@ void MultiColorAdjustment::setBacklightEnabled(bool enable)
 	{
 		adjustment->_rgbTransform.setBackLightEnabled(enable);
 	}
+	invalidateLuts();
+}
+
+void MultiColorAdjustment::setLutSize(int size)
+{
+	_lutSize = (size > 0) ? qBound(2, size, 256) : 0;
+	if (_lutSize > 0)
+	{
+		Debug(_log, "Color adjustments are baked into %d^3 lookup tables", _lutSize);
+	}
+	invalidateLuts();
+}
+
+void MultiColorAdjustment::invalidateLuts()
+{
+	for (ColorAdjustment* adjustment : _adjustment)
+	{
+		adjustment->_lut.invalidate();
+	}
+	_lutChanged.start();
 }
 
 void MultiColorAdjustment::applyAdjustment(std::vector<ColorRgb>& ledColors)
 {
 	const size_t itCnt = qMin(_ledAdjustments.size(), ledColors.size());
+	if (_lutSize > 0)
+	{
+		// apply the table of an adjustment to all consecutive leds using it
+		size_t i = 0;
+		while (i < itCnt)
+		{
+			ColorAdjustment* adjustment = _ledAdjustments[i];
+			size_t end = i + 1;
+			while (end < itCnt && _ledAdjustments[end] == adjustment)
+			{
+				++end;
+			}
+
+			// No transform set for these leds (do nothing)
+			if (adjustment != nullptr)
+			{
+				// the table is built in parts once the adjustment settled, the colors are calculated exactly meanwhile
+				bool lutValid = adjustment->_lut.isValid(_lutSize);
+				if (!lutValid && _lutChanged.hasExpired(LUT_BUILD_DELAY_MS))
+				{
+					lutValid = adjustment->_lut.build(_lutSize, [adjustment](ColorRgb& color) { adjustColor(adjustment, color); }, LUT_NODES_PER_UPDATE);
+				}
+
+				if (lutValid)
+				{
+					adjustment->_lut.apply(&ledColors[i], end - i);
+				}
+				else
+				{
+					for (size_t led = i; led < end; ++led)
+					{
+						adjustColor(adjustment, ledColors[led]);
+					}
+				}
+			}
+			i = end;
+		}
+		return;
+	}
+
 	for (size_t i=0; i<itCnt; ++i)
 	{
 		ColorAdjustment* adjustment = _ledAdjustments[i];
@@ -107,44 +179,47 @@ void MultiColorAdjustment::applyAdjustment(std::vector<ColorRgb>& ledColors)
 			// No transform set for this led (do nothing)
 			continue;
 		}
-		ColorRgb& color = ledColors[i];
-
-		uint8_t ored   = color.red;
-		uint8_t ogreen = color.green;
-		uint8_t oblue  = color.blue;
-		uint8_t B_RGB = 0, B_CMY = 0, B_W = 0;
-
-		adjustment->_rgbTransform.transform(ored,ogreen,oblue);
-		adjustment->_rgbTransform.getBrightnessComponents(B_RGB, B_CMY, B_W);
-
-		uint32_t nrng = (uint32_t) (255-ored)*(255-ogreen);
-		uint32_t rng  = (uint32_t) (ored)    *(255-ogreen);
-		uint32_t nrg  = (uint32_t) (255-ored)*(ogreen);
-		uint32_t rg   = (uint32_t) (ored)    *(ogreen);
-
-		uint8_t black   = nrng*(255-oblue)/65025;
-		uint8_t red     = rng *(255-oblue)/65025;
-		uint8_t green   = nrg *(255-oblue)/65025;
-		uint8_t blue    = nrng*(oblue)    /65025;
-		uint8_t cyan    = nrg *(oblue)    /65025;
-		uint8_t magenta = rng *(oblue)    /65025;
-		uint8_t yellow  = rg  *(255-oblue)/65025;
-		uint8_t white   = rg  *(oblue)    /65025;
-
-		uint8_t OR, OG, OB, RR, RG, RB, GR, GG, GB, BR, BG, BB;
-		uint8_t CR, CG, CB, MR, MG, MB, YR, YG, YB, WR, WG, WB;
-
-		adjustment->_rgbBlackAdjustment.apply  (black  , 255  , OR, OG, OB);
-		adjustment->_rgbRedAdjustment.apply    (red    , B_RGB, RR, RG, RB);
-		adjustment->_rgbGreenAdjustment.apply  (green  , B_RGB, GR, GG, GB);
-		adjustment->_rgbBlueAdjustment.apply   (blue   , B_RGB, BR, BG, BB);
-		adjustment->_rgbCyanAdjustment.apply   (cyan   , B_CMY, CR, CG, CB);
-		adjustment->_rgbMagentaAdjustment.apply(magenta, B_CMY, MR, MG, MB);
-		adjustment->_rgbYellowAdjustment.apply (yellow , B_CMY, YR, YG, YB);
-		adjustment->_rgbWhiteAdjustment.apply  (white  , B_W  , WR, WG, WB);
-
-		color.red   = OR + RR + GR + BR + CR + MR + YR + WR;
-		color.green = OG + RG + GG + BG + CG + MG + YG + WG;
-		color.blue  = OB + RB + GB + BB + CB + MB + YB + WB;
+		adjustColor(adjustment, ledColors[i]);
 	}
 }
+
+void MultiColorAdjustment::adjustColor(ColorAdjustment* adjustment, ColorRgb& color)
+{
+	uint8_t ored   = color.red;
+	uint8_t ogreen = color.green;
+	uint8_t oblue  = color.blue;
+	uint8_t B_RGB = 0, B_CMY = 0, B_W = 0;
+
+	adjustment->_rgbTransform.transform(ored,ogreen,oblue);
+	adjustment->_rgbTransform.getBrightnessComponents(B_RGB, B_CMY, B_W);
+
+	uint32_t nrng = (uint32_t) (255-ored)*(255-ogreen);
+	uint32_t rng  = (uint32_t) (ored)    *(255-ogreen);
+	uint32_t nrg  = (uint32_t) (255-ored)*(ogreen);
+	uint32_t rg   = (uint32_t) (ored)    *(ogreen);
+
+	uint8_t black   = nrng*(255-oblue)/65025;
+	uint8_t red     = rng *(255-oblue)/65025;
+	uint8_t green   = nrg *(255-oblue)/65025;
+	uint8_t blue    = nrng*(oblue)    /65025;
+	uint8_t cyan    = nrg *(oblue)    /65025;
+	uint8_t magenta = rng *(oblue)    /65025;
+	uint8_t yellow  = rg  *(255-oblue)/65025;
+	uint8_t white   = rg  *(oblue)    /65025;
+
+	uint8_t OR, OG, OB, RR, RG, RB, GR, GG, GB, BR, BG, BB;
+	uint8_t CR, CG, CB, MR, MG, MB, YR, YG, YB, WR, WG, WB;
+
+	adjustment->_rgbBlackAdjustment.apply  (black  , 255  , OR, OG, OB);
+	adjustment->_rgbRedAdjustment.apply    (red    , B_RGB, RR, RG, RB);
+	adjustment->_rgbGreenAdjustment.apply  (green  , B_RGB, GR, GG, GB);
+	adjustment->_rgbBlueAdjustment.apply   (blue   , B_RGB, BR, BG, BB);
+	adjustment->_rgbCyanAdjustment.apply   (cyan   , B_CMY, CR, CG, CB);
+	adjustment->_rgbMagentaAdjustment.apply(magenta, B_CMY, MR, MG, MB);
+	adjustment->_rgbYellowAdjustment.apply (yellow , B_CMY, YR, YG, YB);
+	adjustment->_rgbWhiteAdjustment.apply  (white  , B_W  , WR, WG, WB);
+
+	color.red   = OR + RR + GR + BR + CR + MR + YR + WR;
+	color.green = OG + RG + GG + BG + CG + MG + YG + WG;
+	color.blue  = OB + RB + GB + BB + CB + MB + YB + WB;
+}
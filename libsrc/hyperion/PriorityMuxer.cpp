@@ -17,6 +17,16 @@ const int PriorityMuxer::FG_PRIORITY = 1;
 const int PriorityMuxer::BG_PRIORITY = 254;
 const int PriorityMuxer::LOWEST_PRIORITY = std::numeric_limits<uint8_t>::max();
 
+namespace {
+
+/// The interval of timeRunner() while a timed COLOR, EFFECT or IMAGE is running [ms]
+const int TIME_RUNNER_INTERVAL_MS = 1000;
+
+/// The number of outdated deadlines which are tolerated before the queue is rebuilt
+const size_t MAX_OUTDATED_DEADLINES = 64;
+
+} // namespace
+
 PriorityMuxer::PriorityMuxer(int ledCount, QObject * parent)
 	: QObject(parent)
 	, _log(Logger::getInstance("HYPERION"))
@@ -25,10 +35,13 @@ PriorityMuxer::PriorityMuxer(int ledCount, QObject * parent)
 	, _manualSelectedPriority(256)
 	, _activeInputs()
 	, _lowestPriorityInfo()
+	, _layers()
+	, _standbyInputs()
 	, _sourceAutoSelectEnabled(true)
+	, _deadlines()
+	, _enabled(true)
 	, _updateTimer(new QTimer(this))
-	, _timer(new QTimer(this))
-	, _blockTimer(new QTimer(this))
+	, _timeRunnerTimer(new QTimer(this))
 {
 	// init lowest priority info
 	_lowestPriorityInfo.priority       = PriorityMuxer::LOWEST_PRIORITY;
@@ -37,30 +50,63 @@ PriorityMuxer::PriorityMuxer(int ledCount, QObject * parent)
 	_lowestPriorityInfo.componentId    = hyperion::COMP_COLOR;
 	_lowestPriorityInfo.origin         = "System";
 	_lowestPriorityInfo.owner          = "";
+	_lowestPriorityInfo.blendMode      = BLEND_NONE;
+	_lowestPriorityInfo.opacity        = 255;
 
 	_activeInputs[PriorityMuxer::LOWEST_PRIORITY] = _lowestPriorityInfo;
+	_layers << PriorityMuxer::LOWEST_PRIORITY;
 
-	// adapt to 1s interval for COLOR and EFFECT timeouts > -1
-	connect(_timer, &QTimer::timeout, this, &PriorityMuxer::timeTrigger);
-	_timer->setSingleShot(true);
-	_blockTimer->setSingleShot(true);
-	// forward timeRunner signal to prioritiesChanged signal & threading workaround
+	// 1s interval for COLOR and EFFECT timeouts > -1
+	connect(_timeRunnerTimer, &QTimer::timeout, this, &PriorityMuxer::timeRunner);
+	_timeRunnerTimer->setInterval(TIME_RUNNER_INTERVAL_MS);
+	// forward timeRunner signal to prioritiesChanged signal
 	connect(this, &PriorityMuxer::timeRunner, this, &PriorityMuxer::prioritiesChanged);
-	connect(this, &PriorityMuxer::signalTimeTrigger, this, &PriorityMuxer::timeTrigger);
 
-	// start muxer timer
+	// the timer is armed for the next timeout of an input only, an idle muxer does not wake up
 	connect(_updateTimer, &QTimer::timeout, this, &PriorityMuxer::setCurrentTime);
-	_updateTimer->setInterval(250);
-	_updateTimer->start();
+	_updateTimer->setSingleShot(true);
+	_updateTimer->setTimerType(Qt::PreciseTimer);
 }
 
 PriorityMuxer::~PriorityMuxer()
 {
 }
 
+PriorityMuxer::BlendMode PriorityMuxer::blendModeFromString(const QString& blendMode)
+{
+	if (blendMode == "alpha")
+		return BLEND_ALPHA;
+	if (blendMode == "add")
+		return BLEND_ADD;
+	if (blendMode == "max")
+		return BLEND_MAX;
+
+	return BLEND_NONE;
+}
+
+QString PriorityMuxer::blendModeToString(BlendMode blendMode)
+{
+	switch (blendMode)
+	{
+		case BLEND_ALPHA: return "alpha";
+		case BLEND_ADD: return "add";
+		case BLEND_MAX: return "max";
+		default: return "none";
+	}
+}
+
 void PriorityMuxer::setEnable(bool enable)
 {
-	enable ? _updateTimer->start() : _updateTimer->stop();
+	_enabled = enable;
+	if (enable)
+	{
+		setCurrentTime();
+	}
+	else
+	{
+		_updateTimer->stop();
+		_timeRunnerTimer->stop();
+	}
 }
 
 bool PriorityMuxer::setSourceAutoSelectEnabled(bool enable, bool update)
@@ -153,6 +199,8 @@ void PriorityMuxer::registerInput(int priority, hyperion::Components component,
 	InputInfo& input     = _activeInputs[priority];
 	input.priority       = priority;
 	input.timeoutTime_ms = newInput ? -100 : input.timeoutTime_ms;
+	input.blendMode      = newInput ? BLEND_NONE : input.blendMode;
+	input.opacity        = newInput ? 255 : input.opacity;
 	input.componentId    = component;
 	input.origin         = origin;
 	input.smooth_cfg     = smooth_cfg;
@@ -161,6 +209,11 @@ void PriorityMuxer::registerInput(int priority, hyperion::Components component,
 	if (newInput)
 	{
 		Debug(_log,"Register new input '%s/%s' with priority %d as inactive", QSTRING_CSTR(origin), hyperion::componentToIdString(component), priority);
+		// the producer of a new input learns whether it is hidden right from the start
+		const bool standby = isHidden(priority);
+		if (standby)
+			_standbyInputs[priority] = component;
+		emit inputStandbyChanged(priority, component, standby);
 		// emit 'prioritiesChanged' only if _sourceAutoSelectEnabled is false
 		if (!_sourceAutoSelectEnabled)
 			emit prioritiesChanged();
@@ -199,10 +252,14 @@ bool PriorityMuxer::setInput(int priority, const std::vector<ColorRgb>& ledColor
 		activeChange = true;
 	}
 	// update input
+	const bool newTimeout = (timeout_ms > 0 && input.timeoutTime_ms != timeout_ms);
 	input.timeoutTime_ms = timeout_ms;
 	input.ledColors      = ledColors;
 	input.image.clear();
 
+	if (newTimeout)
+		addDeadline(priority, timeout_ms);
+
 	// emit active change
 	if(activeChange)
 	{
@@ -243,10 +300,14 @@ bool PriorityMuxer::setInputImage(int priority, const Image<ColorRgb>& image, in
 		activeChange = true;
 	}
 	// update input
+	const bool newTimeout = (timeout_ms > 0 && input.timeoutTime_ms != timeout_ms);
 	input.timeoutTime_ms = timeout_ms;
 	input.image          = image;
 	input.ledColors.clear();
 
+	if (newTimeout)
+		addDeadline(priority, timeout_ms);
+
 	// emit active change
 	if(activeChange)
 	{
@@ -259,6 +320,32 @@ bool PriorityMuxer::setInputImage(int priority, const Image<ColorRgb>& image, in
 	return true;
 }
 
+bool PriorityMuxer::setInputBlending(int priority, BlendMode blendMode, uint8_t opacity)
+{
+	if (priority >= PriorityMuxer::LOWEST_PRIORITY || !_activeInputs.contains(priority))
+	{
+		return false;
+	}
+
+	InputInfo& input = _activeInputs[priority];
+	if (input.blendMode != blendMode || input.opacity != opacity)
+	{
+		input.blendMode = blendMode;
+		input.opacity = opacity;
+		Debug(_log, "Priority %d is blended: %s, opacity %d", priority, QSTRING_CSTR(blendModeToString(blendMode)), opacity);
+
+		// the layers depend on the blend modes, a visible layer is blended again in any case
+		const QList<int> layers = _layers;
+		setCurrentTime();
+		if (layers == _layers && isInputVisible(priority))
+		{
+			emit layersChanged();
+		}
+		emit prioritiesChanged();
+	}
+	return true;
+}
+
 bool PriorityMuxer::setInputInactive(int priority)
 {
 	Image<ColorRgb> image;
@@ -288,6 +375,11 @@ void PriorityMuxer::clearAll(bool forceClearAll)
 		_activeInputs.clear();
 		_currentPriority = PriorityMuxer::LOWEST_PRIORITY;
 		_activeInputs[_currentPriority] = _lowestPriorityInfo;
+		_deadlines = decltype(_deadlines)();
+		_updateTimer->stop();
+		_timeRunnerTimer->stop();
+		updateLayers();
+		updateInputStandby();
 	}
 	else
 	{
@@ -305,31 +397,40 @@ void PriorityMuxer::clearAll(bool forceClearAll)
 void PriorityMuxer::setCurrentTime()
 {
 	const int64_t now = QDateTime::currentMSecsSinceEpoch();
-	int newPriority;
-	_activeInputs.contains(0) ? newPriority = 0 : newPriority = PriorityMuxer::LOWEST_PRIORITY;
 
-	for (auto infoIt = _activeInputs.begin(); infoIt != _activeInputs.end();)
+	// clear the inputs whose timeout is reached, the deadlines are ordered by time
+	while (!_deadlines.empty() && _deadlines.top().first <= now)
 	{
-		if (infoIt->timeoutTime_ms > 0 && infoIt->timeoutTime_ms <= now)
+		const Deadline deadline = _deadlines.top();
+		_deadlines.pop();
+
+		auto infoIt = _activeInputs.find(deadline.second);
+		if (infoIt != _activeInputs.end() && infoIt->timeoutTime_ms == deadline.first)
 		{
-			int tPrio = infoIt->priority;
-			infoIt = _activeInputs.erase(infoIt);
-			Debug(_log,"Timeout clear for priority %d",tPrio);
+			_activeInputs.erase(infoIt);
+			Debug(_log,"Timeout clear for priority %d",deadline.second);
 			emit prioritiesChanged();
 		}
-		else
-		{
-			// timeoutTime of -100 is awaiting data (inactive); skip
-			if(infoIt->timeoutTime_ms > -100)
-				newPriority = qMin(newPriority, infoIt->priority);
-
-			// call timeTrigger when effect or color is running with timeout > 0, blacklist prio 255
-			if(infoIt->priority < BG_PRIORITY && infoIt->timeoutTime_ms > 0 && (infoIt->componentId == hyperion::COMP_EFFECT || infoIt->componentId == hyperion::COMP_COLOR  || infoIt->componentId == hyperion::COMP_IMAGE))
-				emit signalTimeTrigger(); // as signal to prevent Threading issues
+	}
 
-			++infoIt;
+	// the inputs are ordered by priority, the first active one is visible. A timeoutTime of -100 is awaiting data (inactive); skip
+	int newPriority = PriorityMuxer::LOWEST_PRIORITY;
+	if (_activeInputs.contains(0))
+	{
+		newPriority = 0;
+	}
+	else
+	{
+		for (auto infoIt = _activeInputs.constBegin(); infoIt != _activeInputs.constEnd(); ++infoIt)
+		{
+			if (infoIt->timeoutTime_ms > -100)
+			{
+				newPriority = infoIt.key();
+				break;
+			}
 		}
 	}
+
 	// evaluate, if manual selected priority is still available
 	if(!_sourceAutoSelectEnabled)
 	{
@@ -346,7 +447,8 @@ void PriorityMuxer::setCurrentTime()
 	}
 	// apply & emit on change (after apply!)
 	hyperion::Components comp = getComponentOfPriority(newPriority);
-	if (_currentPriority != newPriority || comp != _prevVisComp)
+	const bool priorityChanged = (_currentPriority != newPriority || comp != _prevVisComp);
+	if (priorityChanged)
 	{
 		_previousPriority = _currentPriority;
 		_currentPriority = newPriority;
@@ -360,17 +462,167 @@ void PriorityMuxer::setCurrentTime()
 		}
 		emit prioritiesChanged();
 	}
+
+	// a change of the current priority updates the led colors anyway
+	if (updateLayers() && !priorityChanged)
+	{
+		emit layersChanged();
+	}
+
+	updateInputStandby();
+	updateTimeRunner();
+	scheduleNextDeadline();
 }
 
-void PriorityMuxer::timeTrigger()
+bool PriorityMuxer::updateLayers()
 {
-	if(_blockTimer->isActive())
+	QList<int> layers;
+
+	auto infoIt = _activeInputs.constFind(_currentPriority);
+	if (infoIt != _activeInputs.constEnd())
 	{
-		_timer->start(500);
+		layers.prepend(infoIt.key());
+
+		// the lowest priority is not blended, the loop ends there at the latest
+		while (infoIt->blendMode != BLEND_NONE)
+		{
+			// the next active input below, a timeoutTime of -100 is awaiting data (inactive)
+			do
+			{
+				++infoIt;
+			}
+			while (infoIt != _activeInputs.constEnd() && infoIt->timeoutTime_ms <= -100);
+
+			if (infoIt == _activeInputs.constEnd())
+				break;
+
+			layers.prepend(infoIt.key());
+		}
 	}
 	else
 	{
-		emit timeRunner();
-		_blockTimer->start(1000);
+		layers << _currentPriority;
+	}
+
+	if (layers == _layers)
+		return false;
+
+	_layers = layers;
+	return true;
+}
+
+bool PriorityMuxer::isHidden(int priority) const
+{
+	if (priority >= PriorityMuxer::LOWEST_PRIORITY || _layers.contains(priority))
+		return false;
+
+	// an inactive input below the current priority is not hidden, it becomes visible with its next update
+	return _sourceAutoSelectEnabled ? priority > _currentPriority : priority != _currentPriority;
+}
+
+void PriorityMuxer::updateInputStandby()
+{
+	for (auto infoIt = _activeInputs.constBegin(); infoIt != _activeInputs.constEnd(); ++infoIt)
+	{
+		const int priority = infoIt.key();
+		const hyperion::Components component = infoIt->componentId;
+		const bool standby = isHidden(priority);
+		auto standbyIt = _standbyInputs.find(priority);
+
+		if (standbyIt != _standbyInputs.end() && (!standby || standbyIt.value() != component))
+		{
+			const hyperion::Components prevComponent = standbyIt.value();
+			_standbyInputs.erase(standbyIt);
+			emit inputStandbyChanged(priority, prevComponent, false);
+			standbyIt = _standbyInputs.end();
+		}
+
+		if (standby && standbyIt == _standbyInputs.end())
+		{
+			_standbyInputs[priority] = component;
+			emit inputStandbyChanged(priority, component, true);
+		}
+	}
+
+	// removed inputs are not hidden anymore
+	for (auto standbyIt = _standbyInputs.begin(); standbyIt != _standbyInputs.end();)
+	{
+		if (_activeInputs.contains(standbyIt.key()))
+		{
+			++standbyIt;
+			continue;
+		}
+
+		const int priority = standbyIt.key();
+		const hyperion::Components component = standbyIt.value();
+		standbyIt = _standbyInputs.erase(standbyIt);
+		emit inputStandbyChanged(priority, component, false);
+	}
+}
+
+void PriorityMuxer::addDeadline(int priority, int64_t timeoutTime_ms)
+{
+	// inputs updated at a high rate leave a lot of outdated deadlines, the queue is rebuilt from the inputs
+	if (_deadlines.size() > static_cast<size_t>(_activeInputs.size()) * 2 + MAX_OUTDATED_DEADLINES)
+	{
+		std::vector<Deadline> deadlines;
+		for (auto infoIt = _activeInputs.constBegin(); infoIt != _activeInputs.constEnd(); ++infoIt)
+		{
+			if (infoIt->timeoutTime_ms > 0 && infoIt.key() != priority)
+				deadlines.emplace_back(infoIt->timeoutTime_ms, infoIt.key());
+		}
+		_deadlines = decltype(_deadlines)(std::greater<Deadline>(), std::move(deadlines));
+	}
+
+	_deadlines.emplace(timeoutTime_ms, priority);
+
+	if (_deadlines.top().second == priority && _deadlines.top().first == timeoutTime_ms)
+		scheduleNextDeadline();
+
+	// a COLOR, EFFECT or IMAGE got a timeout
+	if (!_timeRunnerTimer->isActive())
+		updateTimeRunner();
+}
+
+void PriorityMuxer::scheduleNextDeadline()
+{
+	// drop the deadlines of inputs which got a new timeout or were removed
+	while (!_deadlines.empty())
+	{
+		const Deadline& deadline = _deadlines.top();
+		auto infoIt = _activeInputs.constFind(deadline.second);
+		if (infoIt != _activeInputs.constEnd() && infoIt->timeoutTime_ms == deadline.first)
+			break;
+		_deadlines.pop();
+	}
+
+	if (_deadlines.empty() || !_enabled)
+	{
+		_updateTimer->stop();
+		return;
+	}
+
+	const int64_t remaining = _deadlines.top().first - QDateTime::currentMSecsSinceEpoch();
+	_updateTimer->start(static_cast<int>(qBound<int64_t>(0, remaining, std::numeric_limits<int>::max())));
+}
+
+void PriorityMuxer::updateTimeRunner()
+{
+	bool timed = false;
+	for (auto infoIt = _activeInputs.constBegin(); infoIt != _activeInputs.constEnd() && !timed; ++infoIt)
+	{
+		// blacklist prio 255
+		timed = infoIt->priority < BG_PRIORITY && infoIt->timeoutTime_ms > 0
+				&& (infoIt->componentId == hyperion::COMP_EFFECT || infoIt->componentId == hyperion::COMP_COLOR || infoIt->componentId == hyperion::COMP_IMAGE);
+	}
+
+	if (timed && _enabled)
+	{
+		if (!_timeRunnerTimer->isActive())
+			_timeRunnerTimer->start();
+	}
+	else
+	{
+		_timeRunnerTimer->stop();
 	}
 }
@@ -0,0 +1,258 @@
+#include "SmoothingKernel.h"
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define SMOOTHINGKERNEL_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define SMOOTHINGKERNEL_NEON
+#endif
+
+namespace {
+
+/// The exponential decay has settled within 1% of the distance after e^-x = 0.01
+const float EXPONENTIAL_SETTLING = 4.605F;
+
+/// The critically damped spring has settled within 1% after (1 + x) * e^-x = 0.01
+const float SPRING_SETTLING = 6.638F;
+
+/// The standard deviation of the capture noise in color levels, measured per frame at 25 Hz
+const float KALMAN_NOISE_LEVELS = 4.0F;
+const float KALMAN_NOISE_INTERVAL = 0.04F;
+
+/// Innovations beyond this number of standard deviations are taken as a change of the scene
+const float KALMAN_GATE = 3.0F;
+
+/// The shortest settling time in seconds, shorter times are not distinguishable from no smoothing
+const float MIN_SETTLING_TIME = 0.001F;
+
+///
+/// Four channels at once
+///
+#if defined(SMOOTHINGKERNEL_SSE2)
+
+#define SMOOTHINGKERNEL_SIMD
+typedef __m128 Vec4;
+
+inline Vec4 load(const float* src)          { return _mm_loadu_ps(src); }
+inline void store(float* dest, Vec4 v)      { _mm_storeu_ps(dest, v); }
+inline Vec4 splat(float x)                  { return _mm_set1_ps(x); }
+inline Vec4 add(Vec4 a, Vec4 b)             { return _mm_add_ps(a, b); }
+inline Vec4 sub(Vec4 a, Vec4 b)             { return _mm_sub_ps(a, b); }
+inline Vec4 mul(Vec4 a, Vec4 b)             { return _mm_mul_ps(a, b); }
+inline Vec4 max(Vec4 a, Vec4 b)             { return _mm_max_ps(a, b); }
+inline Vec4 div(Vec4 a, Vec4 b)             { return _mm_div_ps(a, b); }
+
+#elif defined(SMOOTHINGKERNEL_NEON)
+
+#define SMOOTHINGKERNEL_SIMD
+typedef float32x4_t Vec4;
+
+inline Vec4 load(const float* src)          { return vld1q_f32(src); }
+inline void store(float* dest, Vec4 v)      { vst1q_f32(dest, v); }
+inline Vec4 splat(float x)                  { return vdupq_n_f32(x); }
+inline Vec4 add(Vec4 a, Vec4 b)             { return vaddq_f32(a, b); }
+inline Vec4 sub(Vec4 a, Vec4 b)             { return vsubq_f32(a, b); }
+inline Vec4 mul(Vec4 a, Vec4 b)             { return vmulq_f32(a, b); }
+inline Vec4 max(Vec4 a, Vec4 b)             { return vmaxq_f32(a, b); }
+inline Vec4 div(Vec4 a, Vec4 b)
+{
+#if defined(__aarch64__)
+	return vdivq_f32(a, b);
+#else
+	// reciprocal estimate refined by two Newton-Raphson steps
+	Vec4 reciprocal = vrecpeq_f32(b);
+	reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+	reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+	return vmulq_f32(a, reciprocal);
+#endif
+}
+
+#endif
+
+} // namespace
+
+SmoothingKernel::SmoothingKernel(int64_t settlingTime_ms)
+	: _settlingTime(std::max(settlingTime_ms / 1000.0F, MIN_SETTLING_TIME))
+	, _values()
+	, _target()
+{
+}
+
+void SmoothingKernel::reset(const std::vector<ColorRgb>& colors)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(colors.data());
+	_values.assign(bytes, bytes + 3 * colors.size());
+	_target = _values;
+	resetState();
+}
+
+void SmoothingKernel::setTarget(const std::vector<ColorRgb>& colors)
+{
+	if (3 * colors.size() != _values.size())
+	{
+		reset(colors);
+		return;
+	}
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(colors.data());
+	std::copy(bytes, bytes + _target.size(), _target.begin());
+}
+
+void SmoothingKernel::step(int64_t elapsedMicros, std::vector<ColorRgb>& colors)
+{
+	if (elapsedMicros > 0)
+	{
+		advance(elapsedMicros / 1000000.0F);
+	}
+
+	colors.resize(_values.size() / 3);
+	uint8_t* bytes = reinterpret_cast<uint8_t*>(colors.data());
+	for (size_t i = 0; i < _values.size(); ++i)
+	{
+		bytes[i] = static_cast<uint8_t>(std::min(255.0F, std::max(0.0F, _values[i])) + 0.5F);
+	}
+}
+
+ExponentialKernel::ExponentialKernel(int64_t settlingTime_ms)
+	: SmoothingKernel(settlingTime_ms)
+{
+}
+
+void ExponentialKernel::advance(float elapsed)
+{
+	const float gain = 1.0F - std::exp(-EXPONENTIAL_SETTLING * elapsed / _settlingTime);
+
+	float* values = _values.data();
+	const float* target = _target.data();
+	const size_t count = _values.size();
+
+	size_t i = 0;
+#ifdef SMOOTHINGKERNEL_SIMD
+	const Vec4 vGain = splat(gain);
+	for (; i + 4 <= count; i += 4)
+	{
+		const Vec4 value = load(values + i);
+		store(values + i, add(value, mul(vGain, sub(load(target + i), value))));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		values[i] += gain * (target[i] - values[i]);
+	}
+}
+
+SpringKernel::SpringKernel(int64_t settlingTime_ms)
+	: SmoothingKernel(settlingTime_ms)
+	, _velocities()
+{
+}
+
+void SpringKernel::resetState()
+{
+	_velocities.assign(_values.size(), 0.0F);
+}
+
+void SpringKernel::advance(float elapsed)
+{
+	// Exact solution of the critically damped oscillator for the distance to the target (d) and the velocity (v):
+	// d' = e^-x * ((1 + x) * d + t * v),  v' = e^-x * ((1 - x) * v - w^2 * t * d)  with x = w * t
+	const float omega = SPRING_SETTLING / _settlingTime;
+	const float x = omega * elapsed;
+	const float decay = std::exp(-x);
+
+	const float distDist = decay * (1.0F + x);
+	const float distVel  = decay * elapsed;
+	const float velDist  = -decay * omega * omega * elapsed;
+	const float velVel   = decay * (1.0F - x);
+
+	float* values = _values.data();
+	float* velocities = _velocities.data();
+	const float* target = _target.data();
+	const size_t count = _values.size();
+
+	size_t i = 0;
+#ifdef SMOOTHINGKERNEL_SIMD
+	const Vec4 vDistDist = splat(distDist);
+	const Vec4 vDistVel  = splat(distVel);
+	const Vec4 vVelDist  = splat(velDist);
+	const Vec4 vVelVel   = splat(velVel);
+	for (; i + 4 <= count; i += 4)
+	{
+		const Vec4 goal = load(target + i);
+		const Vec4 distance = sub(load(values + i), goal);
+		const Vec4 velocity = load(velocities + i);
+		store(values + i, add(goal, add(mul(vDistDist, distance), mul(vDistVel, velocity))));
+		store(velocities + i, add(mul(vVelDist, distance), mul(vVelVel, velocity)));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		const float distance = values[i] - target[i];
+		const float velocity = velocities[i];
+		values[i] = target[i] + distDist * distance + distVel * velocity;
+		velocities[i] = velDist * distance + velVel * velocity;
+	}
+}
+
+KalmanKernel::KalmanKernel(int64_t settlingTime_ms)
+	: SmoothingKernel(settlingTime_ms)
+	, _variances()
+	, _measurementNoise(KALMAN_NOISE_LEVELS * KALMAN_NOISE_LEVELS * KALMAN_NOISE_INTERVAL)
+	// the steady state gain sqrt(q / r) settles like the exponential kernel
+	, _processNoise(_measurementNoise * (EXPONENTIAL_SETTLING / _settlingTime) * (EXPONENTIAL_SETTLING / _settlingTime))
+{
+}
+
+void KalmanKernel::resetState()
+{
+	_variances.assign(_values.size(), 0.0F);
+}
+
+void KalmanKernel::advance(float elapsed)
+{
+	// the target is measured at every step, shorter steps give less certain measurements
+	const float predictNoise = _processNoise * elapsed;
+	const float measureNoise = _measurementNoise / elapsed;
+
+	float* values = _values.data();
+	float* variances = _variances.data();
+	const float* target = _target.data();
+	const size_t count = _values.size();
+
+	size_t i = 0;
+#ifdef SMOOTHINGKERNEL_SIMD
+	const Vec4 vPredictNoise = splat(predictNoise);
+	const Vec4 vMeasureNoise = splat(measureNoise);
+	const Vec4 vInvGate = splat(1.0F / (KALMAN_GATE * KALMAN_GATE));
+	for (; i + 4 <= count; i += 4)
+	{
+		const Vec4 value = load(values + i);
+		const Vec4 innovation = sub(load(target + i), value);
+
+		// predict, an innovation beyond the gate raises the variance
+		Vec4 variance = add(load(variances + i), vPredictNoise);
+		variance = max(variance, sub(mul(mul(innovation, innovation), vInvGate), vMeasureNoise));
+
+		// update
+		const Vec4 gain = div(variance, add(variance, vMeasureNoise));
+		store(values + i, add(value, mul(gain, innovation)));
+		store(variances + i, sub(variance, mul(gain, variance)));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		const float innovation = target[i] - values[i];
+
+		float variance = variances[i] + predictNoise;
+		variance = std::max(variance, innovation * innovation / (KALMAN_GATE * KALMAN_GATE) - measureNoise);
+
+		const float gain = variance / (variance + measureNoise);
+		values[i] += gain * innovation;
+		variances[i] = variance - gain * variance;
+	}
+}
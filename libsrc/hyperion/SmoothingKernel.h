@@ -0,0 +1,119 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+
+///
+/// A SmoothingKernel moves the led colors towards the target colors with a filter, which keeps its state in
+/// floating point per color channel. Every step advances the state by the time elapsed since the previous step,
+/// so the response does not depend on the update frequency. The channel loops use SSE2 or NEON if available.
+///
+/// The kernels are cheaper than the decay smoothing: a step costs a few multiplications per channel and
+/// needs neither a frame history nor dithering.
+///
+class SmoothingKernel
+{
+public:
+	///
+	/// @param settlingTime_ms  The time after which a new target is reached (within 1%)
+	///
+	explicit SmoothingKernel(int64_t settlingTime_ms);
+	virtual ~SmoothingKernel() = default;
+
+	///
+	/// @brief Set the colors without a transition, e.g. when the smoothing starts
+	///
+	void reset(const std::vector<ColorRgb>& colors);
+
+	///
+	/// @brief Set the target colors, a different number of leds resets the kernel to the target
+	///
+	void setTarget(const std::vector<ColorRgb>& colors);
+
+	///
+	/// @brief Advance the filter
+	///
+	/// @param      elapsedMicros  The time since the previous step
+	/// @param[out] colors         The colors after the step
+	///
+	void step(int64_t elapsedMicros, std::vector<ColorRgb>& colors);
+
+protected:
+	///
+	/// @brief Advance the values towards the target
+	/// @param elapsed  The time since the previous step in seconds
+	///
+	virtual void advance(float elapsed) = 0;
+
+	///
+	/// @brief Reset the additional state of a kernel for the current number of channels
+	///
+	virtual void resetState() {}
+
+	/// The settling time in seconds
+	const float _settlingTime;
+
+	/// The current value of every color channel
+	std::vector<float> _values;
+
+	/// The target value of every color channel
+	std::vector<float> _target;
+};
+
+///
+/// Exponential moving average, the distance to the target shrinks by a constant factor per time
+///
+class ExponentialKernel : public SmoothingKernel
+{
+public:
+	explicit ExponentialKernel(int64_t settlingTime_ms);
+
+protected:
+	void advance(float elapsed) override;
+};
+
+///
+/// Critically damped spring, the colors accelerate towards the target and reach it without overshooting.
+/// A new target keeps the current velocity, so changes of direction are smooth as well.
+///
+class SpringKernel : public SmoothingKernel
+{
+public:
+	explicit SpringKernel(int64_t settlingTime_ms);
+
+protected:
+	void advance(float elapsed) override;
+	void resetState() override;
+
+private:
+	/// The velocity of every color channel
+	std::vector<float> _velocities;
+};
+
+///
+/// One dimensional Kalman filter per color channel, the target is a noisy measurement of the color.
+/// Changes within the noise of the capture are smoothed, while the estimate variance is raised to
+/// the size of a larger change, so scene changes are followed quickly.
+///
+class KalmanKernel : public SmoothingKernel
+{
+public:
+	explicit KalmanKernel(int64_t settlingTime_ms);
+
+protected:
+	void advance(float elapsed) override;
+	void resetState() override;
+
+private:
+	/// The estimate variance of every color channel
+	std::vector<float> _variances;
+
+	/// The measurement noise density and the process noise per second
+	const float _measurementNoise;
+	const float _processNoise;
+};
@@ -0,0 +1,257 @@
+#include "SmoothingThread.h"
+
+// STL includes
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+// Utils includes
+#include <utils/Logger.h>
+
+#ifdef __linux__
+	#include <cerrno>
+	#include <ctime>
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace {
+
+/// Below this interval the calls are not distinguishable from spinning
+const int64_t MIN_INTERVAL_MICROS = 100;
+
+/// Remaining time of a sleep, which is not spent on the (interruptible) wait condition but slept precisely
+const int64_t PRECISE_SLEEP_MICROS = 2000;
+
+/// Sleep until the given monotonic time in microseconds
+void sleepUntil(int64_t deadline)
+{
+#ifdef __linux__
+	timespec ts;
+	ts.tv_sec = static_cast<time_t>(deadline / 1000000);
+	ts.tv_nsec = static_cast<long>((deadline % 1000000) * 1000);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+	{
+	}
+#else
+	std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::microseconds(deadline)));
+#endif
+}
+
+} // namespace
+
+SmoothingThread::SmoothingThread(std::function<void()> tick, Logger* log)
+	: QThread()
+	, _tick(std::move(tick))
+	, _log(log)
+	, _stopped(false)
+	, _active(false)
+	, _intervalMicros(0)
+	, _deadline(0)
+	, _generation(0)
+	, _priority(0)
+	, _cpu(-1)
+	, _schedulingChanged(false)
+	, _statistics()
+	, _jitterSum(0)
+{
+	setObjectName("SmoothingThread");
+}
+
+SmoothingThread::~SmoothingThread()
+{
+	{
+		QMutexLocker locker(&_mutex);
+		_stopped = true;
+		_changed.wakeAll();
+	}
+	wait();
+}
+
+int64_t SmoothingThread::now()
+{
+#ifdef __linux__
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#else
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void SmoothingThread::startTimer(int64_t intervalMicros)
+{
+	QMutexLocker locker(&_mutex);
+	_intervalMicros = std::max(intervalMicros, MIN_INTERVAL_MICROS);
+	_deadline = now() + _intervalMicros;
+	_active = true;
+	++_generation;
+
+	_statistics = Statistics();
+	_jitterSum = 0;
+
+	_changed.wakeAll();
+}
+
+void SmoothingThread::stopTimer()
+{
+	QMutexLocker locker(&_mutex);
+	_active = false;
+	++_generation;
+	_changed.wakeAll();
+}
+
+bool SmoothingThread::isTimerActive() const
+{
+	QMutexLocker locker(&_mutex);
+	return _active;
+}
+
+void SmoothingThread::setScheduling(int priority, int cpu)
+{
+	QMutexLocker locker(&_mutex);
+	if (_priority != priority || _cpu != cpu)
+	{
+		_priority = priority;
+		_cpu = cpu;
+		_schedulingChanged = true;
+		_changed.wakeAll();
+	}
+}
+
+SmoothingThread::Statistics SmoothingThread::getStatistics() const
+{
+	QMutexLocker locker(&_mutex);
+	Statistics statistics = _statistics;
+	statistics.meanJitterMicros = (_statistics.frames > 0) ? _jitterSum / _statistics.frames : 0;
+	return statistics;
+}
+
+void SmoothingThread::run()
+{
+	QMutexLocker locker(&_mutex);
+	while (!_stopped)
+	{
+		if (_schedulingChanged)
+		{
+			_schedulingChanged = false;
+			const int priority = _priority;
+			const int cpu = _cpu;
+
+			locker.unlock();
+			applyScheduling(priority, cpu);
+			locker.relock();
+			continue;
+		}
+
+		if (!_active)
+		{
+			_changed.wait(&_mutex);
+			continue;
+		}
+
+		const int64_t deadline = _deadline;
+		if (!waitUntil(deadline))
+		{
+			continue;
+		}
+
+		const int64_t wakeup = now();
+		const int64_t jitter = wakeup - deadline;
+		++_statistics.frames;
+		_jitterSum += jitter;
+		_statistics.maxJitterMicros = std::max(_statistics.maxJitterMicros, jitter);
+		if (jitter > _intervalMicros / 2)
+		{
+			++_statistics.lateFrames;
+		}
+
+		// the next deadline is relative to this one, deadlines which have passed already are skipped
+		_deadline += _intervalMicros;
+		if (_deadline <= wakeup)
+		{
+			const int64_t missed = (wakeup - _deadline) / _intervalMicros + 1;
+			_statistics.skippedFrames += static_cast<uint64_t>(missed);
+			_deadline += missed * _intervalMicros;
+		}
+
+		locker.unlock();
+		_tick();
+		locker.relock();
+	}
+}
+
+bool SmoothingThread::waitUntil(int64_t deadline)
+{
+	const uint64_t generation = _generation;
+	while (!_stopped && !_schedulingChanged && _generation == generation)
+	{
+		const int64_t remaining = deadline - now();
+		if (remaining <= 0)
+		{
+			return true;
+		}
+
+		if (remaining > PRECISE_SLEEP_MICROS)
+		{
+			// wake up early for the precise sleep, timer changes interrupt the wait
+			_changed.wait(&_mutex, static_cast<unsigned long>((remaining - PRECISE_SLEEP_MICROS / 2) / 1000));
+			continue;
+		}
+
+		_mutex.unlock();
+		sleepUntil(deadline);
+		_mutex.lock();
+		return !_stopped && _generation == generation;
+	}
+	return false;
+}
+
+void SmoothingThread::applyScheduling(int priority, int cpu)
+{
+#ifdef __linux__
+	sched_param param;
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = priority;
+
+	const int rc = pthread_setschedparam(pthread_self(), (priority > 0) ? SCHED_FIFO : SCHED_OTHER, &param);
+	if (rc != 0)
+	{
+		Warning(_log, "Failed to set real-time priority %d: %s", priority, strerror(rc));
+	}
+	else if (priority > 0)
+	{
+		Info(_log, "Smoothing runs with real-time priority %d", priority);
+	}
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	if (cpu >= 0)
+	{
+		CPU_SET(cpu, &cpus);
+	}
+	else
+	{
+		for (int i = 0; i < QThread::idealThreadCount(); ++i)
+		{
+			CPU_SET(i, &cpus);
+		}
+	}
+
+	const int rcAffinity = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	if (rcAffinity != 0)
+	{
+		Warning(_log, "Failed to bind smoothing to CPU %d: %s", cpu, strerror(rcAffinity));
+	}
+	else if (cpu >= 0)
+	{
+		Info(_log, "Smoothing is bound to CPU %d", cpu);
+	}
+#else
+	if (priority > 0 || cpu >= 0)
+	{
+		Warning(_log, "Real-time priority and CPU affinity of the smoothing are supported on Linux only");
+	}
+#endif
+}
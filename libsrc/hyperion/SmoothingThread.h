@@ -0,0 +1,107 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <functional>
+
+// Qt includes
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+class Logger;
+
+///
+/// The SmoothingThread calls the smoothing at a fixed rate on its own thread, independent of the load of the
+/// Hyperion instance thread. Every call is scheduled at an absolute deadline on the monotonic clock, so the
+/// time needed by the call and the wakeup latency do not accumulate. Missed deadlines are skipped.
+///
+/// The thread may run with real-time priority (SCHED_FIFO) and on a given CPU, both require Linux and
+/// the priority requires the CAP_SYS_NICE capability.
+///
+class SmoothingThread : public QThread
+{
+public:
+	/// Deviation of the calls from their deadlines
+	struct Statistics
+	{
+		/// The number of calls
+		uint64_t frames;
+		/// The number of calls more than half an interval behind their deadline
+		uint64_t lateFrames;
+		/// The number of skipped deadlines
+		uint64_t skippedFrames;
+		/// The mean and maximum deviation from the deadline in microseconds
+		double meanJitterMicros;
+		int64_t maxJitterMicros;
+	};
+
+	///
+	/// @param tick  Called at every deadline on the thread
+	/// @param log   The logger of the smoothing
+	///
+	SmoothingThread(std::function<void()> tick, Logger* log);
+	~SmoothingThread() override;
+
+	///
+	/// @brief Start (or restart) calling the tick, the first call is due after one interval
+	/// @param intervalMicros  The interval of the calls in microseconds
+	///
+	void startTimer(int64_t intervalMicros);
+
+	///
+	/// @brief Stop calling the tick
+	///
+	void stopTimer();
+
+	///
+	/// @return True if the tick is called
+	///
+	bool isTimerActive() const;
+
+	///
+	/// @brief Set the scheduling of the thread, applied on the next deadline
+	/// @param priority  The SCHED_FIFO priority (1..99), 0 for the default scheduling
+	/// @param cpu       The CPU the thread is bound to, -1 for any CPU
+	///
+	void setScheduling(int priority, int cpu);
+
+	///
+	/// @brief Get the statistics since the timer was started
+	///
+	Statistics getStatistics() const;
+
+protected:
+	void run() override;
+
+private:
+	/// Apply the scheduling, called on the thread
+	void applyScheduling(int priority, int cpu);
+
+	/// Sleep until the deadline unless the timer is changed, the mutex is held on entry and exit
+	/// @return False if the deadline was not reached
+	bool waitUntil(int64_t deadline);
+
+	/// The monotonic time in microseconds
+	static int64_t now();
+
+	std::function<void()> _tick;
+	Logger* _log;
+
+	mutable QMutex _mutex;
+	QWaitCondition _changed;
+
+	bool _stopped;
+	bool _active;
+	int64_t _intervalMicros;
+	int64_t _deadline;
+	/// Incremented with every timer change, a sleeping thread recognizes its deadline is outdated
+	uint64_t _generation;
+
+	int _priority;
+	int _cpu;
+	bool _schedulingChanged;
+
+	Statistics _statistics;
+	double _jitterSum;
+};
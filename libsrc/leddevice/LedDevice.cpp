@@ -8,6 +8,7 @@
 #include <QEventLoop>
 #include <QTimer>
 #include <QDateTime>
+#include <QMutexLocker>
 
 #include "hyperion/Hyperion.h"
 #include <utils/JsonUtils.h>
@@ -16,6 +17,14 @@
 #include <sstream>
 #include <iomanip>
 
+namespace {
+
+/// Upper bounds of the write latency histogram ranges in milliseconds, the last range is open
+const int WRITE_LATENCY_BOUNDS[] = { 1, 2, 5, 10, 20, 50, 100 };
+const size_t WRITE_LATENCY_RANGES = sizeof(WRITE_LATENCY_BOUNDS) / sizeof(WRITE_LATENCY_BOUNDS[0]) + 1;
+
+} // namespace
+
 LedDevice::LedDevice(const QJsonObject& deviceConfig, QObject* parent)
 	: QObject(parent)
 	  , _devConfig(deviceConfig)
@@ -33,7 +42,16 @@ LedDevice::LedDevice(const QJsonObject& deviceConfig, QObject* parent)
 	  , _isDeviceInError(false)
 	  , _isInSwitchOff (false)
 	  , _lastWriteTime(QDateTime::currentDateTime())
+	  , _latchTimer(nullptr)
+	  , _isWriteDeferred(false)
 	  , _isRefreshEnabled (false)
+	  , _queuedFrames(0)
+	  , _writtenFrames(0)
+	  , _deferredFrames(0)
+	  , _replacedDeferredFrames(0)
+	  , _writeMicrosSum(0)
+	  , _maxWriteMicros(0)
+	  , _writeLatencyHistogram(WRITE_LATENCY_RANGES, 0)
 {
 	_activeDeviceType = deviceConfig["type"].toString("UNSPECIFIED").toLower();
 }
@@ -41,6 +59,7 @@ LedDevice::LedDevice(const QJsonObject& deviceConfig, QObject* parent)
 LedDevice::~LedDevice()
 {
 	delete _refreshTimer;
+	delete _latchTimer;
 }
 
 void LedDevice::start()
@@ -56,6 +75,15 @@ void LedDevice::start()
 		connect(_refreshTimer, &QTimer::timeout, this, &LedDevice::rewriteLEDs );
 	}
 
+	// setup latchTimer, writes an update deferred to the end of the latch time
+	if ( _latchTimer == nullptr )
+	{
+		_latchTimer = new QTimer(this);
+		_latchTimer->setTimerType(Qt::PreciseTimer);
+		_latchTimer->setSingleShot(true);
+		connect(_latchTimer, &QTimer::timeout, this, &LedDevice::writeDeferredLeds );
+	}
+
 	close();
 
 	_isDeviceInitialised = false;
@@ -72,6 +100,8 @@ void LedDevice::stop()
 {
 	this->disable();
 	this->stopRefreshTimer();
+	this->cancelDeferredWrite();
+	_queuedLedValues.clear();
 	Info(_log, " Stopped LedDevice '%s'", QSTRING_CSTR(_activeDeviceType) );
 }
 
@@ -97,6 +127,7 @@ void LedDevice::setInError(const QString& errorMsg)
 	_isDeviceReady = false;
 	_isEnabled = false;
 	this->stopRefreshTimer();
+	this->cancelDeferredWrite();
 
 	Error(_log, "Device disabled, device '%s' signals error: '%s'", QSTRING_CSTR(_activeDeviceType), QSTRING_CSTR(errorMsg));
 	emit enableStateChanged(_isEnabled);
@@ -130,6 +161,7 @@ void LedDevice::disable()
 	{
 		_isEnabled = false;
 		this->stopRefreshTimer();
+		this->cancelDeferredWrite();
 
 		switchOff();
 		close();
@@ -140,6 +172,8 @@ void LedDevice::disable()
 
 void LedDevice::setActiveDeviceType(const QString& deviceType)
 {
+	// the type is part of the statistics, which are read by other threads
+	QMutexLocker lock(&_statisticsMutex);
 	_activeDeviceType = deviceType;
 }
 
@@ -172,6 +206,54 @@ void LedDevice::stopRefreshTimer()
 	}
 }
 
+void LedDevice::queueLeds(const std::vector<ColorRgb>& ledValues)
+{
+	_queuedFrames.fetch_add(1, std::memory_order_relaxed);
+
+	// a write is requested only if none is pending, a pending one takes the latest values
+	if (_queuedLedValues.put(ledValues))
+	{
+		QMetaObject::invokeMethod(this, "processQueuedLeds", Qt::QueuedConnection);
+	}
+}
+
+void LedDevice::processQueuedLeds()
+{
+	if (_queuedLedValues.take(_takenLedValues))
+	{
+		updateLeds(_takenLedValues);
+	}
+}
+
+QJsonObject LedDevice::getStatistics() const
+{
+	QJsonObject statistics;
+	statistics["queuedFrames"] = static_cast<double>(_queuedFrames.load(std::memory_order_relaxed));
+
+	QMutexLocker lock(&_statisticsMutex);
+	statistics["type"] = _activeDeviceType;
+	statistics["droppedFrames"] = static_cast<double>(_queuedLedValues.dropped() + _replacedDeferredFrames);
+	statistics["deferredFrames"] = static_cast<double>(_deferredFrames);
+	statistics["writtenFrames"] = static_cast<double>(_writtenFrames);
+	statistics["meanWriteMicros"] = _writtenFrames > 0 ? static_cast<double>(_writeMicrosSum) / _writtenFrames : 0.0;
+	statistics["maxWriteMicros"] = static_cast<double>(_maxWriteMicros);
+
+	QJsonArray histogram;
+	for (size_t i = 0; i < _writeLatencyHistogram.size(); ++i)
+	{
+		QJsonObject range;
+		if (i < WRITE_LATENCY_RANGES - 1)
+		{
+			range["maxMillis"] = WRITE_LATENCY_BOUNDS[i];
+		}
+		range["writes"] = static_cast<double>(_writeLatencyHistogram[i]);
+		histogram.append(range);
+	}
+	statistics["writeLatency"] = histogram;
+
+	return statistics;
+}
+
 int LedDevice::updateLeds(const std::vector<ColorRgb>& ledValues)
 {
 	int retval = 0;
@@ -182,12 +264,33 @@ int LedDevice::updateLeds(const std::vector<ColorRgb>& ledValues)
 	}
 	else
 	{
-		qint64 elapsedTimeMs = _lastWriteTime.msecsTo( QDateTime::currentDateTime() );
-		if (_latchTime_ms == 0 || elapsedTimeMs >= _latchTime_ms)
+		// the latch time is measured on the monotonic clock, independent of wall clock adjustments
+		const qint64 latchNanos = static_cast<qint64>(_latchTime_ms) * 1000000;
+		const qint64 elapsedNanos = _lastWriteClock.isValid() ? _lastWriteClock.nsecsElapsed() : latchNanos;
+		if (elapsedNanos >= latchNanos)
 		{
-			//std::cout << "LedDevice::updateLeds(), Elapsed time since last write (" << elapsedTimeMs << ") ms > _latchTime_ms (" << _latchTime_ms << ") ms" << std::endl;
+			//std::cout << "LedDevice::updateLeds(), Elapsed time since last write (" << elapsedNanos / 1000000 << ") ms > _latchTime_ms (" << _latchTime_ms << ") ms" << std::endl;
+			QElapsedTimer writeTimer;
+			writeTimer.start();
 			retval = write(ledValues);
+			const qint64 writeMicros = writeTimer.nsecsElapsed() / 1000;
+			_lastWriteClock.start();
 			_lastWriteTime = QDateTime::currentDateTime();
+			_isWriteDeferred = false;
+
+			{
+				QMutexLocker lock(&_statisticsMutex);
+				++_writtenFrames;
+				_writeMicrosSum += writeMicros;
+				_maxWriteMicros = qMax(_maxWriteMicros, static_cast<int64_t>(writeMicros));
+
+				size_t range = 0;
+				while (range < WRITE_LATENCY_RANGES - 1 && writeMicros >= 1000 * WRITE_LATENCY_BOUNDS[range])
+				{
+					++range;
+				}
+				++_writeLatencyHistogram[range];
+			}
 
 			// if device requires refreshing, save Led-Values and restart the timer
 			if ( _isRefreshEnabled && _isEnabled )
@@ -198,17 +301,56 @@ int LedDevice::updateLeds(const std::vector<ColorRgb>& ledValues)
 		}
 		else
 		{
-			//std::cout << "LedDevice::updateLeds(), Skip write. elapsedTime (" << elapsedTimeMs << ") ms < _latchTime_ms (" << _latchTime_ms << ") ms" << std::endl;
+			//std::cout << "LedDevice::updateLeds(), Defer write. elapsedTime (" << elapsedNanos / 1000000 << ") ms < _latchTime_ms (" << _latchTime_ms << ") ms" << std::endl;
 			if ( _isRefreshEnabled )
 			{
 				//Stop timer to allow for next non-refresh update
 				this->stopRefreshTimer();
 			}
+
+			// the latest values are written at the end of the latch time instead of being dropped
+			if ( &ledValues != &_deferredLedValues )
+			{
+				QMutexLocker lock(&_statisticsMutex);
+				if ( _isWriteDeferred )
+				{
+					++_replacedDeferredFrames;
+				}
+				else
+				{
+					++_deferredFrames;
+				}
+				_deferredLedValues = ledValues;
+			}
+			_isWriteDeferred = true;
+
+			if ( !_latchTimer->isActive() )
+			{
+				// round up, the timer must not fire before the latch time is over
+				_latchTimer->start( static_cast<int>((latchNanos - elapsedNanos + 999999) / 1000000) );
+			}
 		}
 	}
 	return retval;
 }
 
+void LedDevice::writeDeferredLeds()
+{
+	if ( _isWriteDeferred )
+	{
+		updateLeds(_deferredLedValues);
+	}
+}
+
+void LedDevice::cancelDeferredWrite()
+{
+	if ( _latchTimer != nullptr )
+	{
+		_latchTimer->stop();
+	}
+	_isWriteDeferred = false;
+}
+
 int LedDevice::rewriteLEDs()
 {
 	int retval = -1;
@@ -224,6 +366,7 @@ int LedDevice::rewriteLEDs()
 //				//:TESTING:
 
 		retval = write(_lastLedValues);
+		_lastWriteClock.start();
 		_lastWriteTime = QDateTime::currentDateTime();
 	}
 	else
@@ -22,6 +22,7 @@ LedDeviceWrapper::LedDeviceWrapper(Hyperion* hyperion)
 	: QObject(hyperion)
 	, _hyperion(hyperion)
 	, _ledDevice(nullptr)
+	, _ledDeviceLock()
 	, _enabled(false)
 {
 	// prepare the device constructor map
@@ -50,14 +51,16 @@ void LedDeviceWrapper::createLedDevice(const QJsonObject& config)
 	// create thread and device
 	QThread* thread = new QThread(this);
 	thread->setObjectName("LedDeviceThread");
-	_ledDevice = LedDeviceFactory::construct(config);
-	_ledDevice->moveToThread(thread);
+	LedDevice* ledDevice = LedDeviceFactory::construct(config);
+	ledDevice->moveToThread(thread);
+	{
+		QMutexLocker lock(&_ledDeviceLock);
+		_ledDevice = ledDevice;
+	}
 	// setup thread management
 	connect(thread, &QThread::started, _ledDevice, &LedDevice::start);
 
 	// further signals
-	connect(this, &LedDeviceWrapper::updateLeds, _ledDevice, &LedDevice::updateLeds, Qt::QueuedConnection);
-
 	connect(this, &LedDeviceWrapper::enable, _ledDevice, &LedDevice::enable);
 	connect(this, &LedDeviceWrapper::disable, _ledDevice, &LedDevice::disable);
 
@@ -151,6 +154,21 @@ unsigned int LedDeviceWrapper::getLedCount() const
 	return value;
 }
 
+QJsonObject LedDeviceWrapper::getStatistics() const
+{
+	QMutexLocker lock(&_ledDeviceLock);
+	return _ledDevice != nullptr ? _ledDevice->getStatistics() : QJsonObject();
+}
+
+void LedDeviceWrapper::updateLeds(const std::vector<ColorRgb>& ledValues)
+{
+	QMutexLocker lock(&_ledDeviceLock);
+	if (_ledDevice != nullptr)
+	{
+		_ledDevice->queueLeds(ledValues);
+	}
+}
+
 bool LedDeviceWrapper::enabled() const
 {
 	return _enabled;
@@ -193,14 +211,21 @@ void LedDeviceWrapper::stopDeviceThread()
 	// turns the LEDs off & stop refresh timers
 	emit stopLedDevice();
 
+	// no more LED values are handed to the device
+	LedDevice* ledDevice;
+	{
+		QMutexLocker lock(&_ledDeviceLock);
+		ledDevice = _ledDevice;
+		_ledDevice = nullptr;
+	}
+
 	// get current thread
-	QThread* oldThread = _ledDevice->thread();
+	QThread* oldThread = ledDevice->thread();
 	disconnect(oldThread, nullptr, nullptr, nullptr);
 	oldThread->quit();
 	oldThread->wait();
 	delete oldThread;
 
-	disconnect(_ledDevice, nullptr, nullptr, nullptr);
-	delete _ledDevice;
-	_ledDevice = nullptr;
+	disconnect(ledDevice, nullptr, nullptr, nullptr);
+	delete ledDevice;
 }
@@ -0,0 +1,117 @@
+// Local Hyperion includes
+#include "DmxOutputMap.h"
+
+// STL includes
+#include <algorithm>
+
+// Qt includes
+#include <QJsonObject>
+
+bool DmxOutputMap::build(const QJsonArray& outputs, int ledCount, int universe, int channelsPerFixture, QString& error)
+{
+	_universes.clear();
+	_channelRuns.clear();
+
+	if (channelsPerFixture < 3 || channelsPerFixture > UNIVERSE_CHANNELS)
+	{
+		error = QString("Invalid channels per fixture [%1]!").arg(channelsPerFixture);
+		return false;
+	}
+
+	if (outputs.isEmpty())
+	{
+		addOutput(QString(), 0, universe, 1, 0, ledCount, channelsPerFixture);
+		return true;
+	}
+
+	for (const QJsonValue& value : outputs)
+	{
+		const QJsonObject output = value.toObject();
+		const int firstLed = output["firstLed"].toInt(0);
+		const int startChannel = output["startChannel"].toInt(1);
+		const int port = output["port"].toInt(0);
+
+		if (firstLed < 0 || firstLed >= ledCount)
+		{
+			error = QString("Output LED [%1] is not in the range of the %2 LEDs!").arg(firstLed).arg(ledCount);
+			return false;
+		}
+		if (startChannel < 1 || startChannel > UNIVERSE_CHANNELS)
+		{
+			error = QString("Invalid output start channel [%1]!").arg(startChannel);
+			return false;
+		}
+		if (port < 0 || port > 65535)
+		{
+			error = QString("Invalid output port [%1]!").arg(port);
+			return false;
+		}
+
+		// a LED count of 0 maps the remaining LEDs
+		int outputLedCount = output["ledCount"].toInt(0);
+		if (outputLedCount <= 0 || firstLed + outputLedCount > ledCount)
+		{
+			outputLedCount = ledCount - firstLed;
+		}
+
+		addOutput(output["host"].toString().trimmed(), port, output["universe"].toInt(universe), startChannel, firstLed, outputLedCount, channelsPerFixture);
+	}
+	return true;
+}
+
+void DmxOutputMap::addOutput(const QString& host, int port, int universe, int startChannel, int firstLed, int ledCount, int channelsPerFixture)
+{
+	if (ledCount <= 0)
+	{
+		return;
+	}
+
+	const size_t first = 3 * static_cast<size_t>(firstLed);
+	const size_t count = 3 * static_cast<size_t>(ledCount);
+
+	int dmxIdx = startChannel - 1;		// offset into the current universe
+	size_t index = universeIndex(host, port, universe);
+
+	for (size_t rawIdx = 0; rawIdx < count; ++rawIdx)
+	{
+		if (dmxIdx >= UNIVERSE_CHANNELS)
+		{
+			dmxIdx = 0;
+			index = universeIndex(host, port, ++universe);
+		}
+
+		// a channel continuing the previous one in the LED data and in the universe extends its run
+		ChannelRun* run = _channelRuns.empty() ? nullptr : &_channelRuns.back();
+		if (run != nullptr && run->universe == index && run->source + run->length == first + rawIdx && run->offset + run->length == static_cast<size_t>(dmxIdx))
+		{
+			++run->length;
+		}
+		else
+		{
+			_channelRuns.push_back({first + rawIdx, index, static_cast<size_t>(dmxIdx), 1});
+		}
+
+		++dmxIdx;
+		if (rawIdx % 3 == 2)
+		{
+			dmxIdx += channelsPerFixture - 3;
+		}
+
+		Universe& target = _universes[index];
+		target.channelCount = std::max(target.channelCount, std::min(dmxIdx, UNIVERSE_CHANNELS));
+	}
+}
+
+size_t DmxOutputMap::universeIndex(const QString& host, int port, int universe)
+{
+	for (size_t i = 0; i < _universes.size(); ++i)
+	{
+		if (_universes[i].universe == universe && _universes[i].port == port && _universes[i].host == host)
+		{
+			return i;
+		}
+	}
+
+	_universes.push_back({host, port, universe, 0});
+	return _universes.size() - 1;
+}
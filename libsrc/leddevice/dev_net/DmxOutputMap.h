@@ -0,0 +1,83 @@
+#ifndef DMXOUTPUTMAP_H
+#define DMXOUTPUTMAP_H
+
+// STL includes
+#include <cstddef>
+#include <vector>
+
+// Qt includes
+#include <QJsonArray>
+#include <QString>
+
+///
+/// The DmxOutputMap distributes the LED channels of a DMX over IP device (E1.31, Art-Net) to the universes of
+/// one or several controllers. Every output maps a range of LEDs to a host, a universe and a start channel, the
+/// channels continue in the following universes of the host. Outputs may share a universe.
+///
+/// Without outputs configured, all LEDs are sent to consecutive universes of the device host as before.
+///
+class DmxOutputMap
+{
+public:
+	/// The number of channels of a universe
+	static const int UNIVERSE_CHANNELS = 512;
+
+	/// A universe of a host
+	struct Universe
+	{
+		/// The host, empty for the device host
+		QString host;
+		/// The port, 0 for the device port
+		int port;
+		int universe;
+		/// The number of channels up to the last channel used
+		int channelCount;
+	};
+
+	/// Consecutive channels copied from the LED data into a universe
+	struct ChannelRun
+	{
+		/// The offset in the LED data
+		size_t source;
+		/// The index of the universe in universes()
+		size_t universe;
+		/// The offset of the first channel in the universe
+		size_t offset;
+		size_t length;
+	};
+
+	///
+	/// @brief Build the map from the "outputs" configuration
+	///
+	/// @param[in]  outputs            The outputs, empty to send all LEDs to the device host
+	/// @param[in]  ledCount           The number of LEDs
+	/// @param[in]  universe           The first universe of the device host, if no outputs are configured
+	/// @param[in]  channelsPerFixture The channels of a fixture, the LED colors are written to the first three
+	/// @param[out] error              The reason, if the outputs are invalid
+	///
+	/// @return True, if success
+	///
+	bool build(const QJsonArray& outputs, int ledCount, int universe, int channelsPerFixture, QString& error);
+
+	/// @return The universes in the order of their first use
+	const std::vector<Universe>& universes() const { return _universes; }
+
+	/// @return The channel runs
+	const std::vector<ChannelRun>& channelRuns() const { return _channelRuns; }
+
+private:
+	///
+	/// @brief Map a range of LEDs starting at a channel of a universe
+	///
+	void addOutput(const QString& host, int port, int universe, int startChannel, int firstLed, int ledCount, int channelsPerFixture);
+
+	///
+	/// @return The index of the universe of a host, which is added if new
+	///
+	size_t universeIndex(const QString& host, int port, int universe);
+
+	std::vector<Universe> _universes;
+	std::vector<ChannelRun> _channelRuns;
+};
+
+#endif // DMXOUTPUTMAP_H
@@ -9,6 +9,10 @@
 
 #include <QHostInfo>
 
+// STL includes
+#include <algorithm>
+#include <cstring>
+
 const ushort ARTNET_DEFAULT_PORT = 6454;
 
 LedDeviceUdpArtNet::LedDeviceUdpArtNet(const QJsonObject &deviceConfig)
@@ -32,14 +36,20 @@ bool LedDeviceUdpArtNet::init(const QJsonObject &deviceConfig)
 	{
 		_artnet_universe = deviceConfig["universe"].toInt(1);
 		_artnet_channelsPerFixture = deviceConfig["channelsPerFixture"].toInt(3);
+		_artnet_sync = deviceConfig["sync"].toBool(false);
 
-		isInitOK = true;
+		QString errortext;
+		isInitOK = _outputMap.build(deviceConfig["outputs"].toArray(), static_cast<int>(_ledCount), _artnet_universe, _artnet_channelsPerFixture, errortext) && preparePackets();
+		if (!isInitOK && !_isDeviceInError)
+		{
+			this->setInError(errortext);
+		}
 	}
 	return isInitOK;
 }
 
 // populates the headers
-void LedDeviceUdpArtNet::prepare(unsigned this_universe, unsigned this_sequence, unsigned this_dmxChannelCount)
+void LedDeviceUdpArtNet::prepare(artnet_packet_t& packet, unsigned this_universe, unsigned this_sequence, unsigned this_dmxChannelCount)
 {
 // WTF? why do the specs say:
 // "This value should be an even number in the range 2 – 512. "
@@ -48,21 +58,63 @@ void LedDeviceUdpArtNet::prepare(unsigned this_universe, unsigned this_sequence,
 		this_dmxChannelCount++;
 	}
 
-	memcpy (artnet_packet.ID, "Art-Net\0", 8);
+	memcpy (packet.ID, "Art-Net\0", 8);
 
-	artnet_packet.OpCode	= htons(0x0050);	// OpOutput / OpDmx
-	artnet_packet.ProtVer	= htons(0x000e);
-	artnet_packet.Sequence	= this_sequence;
-	artnet_packet.Physical	= 0;
-	artnet_packet.SubUni	= this_universe & 0xff ;
-	artnet_packet.Net	= (this_universe >> 8) & 0x7f;
-	artnet_packet.Length	= htons(this_dmxChannelCount);
+	packet.OpCode	= htons(0x0050);	// OpOutput / OpDmx
+	packet.ProtVer	= htons(0x000e);
+	packet.Sequence	= this_sequence;
+	packet.Physical	= 0;
+	packet.SubUni	= this_universe & 0xff ;
+	packet.Net	= (this_universe >> 8) & 0x7f;
+	packet.Length	= htons(this_dmxChannelCount);
+}
+
+bool LedDeviceUdpArtNet::preparePackets()
+{
+	const std::vector<DmxOutputMap::Universe>& universes = _outputMap.universes();
+
+	_artnet_packets.resize(universes.size());
+	_datagrams.clear();
+
+	std::vector<int> targets;
+	for (size_t i = 0; i < universes.size(); ++i)
+	{
+		const int target = addTarget(universes[i].host, universes[i].port);
+		if (target < 0)
+		{
+			return false;
+		}
+		if (std::find(targets.begin(), targets.end(), target) == targets.end())
+		{
+			targets.push_back(target);
+		}
+
+		// the length is even, the padding channel is sent as well
+		const unsigned dmxChannelCount = qMin((universes[i].channelCount + 1) & ~1, DMX_MAX);
+		memset(_artnet_packets[i].raw, 0, sizeof(_artnet_packets[i].raw));
+		prepare(_artnet_packets[i], universes[i].universe, _artnet_seq, dmxChannelCount);
+		_datagrams.push_back({_artnet_packets[i].raw, 18 + dmxChannelCount, target});
+	}
+
+	if (_artnet_sync)
+	{
+		memset(_artsync_packet.raw, 0, sizeof(_artsync_packet.raw));
+		memcpy (_artsync_packet.ID, "Art-Net\0", 8);
+		_artsync_packet.OpCode	= htons(0x0052);	// OpSync
+		_artsync_packet.ProtVer	= htons(0x000e);
+
+		// ArtSync is sent to every node, which received universes
+		for (int target : targets)
+		{
+			_datagrams.push_back({_artsync_packet.raw, sizeof(_artsync_packet.raw), target});
+		}
+		Debug(_log, "Art-Net %u universes on %u hosts synchronized by ArtSync", static_cast<unsigned>(universes.size()), static_cast<unsigned>(targets.size()));
+	}
+	return true;
 }
 
 int LedDeviceUdpArtNet::write(const std::vector<ColorRgb> &ledValues)
 {
-	int retVal            = 0;
-	int thisUniverse	= _artnet_universe;
 	const uint8_t * rawdata = reinterpret_cast<const uint8_t *>(ledValues.data());
 
 /*
@@ -74,30 +126,15 @@ The Sequence field is set to 0x00 to disable this feature.
 		_artnet_seq = 1;
 	}
 
-	int dmxIdx = 0;			// offset into the current dmx packet
-
-	memset(artnet_packet.raw, 0, sizeof(artnet_packet.raw));
-	for (unsigned int ledIdx = 0; ledIdx < _ledRGBCount; ledIdx++)
+	for (artnet_packet_t& packet : _artnet_packets)
 	{
+		packet.Sequence = _artnet_seq;
+	}
 
-		artnet_packet.Data[dmxIdx++] = rawdata[ledIdx];
-		if ( (ledIdx % 3 == 2) && (ledIdx > 0) )
-		{
-			dmxIdx += (_artnet_channelsPerFixture-3);
-		}
-
-//     is this the   last byte of last packet   ||   last byte of other packets
-		if ( (ledIdx == _ledRGBCount-1) || (dmxIdx >= DMX_MAX) )
-		{
-			prepare(thisUniverse, _artnet_seq, dmxIdx);
-			retVal &= writeBytes(18 + qMin(dmxIdx, DMX_MAX), artnet_packet.raw);
-
-			memset(artnet_packet.raw, 0, sizeof(artnet_packet.raw));
-			thisUniverse ++;
-			dmxIdx = 0;
-		}
-
+	for (const DmxOutputMap::ChannelRun& run : _outputMap.channelRuns())
+	{
+		memcpy(&_artnet_packets[run.universe].Data[run.offset], rawdata + run.source, run.length);
 	}
 
-	return retVal;
+	return writeDatagrams(_datagrams);
 }
@@ -3,6 +3,7 @@
 
 // hyperion includes
 #include "ProviderUdp.h"
+#include "DmxOutputMap.h"
 
 #include <QUuid>
 
@@ -37,6 +38,23 @@ typedef union
 
 } artnet_packet_t;
 
+// ArtSync, the nodes output the ArtDmx data received before
+typedef union
+{
+#pragma pack(push, 1)
+	struct {
+		char		ID[8];		// "Art-Net"
+		uint16_t	OpCode;		// 0x5200 OpSync
+		uint16_t	ProtVer;	// 0x0e00 (aka 14)
+		uint8_t		Aux1;		// 0x00
+		uint8_t		Aux2;		// 0x00
+	};
+#pragma pack(pop)
+
+	uint8_t raw[ 14 ];
+
+} artsync_packet_t;
+
 ///
 /// Implementation of the LedDevice interface for sending LED colors to an Art-Net LED-device via UDP
 ///
@@ -80,9 +98,26 @@ private:
 	///
 	/// @brief Generate Art-Net communication header
 	///
-	void prepare(unsigned this_universe, unsigned this_sequence, unsigned this_dmxChannelCount);
+	void prepare(artnet_packet_t& packet, unsigned this_universe, unsigned this_sequence, unsigned this_dmxChannelCount);
+
+	///
+	/// @brief Generate the packets of all universes and the ArtSync packet,
+	/// a write only updates the sequence and the channel data
+	///
+	/// @return True, if success
+	///
+	bool preparePackets();
+
+	/// The LED channels of the universes
+	DmxOutputMap _outputMap;
+
+	/// The packet of every universe and their datagrams, sent as one batch followed by the ArtSync packets
+	std::vector<artnet_packet_t> _artnet_packets;
+	artsync_packet_t _artsync_packet;
+	std::vector<Datagram> _datagrams;
 
-	artnet_packet_t artnet_packet;
+	/// Whether an ArtSync is sent to every host after the universes
+	bool _artnet_sync = false;
 	uint8_t _artnet_seq = 1;
 	int _artnet_channelsPerFixture = 3;
 	int _artnet_universe = 1;
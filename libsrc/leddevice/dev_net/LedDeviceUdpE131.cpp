@@ -6,6 +6,10 @@
 
 #include <QHostInfo>
 
+// STL includes
+#include <algorithm>
+#include <cstring>
+
 // hyperion local includes
 #include "LedDeviceUdpE131.h"
 
@@ -13,10 +17,10 @@ const ushort E131_DEFAULT_PORT = 5568;
 
 /* defined parameters from http://tsp.esta.org/tsp/documents/docs/BSR_E1-31-20xx_CP-2014-1009r2.pdf */
 const uint32_t VECTOR_ROOT_E131_DATA = 0x00000004;
-//#define VECTOR_ROOT_E131_EXTENDED               0x00000008
+const uint32_t VECTOR_ROOT_E131_EXTENDED = 0x00000008;
 const uint8_t VECTOR_DMP_SET_PROPERTY = 0x02;
 const uint32_t VECTOR_E131_DATA_PACKET = 0x00000002;
-//#define VECTOR_E131_EXTENDED_SYNCHRONIZATION    0x00000001
+const uint32_t VECTOR_E131_EXTENDED_SYNCHRONIZATION = 0x00000001;
 //#define VECTOR_E131_EXTENDED_DISCOVERY          0x00000002
 //#define VECTOR_UNIVERSE_DISCOVERY_UNIVERSE_LIST 0x00000001
 //#define E131_E131_UNIVERSE_DISCOVERY_INTERVAL   10         // seconds
@@ -37,6 +41,7 @@ LedDevice* LedDeviceUdpE131::construct(const QJsonObject &deviceConfig)
 bool LedDeviceUdpE131::init(const QJsonObject &deviceConfig)
 {
 	bool isInitOK = false;
+	QString errortext;
 
 	_port = E131_DEFAULT_PORT;
 
@@ -44,6 +49,7 @@ bool LedDeviceUdpE131::init(const QJsonObject &deviceConfig)
 	if ( ProviderUdp::init(deviceConfig) )
 	{
 		_e131_universe = deviceConfig["universe"].toInt(1);
+		_e131_sync_universe = deviceConfig["syncUniverse"].toInt(0);
 		_e131_source_name = deviceConfig["source-name"].toString("hyperion on "+QHostInfo::localHostName());
 		QString _json_cid = deviceConfig["cid"].toString("");
 
@@ -66,82 +72,118 @@ bool LedDeviceUdpE131::init(const QJsonObject &deviceConfig)
 				this->setInError("CID configured is not a valid UUID. Format expected is \"xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx\"");
 			}
 		}
+
+		if (isInitOK)
+		{
+			isInitOK = _outputMap.build(deviceConfig["outputs"].toArray(), static_cast<int>(_ledCount), _e131_universe, 3, errortext) && preparePackets();
+			if (!isInitOK && !_isDeviceInError)
+			{
+				this->setInError(errortext);
+			}
+		}
 	}
 	return isInitOK;
 }
 
 // populates the headers
-void LedDeviceUdpE131::prepare(unsigned this_universe, unsigned this_dmxChannelCount)
+void LedDeviceUdpE131::prepare(e131_packet_t& packet, unsigned this_universe, unsigned this_dmxChannelCount)
 {
-	memset(e131_packet.raw, 0, sizeof(e131_packet.raw));
+	memset(packet.raw, 0, sizeof(packet.raw));
 
 	/* Root Layer */
-	e131_packet.preamble_size = htons(16);
-	e131_packet.postamble_size = 0;
-	memcpy (e131_packet.acn_id, _acn_id, 12);
-	e131_packet.root_flength = htons(0x7000 | (110+this_dmxChannelCount) );
-	e131_packet.root_vector = htonl(VECTOR_ROOT_E131_DATA);
-	memcpy (e131_packet.cid, _e131_cid.toRfc4122().constData() , sizeof(e131_packet.cid) );
+	packet.preamble_size = htons(16);
+	packet.postamble_size = 0;
+	memcpy (packet.acn_id, _acn_id, 12);
+	packet.root_flength = htons(0x7000 | (110+this_dmxChannelCount) );
+	packet.root_vector = htonl(VECTOR_ROOT_E131_DATA);
+	memcpy (packet.cid, _e131_cid.toRfc4122().constData() , sizeof(packet.cid) );
 
 	/* Frame Layer */
-	e131_packet.frame_flength = htons(0x7000 | (88+this_dmxChannelCount));
-	e131_packet.frame_vector = htonl(VECTOR_E131_DATA_PACKET);
-	snprintf (e131_packet.source_name, sizeof(e131_packet.source_name), "%s", QSTRING_CSTR(_e131_source_name) );
-	e131_packet.priority = 100;
-	e131_packet.reserved = htons(0);
-	e131_packet.options = 0;	// Bit 7 =  Preview_Data
-					// Bit 6 =  Stream_Terminated
-					// Bit 5 = Force_Synchronization
-	e131_packet.universe = htons(this_universe);
+	packet.frame_flength = htons(0x7000 | (88+this_dmxChannelCount));
+	packet.frame_vector = htonl(VECTOR_E131_DATA_PACKET);
+	snprintf (packet.source_name, sizeof(packet.source_name), "%s", QSTRING_CSTR(_e131_source_name) );
+	packet.priority = 100;
+	packet.sync_address = htons(_e131_sync_universe);
+	packet.options = 0;	// Bit 7 =  Preview_Data
+				// Bit 6 =  Stream_Terminated
+				// Bit 5 = Force_Synchronization
+	packet.universe = htons(this_universe);
 
 	/* DMX Layer */
-	e131_packet.dmp_flength = htons(0x7000 | (11+this_dmxChannelCount));
-	e131_packet.dmp_vector = VECTOR_DMP_SET_PROPERTY;
-	e131_packet.type = 0xa1;
-	e131_packet.first_address = htons(0);
-	e131_packet.address_increment = htons(1);
-	e131_packet.property_value_count = htons(1+this_dmxChannelCount);
-
-	e131_packet.property_values[0] = 0;	// start code
+	packet.dmp_flength = htons(0x7000 | (11+this_dmxChannelCount));
+	packet.dmp_vector = VECTOR_DMP_SET_PROPERTY;
+	packet.type = 0xa1;
+	packet.first_address = htons(0);
+	packet.address_increment = htons(1);
+	packet.property_value_count = htons(1+this_dmxChannelCount);
+
+	packet.property_values[0] = 0;	// start code
 }
 
-int LedDeviceUdpE131::write(const std::vector<ColorRgb> &ledValues)
+bool LedDeviceUdpE131::preparePackets()
 {
-	int retVal            = 0;
-	int thisChannelCount = 0;
-	int dmxChannelCount  = _ledRGBCount;
-	const uint8_t * rawdata = reinterpret_cast<const uint8_t *>(ledValues.data());
+	const std::vector<DmxOutputMap::Universe>& universes = _outputMap.universes();
 
-	_e131_seq++;
+	_e131_packets.resize(universes.size());
+	_datagrams.clear();
 
-	for (int rawIdx = 0; rawIdx < dmxChannelCount; rawIdx++)
+	std::vector<int> targets;
+	for (size_t i = 0; i < universes.size(); ++i)
 	{
-		if (rawIdx % DMX_MAX == 0) // start of new packet
+		const int target = addTarget(universes[i].host, universes[i].port);
+		if (target < 0)
 		{
-			thisChannelCount = (dmxChannelCount - rawIdx < DMX_MAX) ? dmxChannelCount % DMX_MAX : DMX_MAX;
-//			                       is this the last packet?         ?       ^^ last packet      : ^^ earlier packets
-
-			prepare(_e131_universe + rawIdx / DMX_MAX, thisChannelCount);
-			e131_packet.sequence_number = _e131_seq;
+			return false;
+		}
+		if (std::find(targets.begin(), targets.end(), target) == targets.end())
+		{
+			targets.push_back(target);
 		}
 
-		e131_packet.property_values[1 + rawIdx%DMX_MAX] = rawdata[rawIdx];
+		const int thisChannelCount = universes[i].channelCount;
+		prepare(_e131_packets[i], universes[i].universe, thisChannelCount);
+		_datagrams.push_back({ _e131_packets[i].raw, E131_DMP_DATA + 1 + thisChannelCount, target });
+	}
 
-//     is this the      last byte of last packet    ||   last byte of other packets
-		if ( (rawIdx == dmxChannelCount-1) || (rawIdx %DMX_MAX == DMX_MAX-1) )
+	if (_e131_sync_universe > 0)
+	{
+		// the receivers present the universes on the synchronization packet, which is sent to every host
+		memset(_e131_sync_packet.raw, 0, sizeof(_e131_sync_packet.raw));
+		_e131_sync_packet.preamble_size = htons(16);
+		_e131_sync_packet.postamble_size = 0;
+		memcpy (_e131_sync_packet.acn_id, _acn_id, 12);
+		_e131_sync_packet.root_flength = htons(0x7000 | 33);
+		_e131_sync_packet.root_vector = htonl(VECTOR_ROOT_E131_EXTENDED);
+		memcpy (_e131_sync_packet.cid, _e131_cid.toRfc4122().constData() , sizeof(_e131_sync_packet.cid) );
+		_e131_sync_packet.frame_flength = htons(0x7000 | 11);
+		_e131_sync_packet.frame_vector = htonl(VECTOR_E131_EXTENDED_SYNCHRONIZATION);
+		_e131_sync_packet.sync_address = htons(_e131_sync_universe);
+
+		for (int target : targets)
 		{
-#undef e131debug
-#if e131debug
-			Debug (_log, "send packet: rawidx %d dmxchannelcount %d universe: %d, packetsz %d"
-				, rawIdx
-				, dmxChannelCount
-				, _e131_universe + rawIdx / DMX_MAX
-				, E131_DMP_DATA + 1 + thisChannelCount
-				);
-#endif
-			retVal &= writeBytes(E131_DMP_DATA + 1 + thisChannelCount, e131_packet.raw);
+			_datagrams.push_back({ _e131_sync_packet.raw, sizeof(_e131_sync_packet.raw), target });
 		}
+		Debug(_log, "e131 %u universes on %u hosts synchronized by universe %d", static_cast<unsigned>(universes.size()), static_cast<unsigned>(targets.size()), _e131_sync_universe);
+	}
+	return true;
+}
+
+int LedDeviceUdpE131::write(const std::vector<ColorRgb> &ledValues)
+{
+	const uint8_t * rawdata = reinterpret_cast<const uint8_t *>(ledValues.data());
+
+	_e131_seq++;
+	_e131_sync_packet.sequence_number = _e131_sync_seq++;
+
+	for (e131_packet_t& packet : _e131_packets)
+	{
+		packet.sequence_number = _e131_seq;
+	}
+
+	for (const DmxOutputMap::ChannelRun& run : _outputMap.channelRuns())
+	{
+		memcpy(&_e131_packets[run.universe].property_values[1 + run.offset], rawdata + run.source, run.length);
 	}
 
-	return retVal;
+	return writeDatagrams(_datagrams);
 }
@@ -3,6 +3,7 @@
 
 // hyperion includes
 #include "ProviderUdp.h"
+#include "DmxOutputMap.h"
 
 #include <QUuid>
 
@@ -63,7 +64,7 @@ typedef union
 		uint32_t frame_vector;
 		char     source_name[64];
 		uint8_t  priority;
-		uint16_t reserved;
+		uint16_t sync_address;	// E1.31-2016, reserved before
 		uint8_t  sequence_number;
 		uint8_t  options;
 		uint16_t universe;
@@ -82,6 +83,32 @@ typedef union
 	uint8_t raw[638];
 } e131_packet_t;
 
+/* E1.31 Synchronization Packet Structure */
+typedef union
+{
+#pragma pack(push, 1)
+	struct
+	{
+		/* Root Layer */
+		uint16_t preamble_size;
+		uint16_t postamble_size;
+		uint8_t  acn_id[12];
+		uint16_t root_flength;
+		uint32_t root_vector;
+		char     cid[16];
+
+		/* Frame Layer */
+		uint16_t frame_flength;
+		uint32_t frame_vector;
+		uint8_t  sequence_number;
+		uint16_t sync_address;
+		uint16_t reserved;
+	};
+#pragma pack(pop)
+
+	uint8_t raw[49];
+} e131_sync_packet_t;
+
 ///
 /// Implementation of the LedDevice interface for sending led colors via udp/E1.31 packets
 ///
@@ -125,11 +152,28 @@ private:
 	///
 	/// @brief Generate E1.31 communication header
 	///
-	void prepare(unsigned this_universe, unsigned this_dmxChannelCount);
+	void prepare(e131_packet_t& packet, unsigned this_universe, unsigned this_dmxChannelCount);
+
+	///
+	/// @brief Generate the packets of all universes and the synchronization packet,
+	/// a write only updates the sequence numbers and the channel data
+	///
+	/// @return True, if success
+	///
+	bool preparePackets();
+
+	/// The LED channels of the universes
+	DmxOutputMap _outputMap;
 
-	e131_packet_t e131_packet;
+	/// The packet of every universe and their datagrams, sent as one batch followed by the synchronization packets
+	std::vector<e131_packet_t> _e131_packets;
+	e131_sync_packet_t _e131_sync_packet;
+	std::vector<Datagram> _datagrams;
 	uint8_t _e131_seq = 0;
-	uint8_t _e131_universe = 1;
+	uint8_t _e131_sync_seq = 0;
+	int _e131_universe = 1;
+	/// The universe of the synchronization packets, 0 without synchronization
+	int _e131_sync_universe = 0;
 	uint8_t _acn_id[12] = {0x41, 0x53, 0x43, 0x2d, 0x45, 0x31, 0x2e, 0x31, 0x37, 0x00, 0x00, 0x00 };
 	QString _e131_source_name;
 	QUuid _e131_cid;
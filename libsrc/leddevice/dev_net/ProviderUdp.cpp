@@ -5,6 +5,11 @@
 #include <exception>
 // Linux includes
 #include <fcntl.h>
+#ifdef __linux__
+	#include <cerrno>
+	#include <net/if.h>
+	#include <netinet/in.h>
+#endif
 
 #include <QStringList>
 #include <QUdpSocket>
@@ -37,28 +42,9 @@ bool ProviderUdp::init(const QJsonObject& deviceConfig)
 	if (LedDevice::init(deviceConfig))
 	{
 		QString host = deviceConfig["host"].toString(_defaultHost);
+		_targets.clear();
 
-		if (_address.setAddress(host))
-		{
-			Debug(_log, "Successfully parsed %s as an IP-address.", QSTRING_CSTR(_address.toString()));
-		}
-		else
-		{
-			QHostInfo hostInfo = QHostInfo::fromName(host);
-			if (hostInfo.error() == QHostInfo::NoError)
-			{
-				_address = hostInfo.addresses().first();
-				Debug(_log, "Successfully resolved IP-address (%s) for hostname (%s).", QSTRING_CSTR(_address.toString()), QSTRING_CSTR(host));
-			}
-			else
-			{
-				QString errortext = QString("Failed resolving IP-address for [%1], (%2) %3").arg(host).arg(hostInfo.error()).arg(hostInfo.errorString());
-				this->setInError(errortext);
-				isInitOK = false;
-			}
-		}
-
-		if (!_isDeviceInError)
+		if (resolveHostAddress(host, _address))
 		{
 			int config_port = deviceConfig["port"].toInt(_port);
 			if (config_port <= 0 || config_port > MAX_PORT)
@@ -81,10 +67,82 @@ bool ProviderUdp::init(const QJsonObject& deviceConfig)
 	return isInitOK;
 }
 
+bool ProviderUdp::resolveHostAddress(const QString& host, QHostAddress& address)
+{
+	bool isResolved = false;
+
+	if (address.setAddress(host))
+	{
+		Debug(_log, "Successfully parsed %s as an IP-address.", QSTRING_CSTR(address.toString()));
+		isResolved = true;
+	}
+	else
+	{
+		QHostInfo hostInfo = QHostInfo::fromName(host);
+		if (hostInfo.error() == QHostInfo::NoError)
+		{
+			address = hostInfo.addresses().first();
+			Debug(_log, "Successfully resolved IP-address (%s) for hostname (%s).", QSTRING_CSTR(address.toString()), QSTRING_CSTR(host));
+			isResolved = true;
+		}
+		else
+		{
+			QString errortext = QString("Failed resolving IP-address for [%1], (%2) %3").arg(host).arg(hostInfo.error()).arg(hostInfo.errorString());
+			this->setInError(errortext);
+		}
+	}
+	return isResolved;
+}
+
+int ProviderUdp::addTarget(const QHostAddress& address, quint16 port)
+{
+	if (address == _address && port == _port)
+	{
+		return 0;
+	}
+
+	for (size_t i = 0; i < _targets.size(); ++i)
+	{
+		if (_targets[i].address == address && _targets[i].port == port)
+		{
+			return static_cast<int>(i + 1);
+		}
+	}
+
+	Debug(_log, "UDP socket will write to %s:%u as well", QSTRING_CSTR(address.toString()), port);
+	_targets.push_back({address, port});
+#ifdef __linux__
+	_socketAddresses.clear();
+#endif
+	return static_cast<int>(_targets.size());
+}
+
+int ProviderUdp::addTarget(const QString& host, int port)
+{
+	QHostAddress address = _address;
+	if (!host.isEmpty() && !resolveHostAddress(host, address))
+	{
+		return -1;
+	}
+	return addTarget(address, (port > 0) ? static_cast<quint16>(port) : _port);
+}
+
+ProviderUdp::Target ProviderUdp::getTarget(int target) const
+{
+	if (target > 0 && static_cast<size_t>(target) <= _targets.size())
+	{
+		return _targets[static_cast<size_t>(target - 1)];
+	}
+	return {_address, _port};
+}
+
 int ProviderUdp::open()
 {
 	int retval = -1;
 	_isDeviceReady = false;
+#ifdef __linux__
+	_socketAddresses.clear();
+#endif
 
 	// Try to bind the UDP-Socket
 	if (_udpSocket != nullptr)
@@ -153,3 +211,137 @@ int ProviderUdp::writeBytes(const QByteArray& bytes)
 	}
 	return  rc;
 }
+
+int ProviderUdp::writeDatagrams(const std::vector<Datagram>& datagrams)
+{
+#ifdef __linux__
+	const int socketDescriptor = static_cast<int>(_udpSocket->socketDescriptor());
+	if (socketDescriptor >= 0 && (!_socketAddresses.empty() || resolveTargets(socketDescriptor)))
+	{
+		const size_t count = datagrams.size();
+		_messages.resize(count);
+		_vectors.resize(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const int target = (static_cast<size_t>(datagrams[i].target) < _socketAddresses.size()) ? datagrams[i].target : 0;
+			SocketAddress& socketAddress = _socketAddresses[static_cast<size_t>(target)];
+
+			_vectors[i].iov_base = const_cast<uint8_t*>(datagrams[i].data);
+			_vectors[i].iov_len = datagrams[i].size;
+
+			memset(&_messages[i], 0, sizeof(mmsghdr));
+			_messages[i].msg_hdr.msg_name = &socketAddress.address;
+			_messages[i].msg_hdr.msg_namelen = socketAddress.length;
+			_messages[i].msg_hdr.msg_iov = &_vectors[i];
+			_messages[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		// sendmmsg may return before all datagrams are sent, it stops at the first failing one
+		int result = 0;
+		size_t sent = 0;
+		while (sent < count)
+		{
+			const int rc = sendmmsg(socketDescriptor, &_messages[sent], static_cast<unsigned int>(count - sent), 0);
+			if (rc < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				// the failing datagram is skipped, the ones to other targets are sent anyway
+				const Target target = getTarget(datagrams[sent].target);
+				Warning(_log, "%s", QSTRING_CSTR(QString("(%1:%2) Write Error: (%3) %4").arg(target.address.toString()).arg(target.port).arg(errno).arg(strerror(errno))));
+				result = -1;
+				++sent;
+				continue;
+			}
+			sent += static_cast<size_t>(rc);
+		}
+		return result;
+	}
+#endif
+
+	int rc = 0;
+	for (const Datagram& datagram : datagrams)
+	{
+		const Target target = getTarget(datagram.target);
+		qint64 bytesWritten = _udpSocket->writeDatagram(reinterpret_cast<const char*>(datagram.data), datagram.size, target.address, target.port);
+
+		if (bytesWritten == -1 || bytesWritten != datagram.size)
+		{
+			Warning(_log, "%s", QSTRING_CSTR(QString("(%1:%2) Write Error: (%3) %4").arg(target.address.toString()).arg(target.port).arg(_udpSocket->error()).arg(_udpSocket->errorString())));
+			rc = -1;
+		}
+	}
+	return rc;
+}
+
+#ifdef __linux__
+bool ProviderUdp::resolveTargets(int socketDescriptor)
+{
+	sockaddr_storage local;
+	socklen_t localLength = sizeof(local);
+	if (getsockname(socketDescriptor, reinterpret_cast<sockaddr*>(&local), &localLength) != 0)
+	{
+		return false;
+	}
+
+	_socketAddresses.resize(_targets.size() + 1);
+	for (size_t i = 0; i < _socketAddresses.size(); ++i)
+	{
+		const Target target = getTarget(static_cast<int>(i));
+		SocketAddress& socketAddress = _socketAddresses[i];
+		memset(&socketAddress, 0, sizeof(socketAddress));
+
+		bool isIPv4 = false;
+		const quint32 ipv4 = target.address.toIPv4Address(&isIPv4);
+
+		if (local.ss_family == AF_INET && isIPv4)
+		{
+			sockaddr_in* address = reinterpret_cast<sockaddr_in*>(&socketAddress.address);
+			address->sin_family = AF_INET;
+			address->sin_port = htons(target.port);
+			address->sin_addr.s_addr = htonl(ipv4);
+			socketAddress.length = sizeof(sockaddr_in);
+		}
+		else if (local.ss_family == AF_INET6)
+		{
+			sockaddr_in6* address = reinterpret_cast<sockaddr_in6*>(&socketAddress.address);
+			address->sin6_family = AF_INET6;
+			address->sin6_port = htons(target.port);
+			if (isIPv4)
+			{
+				// a dual stack socket reaches IPv4 targets by their mapped address ::ffff:a.b.c.d
+				address->sin6_addr.s6_addr[10] = 0xff;
+				address->sin6_addr.s6_addr[11] = 0xff;
+				const uint32_t networkOrder = htonl(ipv4);
+				memcpy(&address->sin6_addr.s6_addr[12], &networkOrder, sizeof(networkOrder));
+			}
+			else
+			{
+				const Q_IPV6ADDR ipv6 = target.address.toIPv6Address();
+				memcpy(&address->sin6_addr, &ipv6, sizeof(address->sin6_addr));
+
+				const QString scopeId = target.address.scopeId();
+				bool isNumeric = false;
+				address->sin6_scope_id = scopeId.toUInt(&isNumeric);
+				if (!isNumeric && !scopeId.isEmpty())
+				{
+					address->sin6_scope_id = if_nametoindex(QSTRING_CSTR(scopeId));
+				}
+			}
+			socketAddress.length = sizeof(sockaddr_in6);
+		}
+
+		// a target the socket can not reach is written by Qt
+		if (socketAddress.length == 0)
+		{
+			_socketAddresses.clear();
+			return false;
+		}
+	}
+	return true;
+}
+#endif
@@ -11,6 +11,14 @@
 #include <QHostAddress>
 #include <QUdpSocket>
 
+// STL includes
+#include <vector>
+
+#ifdef __linux__
+	#include <sys/socket.h>
+	#include <sys/uio.h>
+#endif
+
 ///
 /// The ProviderUdp implements an abstract base-class for LedDevices using UDP packets.
 ///
@@ -73,11 +81,100 @@ protected:
 	///
 	int writeBytes(const QByteArray& bytes);
 
+	/// A datagram of a batch, see writeDatagrams()
+	struct Datagram
+	{
+		const uint8_t* data;
+		unsigned size;
+		/// The target, 0 for the configured host, else the index returned by addTarget()
+		int target;
+	};
+
+	///
+	/// @brief Resolves a hostname or IP-address
+	///
+	/// @param[in]  host    The hostname or IP-address
+	/// @param[out] address The IP-address
+	///
+	/// @return True, if success
+	///
+	bool resolveHostAddress(const QString& host, QHostAddress& address);
+
+	///
+	/// @brief Adds a further target, datagrams may be sent to besides the configured host
+	///
+	/// @param[in] address The IP-address
+	/// @param[in] port    The port
+	///
+	/// @return The target index to be used in a Datagram, the same target is added once
+	///
+	int addTarget(const QHostAddress& address, quint16 port);
+
+	///
+	/// @brief Adds a further target given by hostname or IP-address
+	///
+	/// @param[in] host    The hostname or IP-address, empty for the configured host
+	/// @param[in] port    The port, 0 for the configured port
+	///
+	/// @return The target index to be used in a Datagram, negative if the host cannot be resolved
+	///
+	int addTarget(const QString& host, int port);
+
+	///
+	/// @brief Writes a batch of datagrams to the UDP-device, on Linux with a single sendmmsg call.
+	/// A datagram which cannot be sent is skipped, the rest of the batch is sent anyway.
+	///
+	/// @param[in] datagrams The datagrams in the order to be sent
+	///
+	/// @return Zero if all datagrams were sent, else negative
+	///
+	int writeDatagrams(const std::vector<Datagram>& datagrams);
+
 	///
 	QUdpSocket* _udpSocket;
 	QHostAddress _address;
 	quint16       _port;
 	QString      _defaultHost;
+
+private:
+
+	/// A further target of datagrams
+	struct Target
+	{
+		QHostAddress address;
+		quint16      port;
+	};
+
+	/// @return The address and port of a target index
+	Target getTarget(int target) const;
+
+	/// The further targets, target index i is at i - 1
+	std::vector<Target> _targets;
+
+#ifdef __linux__
+	/// The socket address of a target, the length is zero if it is not reachable by the socket
+	struct SocketAddress
+	{
+		sockaddr_storage address;
+		socklen_t        length;
+	};
+
+	///
+	/// @brief Resolve the socket addresses of all targets for the address family of the bound socket
+	///
+	/// @param[in] socketDescriptor The bound socket
+	///
+	/// @return True, if all targets are reachable by the socket
+	///
+	bool resolveTargets(int socketDescriptor);
+
+	/// The socket address of every target, empty if not resolved
+	std::vector<SocketAddress> _socketAddresses;
+
+	/// The message headers of a batch, kept to avoid allocations per write
+	std::vector<mmsghdr> _messages;
+	std::vector<iovec>   _vectors;
+#endif
 };
 
 #endif // PROVIDERUDP_H
@@ -0,0 +1,110 @@
+#include <utils/ImageDataPool.h>
+
+// STL includes
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+/// Free slabs kept per buffer size, enough for the frames in flight of a few instances
+const size_t MAX_SLABS_PER_SIZE = 8;
+
+/// Upper limit of the memory held by free slabs
+const size_t MAX_CACHED_BYTES = 64 * 1024 * 1024;
+
+struct Pool
+{
+	std::mutex mutex;
+	std::map<size_t, std::vector<void*>> slabs;
+	size_t cachedBytes = 0;
+
+	uint64_t allocations = 0;
+	uint64_t reused = 0;
+
+	// allocations per second are counted in windows of one second
+	std::chrono::steady_clock::time_point windowStart = std::chrono::steady_clock::now();
+	uint64_t windowAllocations = 0;
+	uint64_t allocationsPerSecond = 0;
+
+	void updateWindow()
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - windowStart).count();
+		if (elapsed >= 1000)
+		{
+			allocationsPerSecond = windowAllocations * 1000 / static_cast<uint64_t>(elapsed);
+			windowAllocations = 0;
+			windowStart = now;
+		}
+	}
+};
+
+Pool& pool()
+{
+	// never destroyed, images might be released during static destruction
+	static Pool* instance = new Pool();
+	return *instance;
+}
+
+} // namespace
+
+void* ImageDataPool::allocate(size_t bytes)
+{
+	Pool& p = pool();
+	{
+		std::lock_guard<std::mutex> lock(p.mutex);
+		p.updateWindow();
+
+		auto it = p.slabs.find(bytes);
+		if (it != p.slabs.end() && !it->second.empty())
+		{
+			void* buffer = it->second.back();
+			it->second.pop_back();
+			p.cachedBytes -= bytes;
+			++p.reused;
+			return buffer;
+		}
+
+		++p.allocations;
+		++p.windowAllocations;
+	}
+
+	return ::operator new(bytes);
+}
+
+void ImageDataPool::release(void* buffer, size_t bytes)
+{
+	if (buffer == nullptr)
+		return;
+
+	Pool& p = pool();
+	{
+		std::lock_guard<std::mutex> lock(p.mutex);
+		std::vector<void*>& slabs = p.slabs[bytes];
+		if (slabs.size() < MAX_SLABS_PER_SIZE && p.cachedBytes + bytes <= MAX_CACHED_BYTES)
+		{
+			slabs.push_back(buffer);
+			p.cachedBytes += bytes;
+			return;
+		}
+	}
+
+	::operator delete(buffer);
+}
+
+ImageDataPool::Statistics ImageDataPool::getStatistics()
+{
+	Pool& p = pool();
+	std::lock_guard<std::mutex> lock(p.mutex);
+	p.updateWindow();
+
+	Statistics statistics;
+	statistics.allocations = p.allocations;
+	statistics.allocationsPerSecond = p.allocationsPerSecond;
+	statistics.reused = p.reused;
+	statistics.cachedBytes = p.cachedBytes;
+	return statistics;
+}
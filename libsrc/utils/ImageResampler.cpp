@@ -1,7 +1,308 @@
+// STL includes
+#include <cstddef>
+
 #include "utils/ImageResampler.h"
-#include <utils/ColorSys.h>
 #include <utils/Logger.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define IMAGERESAMPLER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define IMAGERESAMPLER_NEON
+#endif
+
+namespace {
+
+inline uint8_t clampToByte(int value)
+{
+	return (value < 0) ? 0 : ((value > 255) ? 255 : static_cast<uint8_t>(value));
+}
+
+///
+/// Integer YUV to RGB conversion, same coefficients as ColorSys::yuv2rgb but inlined into the row kernels
+///
+inline void yuvToRgb(int y, int u, int v, ColorRgb & rgb)
+{
+	// see: http://en.wikipedia.org/wiki/YUV#Y.27UV444_to_RGB888_conversion
+	const int c = y - 16;
+	const int d = u - 128;
+	const int e = v - 128;
+
+	rgb.red   = clampToByte((298 * c + 409 * e + 128) >> 8);
+	rgb.green = clampToByte((298 * c - 100 * d - 208 * e + 128) >> 8);
+	rgb.blue  = clampToByte((298 * c + 516 * d + 128) >> 8);
+}
+
+///
+/// Converts the pixel at column xSource of a source line
+///
+template <PixelFormat FORMAT>
+inline void convertPixel(const uint8_t * line, int xSource, ColorRgb & rgb);
+
+template <>
+inline void convertPixel<PixelFormat::UYVY>(const uint8_t * line, int xSource, ColorRgb & rgb)
+{
+	// two pixels share one U0 Y0 V0 Y1 macro pixel
+	const uint8_t * pair = line + ((xSource & ~1) << 1);
+	yuvToRgb(pair[1 + ((xSource & 1) << 1)], pair[0], pair[2], rgb);
+}
+
+template <>
+inline void convertPixel<PixelFormat::YUYV>(const uint8_t * line, int xSource, ColorRgb & rgb)
+{
+	// two pixels share one Y0 U0 Y1 V0 macro pixel
+	const uint8_t * pair = line + ((xSource & ~1) << 1);
+	yuvToRgb(pair[(xSource & 1) << 1], pair[1], pair[3], rgb);
+}
+
+template <>
+inline void convertPixel<PixelFormat::BGR16>(const uint8_t * line, int xSource, ColorRgb & rgb)
+{
+	const uint8_t * pixel = line + (xSource << 1);
+	rgb.blue  = (pixel[0] & 0x1f) << 3;
+	rgb.green = (((pixel[1] & 0x7) << 3) | (pixel[0] & 0xE0) >> 5) << 2;
+	rgb.red   = (pixel[1] & 0xF8);
+}
+
+template <>
+inline void convertPixel<PixelFormat::BGR24>(const uint8_t * line, int xSource, ColorRgb & rgb)
+{
+	const uint8_t * pixel = line + (xSource << 1) + xSource;
+	rgb.blue  = pixel[0];
+	rgb.green = pixel[1];
+	rgb.red   = pixel[2];
+}
+
+template <>
+inline void convertPixel<PixelFormat::RGB32>(const uint8_t * line, int xSource, ColorRgb & rgb)
+{
+	const uint8_t * pixel = line + (xSource << 2);
+	rgb.red   = pixel[0];
+	rgb.green = pixel[1];
+	rgb.blue  = pixel[2];
+}
+
+template <>
+inline void convertPixel<PixelFormat::BGR32>(const uint8_t * line, int xSource, ColorRgb & rgb)
+{
+	const uint8_t * pixel = line + (xSource << 2);
+	rgb.blue  = pixel[0];
+	rgb.green = pixel[1];
+	rgb.red   = pixel[2];
+}
+
+#if defined(IMAGERESAMPLER_SSE2)
+
+inline __m128i pairCoefficients(short first, short second)
+{
+	return _mm_set_epi16(second, first, second, first, second, first, second, first);
+}
+
+///
+/// Converts full resolution packed YUV 4:2:2 (starting at an even column) in blocks of 8 pixels
+///
+/// @return The number of converted pixels
+///
+template <bool Y_FIRST>
+int convertYuvRowSimd(const uint8_t * pairs, int count, ColorRgb * dest)
+{
+	const __m128i lowBytes  = _mm_set1_epi16(0x00FF);
+	const __m128i lowWords  = _mm_set1_epi32(0x0000FFFF);
+	const __m128i yOffset   = _mm_set1_epi16(16);
+	const __m128i uvOffset  = _mm_set1_epi16(128);
+	const __m128i rounding  = _mm_set1_epi32(128);
+	const __m128i zero      = _mm_setzero_si128();
+	const __m128i coeffRed  = pairCoefficients(298, 409);  // c, e
+	const __m128i coeffGreenCD = pairCoefficients(298, -100); // c, d
+	const __m128i coeffGreenE  = pairCoefficients(-208, 0); // e, 0
+	const __m128i coeffBlue = pairCoefficients(298, 516);  // c, d
+
+	alignas(16) uint8_t red[16];
+	alignas(16) uint8_t green[16];
+	alignas(16) uint8_t blue[16];
+
+	int converted = 0;
+	for (; converted + 8 <= count; converted += 8, pairs += 16)
+	{
+		const __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pairs));
+
+		const __m128i y  = Y_FIRST ? _mm_and_si128(src, lowBytes) : _mm_srli_epi16(src, 8);
+		const __m128i uv = Y_FIRST ? _mm_srli_epi16(src, 8) : _mm_and_si128(src, lowBytes);
+
+		// spread the shared chroma of each macro pixel to both pixels
+		__m128i u = _mm_and_si128(uv, lowWords);
+		u = _mm_or_si128(u, _mm_slli_epi32(u, 16));
+		__m128i v = _mm_srli_epi32(uv, 16);
+		v = _mm_or_si128(v, _mm_slli_epi32(v, 16));
+
+		const __m128i c = _mm_sub_epi16(y, yOffset);
+		const __m128i d = _mm_sub_epi16(u, uvOffset);
+		const __m128i e = _mm_sub_epi16(v, uvOffset);
+
+		const __m128i ceLo = _mm_unpacklo_epi16(c, e);
+		const __m128i ceHi = _mm_unpackhi_epi16(c, e);
+		const __m128i cdLo = _mm_unpacklo_epi16(c, d);
+		const __m128i cdHi = _mm_unpackhi_epi16(c, d);
+		const __m128i e0Lo = _mm_unpacklo_epi16(e, zero);
+		const __m128i e0Hi = _mm_unpackhi_epi16(e, zero);
+
+		const __m128i r = _mm_packs_epi32(
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceLo, coeffRed), rounding), 8),
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceHi, coeffRed), rounding), 8));
+		const __m128i g = _mm_packs_epi32(
+					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, coeffGreenCD), _mm_madd_epi16(e0Lo, coeffGreenE)), rounding), 8),
+					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, coeffGreenCD), _mm_madd_epi16(e0Hi, coeffGreenE)), rounding), 8));
+		const __m128i b = _mm_packs_epi32(
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, coeffBlue), rounding), 8),
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, coeffBlue), rounding), 8));
+
+		// saturate to 0..255
+		_mm_store_si128(reinterpret_cast<__m128i*>(red),   _mm_packus_epi16(r, r));
+		_mm_store_si128(reinterpret_cast<__m128i*>(green), _mm_packus_epi16(g, g));
+		_mm_store_si128(reinterpret_cast<__m128i*>(blue),  _mm_packus_epi16(b, b));
+
+		for (int i = 0; i < 8; ++i)
+		{
+			dest[converted + i] = ColorRgb{red[i], green[i], blue[i]};
+		}
+	}
+	return converted;
+}
+
+#elif defined(IMAGERESAMPLER_NEON)
+
+inline void yuvToRgbSimd(int16x8_t c, int16x8_t d, int16x8_t e, uint8x8_t & r, uint8x8_t & g, uint8x8_t & b)
+{
+	const int32x4_t lumaLo = vmull_n_s16(vget_low_s16(c), 298);
+	const int32x4_t lumaHi = vmull_n_s16(vget_high_s16(c), 298);
+
+	// (x + 128) >> 8 is a rounding narrowing shift, the final narrowing saturates to 0..255
+	r = vqmovun_s16(vcombine_s16(
+			vrshrn_n_s32(vmlal_n_s16(lumaLo, vget_low_s16(e), 409), 8),
+			vrshrn_n_s32(vmlal_n_s16(lumaHi, vget_high_s16(e), 409), 8)));
+	g = vqmovun_s16(vcombine_s16(
+			vrshrn_n_s32(vmlal_n_s16(vmlal_n_s16(lumaLo, vget_low_s16(d), -100), vget_low_s16(e), -208), 8),
+			vrshrn_n_s32(vmlal_n_s16(vmlal_n_s16(lumaHi, vget_high_s16(d), -100), vget_high_s16(e), -208), 8)));
+	b = vqmovun_s16(vcombine_s16(
+			vrshrn_n_s32(vmlal_n_s16(lumaLo, vget_low_s16(d), 516), 8),
+			vrshrn_n_s32(vmlal_n_s16(lumaHi, vget_high_s16(d), 516), 8)));
+}
+
+///
+/// Converts full resolution packed YUV 4:2:2 (starting at an even column) in blocks of 16 pixels
+///
+/// @return The number of converted pixels
+///
+template <bool Y_FIRST>
+int convertYuvRowSimd(const uint8_t * pairs, int count, ColorRgb * dest)
+{
+	const uint8x8_t yOffset  = vdup_n_u8(16);
+	const uint8x8_t uvOffset = vdup_n_u8(128);
+
+	int converted = 0;
+	for (; converted + 16 <= count; converted += 16, pairs += 32)
+	{
+		// deinterleave 8 macro pixels
+		const uint8x8x4_t src = vld4_u8(pairs);
+		const uint8x8_t yEven = Y_FIRST ? src.val[0] : src.val[1];
+		const uint8x8_t u     = Y_FIRST ? src.val[1] : src.val[0];
+		const uint8x8_t yOdd  = Y_FIRST ? src.val[2] : src.val[3];
+		const uint8x8_t v     = Y_FIRST ? src.val[3] : src.val[2];
+
+		const int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(u, uvOffset));
+		const int16x8_t e = vreinterpretq_s16_u16(vsubl_u8(v, uvOffset));
+
+		uint8x8_t rEven, gEven, bEven, rOdd, gOdd, bOdd;
+		yuvToRgbSimd(vreinterpretq_s16_u16(vsubl_u8(yEven, yOffset)), d, e, rEven, gEven, bEven);
+		yuvToRgbSimd(vreinterpretq_s16_u16(vsubl_u8(yOdd,  yOffset)), d, e, rOdd,  gOdd,  bOdd);
+
+		// restore pixel order and store interleaved
+		const uint8x8x2_t r = vzip_u8(rEven, rOdd);
+		const uint8x8x2_t g = vzip_u8(gEven, gOdd);
+		const uint8x8x2_t b = vzip_u8(bEven, bOdd);
+
+		uint8_t * out = reinterpret_cast<uint8_t *>(dest + converted);
+		vst3_u8(out,      uint8x8x3_t{{r.val[0], g.val[0], b.val[0]}});
+		vst3_u8(out + 24, uint8x8x3_t{{r.val[1], g.val[1], b.val[1]}});
+	}
+	return converted;
+}
+
+#else
+
+template <bool Y_FIRST>
+int convertYuvRowSimd(const uint8_t *, int, ColorRgb *)
+{
+	return 0;
+}
+
+#endif
+
+///
+/// Optional vectorized kernel for full resolution rows, the remaining pixels are converted by convertPixel
+///
+/// @return The number of converted pixels
+///
+template <PixelFormat FORMAT>
+inline int convertRowSimd(const uint8_t *, int, int, ColorRgb *)
+{
+	return 0;
+}
+
+template <>
+inline int convertRowSimd<PixelFormat::YUYV>(const uint8_t * line, int xSource, int count, ColorRgb * dest)
+{
+	return convertYuvRowSimd<true>(line + (xSource << 1), count, dest);
+}
+
+template <>
+inline int convertRowSimd<PixelFormat::UYVY>(const uint8_t * line, int xSource, int count, ColorRgb * dest)
+{
+	return convertYuvRowSimd<false>(line + (xSource << 1), count, dest);
+}
+
+///
+/// Converts a decimated and cropped source line to count output pixels
+///
+template <PixelFormat FORMAT>
+void convertRow(const uint8_t * line, int xSource, int xStep, int count, ColorRgb * dest)
+{
+	int xDest = 0;
+	if (xStep == 1 && count > 0)
+	{
+		// the vector kernels expect the row to start at a macro pixel boundary
+		if ((xSource & 1) != 0)
+		{
+			convertPixel<FORMAT>(line, xSource++, dest[xDest++]);
+		}
+
+		const int converted = convertRowSimd<FORMAT>(line, xSource, count - xDest, dest + xDest);
+		xDest   += converted;
+		xSource += converted;
+	}
+
+	for (; xDest < count; ++xDest, xSource += xStep)
+	{
+		convertPixel<FORMAT>(line, xSource, dest[xDest]);
+	}
+}
+
+template <PixelFormat FORMAT>
+void convertImage(const uint8_t * data, int lineLength, int xStart, int yStart, int xStep, int yStep, Image<ColorRgb> & outputImage)
+{
+	const int outputWidth  = static_cast<int>(outputImage.width());
+	const int outputHeight = static_cast<int>(outputImage.height());
+	ColorRgb * dest = outputImage.memptr();
+
+	for (int yDest = 0, ySource = yStart; yDest < outputHeight; ySource += yStep, ++yDest, dest += outputWidth)
+	{
+		convertRow<FORMAT>(data + static_cast<ptrdiff_t>(lineLength) * ySource, xStart, xStep, outputWidth, dest);
+	}
+}
+
+} // namespace
+
 ImageResampler::ImageResampler()
 	: _horizontalDecimation(1)
 	, _verticalDecimation(1)
@@ -40,7 +341,7 @@ void ImageResampler::setVideoMode(VideoMode mode)
 	_videoMode = mode;
 }
 
-void ImageResampler::processImage(const uint8_t * data, int width, int height, int lineLength, PixelFormat pixelFormat, Image<ColorRgb> &outputImage) const
+void ImageResampler::getOutputSize(int width, int height, int & outputWidth, int & outputHeight) const
 {
 	int cropRight  = _cropRight;
 	int cropBottom = _cropBottom;
@@ -59,79 +360,83 @@ void ImageResampler::processImage(const uint8_t * data, int width, int height, i
 	}
 
 	// calculate the output size
-	int outputWidth = (width - _cropLeft - cropRight - (_horizontalDecimation >> 1) + _horizontalDecimation - 1) / _horizontalDecimation;
-	int outputHeight = (height - _cropTop - cropBottom - (_verticalDecimation >> 1) + _verticalDecimation - 1) / _verticalDecimation;
+	outputWidth = (width - _cropLeft - cropRight - (_horizontalDecimation >> 1) + _horizontalDecimation - 1) / _horizontalDecimation;
+	outputHeight = (height - _cropTop - cropBottom - (_verticalDecimation >> 1) + _verticalDecimation - 1) / _verticalDecimation;
+}
+
+void ImageResampler::processImage(const uint8_t * data, int width, int height, int lineLength, PixelFormat pixelFormat, Image<ColorRgb> &outputImage) const
+{
+	int outputWidth;
+	int outputHeight;
+	getOutputSize(width, height, outputWidth, outputHeight);
 
 	outputImage.resize(outputWidth, outputHeight);
 
-	for (int yDest = 0, ySource = _cropTop + (_verticalDecimation >> 1); yDest < outputHeight; ySource += _verticalDecimation, ++yDest)
+	const int xStart = _cropLeft + (_horizontalDecimation >> 1);
+	const int yStart = _cropTop + (_verticalDecimation >> 1);
+
+	// dispatch once per image, the row kernels are specialized per pixel format
+	switch (pixelFormat)
 	{
-		int yOffset = lineLength * ySource;
+		case PixelFormat::UYVY:
+			convertImage<PixelFormat::UYVY>(data, lineLength, xStart, yStart, _horizontalDecimation, _verticalDecimation, outputImage);
+		break;
+		case PixelFormat::YUYV:
+			convertImage<PixelFormat::YUYV>(data, lineLength, xStart, yStart, _horizontalDecimation, _verticalDecimation, outputImage);
+		break;
+		case PixelFormat::BGR16:
+			convertImage<PixelFormat::BGR16>(data, lineLength, xStart, yStart, _horizontalDecimation, _verticalDecimation, outputImage);
+		break;
+		case PixelFormat::BGR24:
+			convertImage<PixelFormat::BGR24>(data, lineLength, xStart, yStart, _horizontalDecimation, _verticalDecimation, outputImage);
+		break;
+		case PixelFormat::RGB32:
+			convertImage<PixelFormat::RGB32>(data, lineLength, xStart, yStart, _horizontalDecimation, _verticalDecimation, outputImage);
+		break;
+		case PixelFormat::BGR32:
+			convertImage<PixelFormat::BGR32>(data, lineLength, xStart, yStart, _horizontalDecimation, _verticalDecimation, outputImage);
+		break;
+#ifdef HAVE_JPEG_DECODER
+		case PixelFormat::MJPEG:
+		break;
+#endif
+		case PixelFormat::NO_CHANGE:
+			Error(Logger::getInstance("ImageResampler"), "Invalid pixel format given");
+		break;
+	}
+}
 
-		for (int xDest = 0, xSource = _cropLeft + (_horizontalDecimation >> 1); xDest < outputWidth; xSource += _horizontalDecimation, ++xDest)
-		{
-			ColorRgb & rgb = outputImage(xDest, yDest);
-
-			switch (pixelFormat)
-			{
-				case PixelFormat::UYVY:
-				{
-					int index = yOffset + (xSource << 1);
-					uint8_t y = data[index+1];
-					uint8_t u = ((xSource&1) == 0) ? data[index  ] : data[index-2];
-					uint8_t v = ((xSource&1) == 0) ? data[index+2] : data[index  ];
-					ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
-				}
-				break;
-				case PixelFormat::YUYV:
-				{
-					int index = yOffset + (xSource << 1);
-					uint8_t y = data[index];
-					uint8_t u = ((xSource&1) == 0) ? data[index+1] : data[index-1];
-					uint8_t v = ((xSource&1) == 0) ? data[index+3] : data[index+1];
-					ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
-				}
-				break;
-				case PixelFormat::BGR16:
-				{
-					int index = yOffset + (xSource << 1);
-					rgb.blue  = (data[index] & 0x1f) << 3;
-					rgb.green = (((data[index+1] & 0x7) << 3) | (data[index] & 0xE0) >> 5) << 2;
-					rgb.red   = (data[index+1] & 0xF8);
-				}
-				break;
-				case PixelFormat::BGR24:
-				{
-					int index = yOffset + (xSource << 1) + xSource;
-					rgb.blue  = data[index  ];
-					rgb.green = data[index+1];
-					rgb.red   = data[index+2];
-				}
-				break;
-				case PixelFormat::RGB32:
-				{
-					int index = yOffset + (xSource << 2);
-					rgb.red   = data[index  ];
-					rgb.green = data[index+1];
-					rgb.blue  = data[index+2];
-				}
-				break;
-				case PixelFormat::BGR32:
-				{
-					int index = yOffset + (xSource << 2);
-					rgb.blue  = data[index  ];
-					rgb.green = data[index+1];
-					rgb.red   = data[index+2];
-				}
-				break;
+void ImageResampler::processLine(const uint8_t * data, int lineLength, PixelFormat pixelFormat, int yDest, int xDest, int count, ColorRgb * dest) const
+{
+	const uint8_t * line = data + static_cast<ptrdiff_t>(lineLength) * (_cropTop + (_verticalDecimation >> 1) + yDest * _verticalDecimation);
+	const int xSource = _cropLeft + (_horizontalDecimation >> 1) + xDest * _horizontalDecimation;
+
+	switch (pixelFormat)
+	{
+		case PixelFormat::UYVY:
+			convertRow<PixelFormat::UYVY>(line, xSource, _horizontalDecimation, count, dest);
+		break;
+		case PixelFormat::YUYV:
+			convertRow<PixelFormat::YUYV>(line, xSource, _horizontalDecimation, count, dest);
+		break;
+		case PixelFormat::BGR16:
+			convertRow<PixelFormat::BGR16>(line, xSource, _horizontalDecimation, count, dest);
+		break;
+		case PixelFormat::BGR24:
+			convertRow<PixelFormat::BGR24>(line, xSource, _horizontalDecimation, count, dest);
+		break;
+		case PixelFormat::RGB32:
+			convertRow<PixelFormat::RGB32>(line, xSource, _horizontalDecimation, count, dest);
+		break;
+		case PixelFormat::BGR32:
+			convertRow<PixelFormat::BGR32>(line, xSource, _horizontalDecimation, count, dest);
+		break;
 #ifdef HAVE_JPEG_DECODER
-				case PixelFormat::MJPEG:
-				break;
+		case PixelFormat::MJPEG:
+		break;
 #endif
-				case PixelFormat::NO_CHANGE:
-					Error(Logger::getInstance("ImageResampler"), "Invalid pixel format given");
-				break;
-			}
-		}
+		case PixelFormat::NO_CHANGE:
+			Error(Logger::getInstance("ImageResampler"), "Invalid pixel format given");
+		break;
 	}
 }
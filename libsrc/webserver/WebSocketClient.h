@@ -37,6 +37,14 @@ private:
 	qint64 sendMessage_Raw(QByteArray &data);
 	QByteArray makeFrameHeader(quint8 opCode, quint64 payloadLength, bool lastFrame);
 
+	///
+	/// @brief Send a message, split into frames of FRAME_SIZE_IN_BYTES
+	/// @param opCode  The type of the message (OPCODE::TEXT or OPCODE::BINARY)
+	/// @param data    The payload
+	/// @return The number of bytes written or -1 on error
+	///
+	qint64 sendFrames(quint8 opCode, const QByteArray& data);
+
 	/// The buffer used for reading data from the socket
 	QByteArray _receiveBuffer;
 
@@ -73,4 +81,5 @@ private:
 private slots:
 	void handleWebSocketFrame();
 	qint64 sendMessage(QJsonObject obj);
+	qint64 sendBinaryMessage(QByteArray data);
 };
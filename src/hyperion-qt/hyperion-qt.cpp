@@ -45,6 +45,8 @@ int main(int argc, char ** argv)
 		Option        & argAddress         = parser.add<Option>       ('a', "address",    "Set the address of the hyperion server [default: %1]", "127.0.0.1:19400");
 		IntOption     & argPriority        = parser.add<IntOption>    ('p', "priority",   "Use the provided priority channel (suggested 100-199) [default: %1]", "150");
 		BooleanOption & argSkipReply       = parser.add<BooleanOption>(0x0, "skip-reply", "Do not receive and check reply messages from Hyperion");
+		Option        & argImageFormat     = parser.add<Option>       (0x0, "image-format", "The pixel format of the images sent via network. Valid values are rgb24, rgb565, nv12 or i420 [default: %1]", "rgb24");
+		Option        & argImageCompression = parser.add<Option>       (0x0, "image-compression", "The compression of the images sent via network. Valid values are none, zlib or jpeg [default: %1]", "none");
 		BooleanOption & argHelp            = parser.add<BooleanOption>('h', "help",        "Show this help message and exit");
 
 		// parse all arguments
@@ -87,6 +89,8 @@ int main(int argc, char ** argv)
 
 			// Create the Flabuf-connection
 			FlatBufferConnection flatbuf("Qt Standalone", address, argPriority.getInt(parser), parser.isSet(argSkipReply));
+			if (!flatbuf.setImageEncoding(argImageFormat.value(parser), argImageCompression.value(parser)))
+				return 1;
 
 			// Connect the screen capturing to flatbuf connection processing
 			QObject::connect(&grabber, SIGNAL(sig_screenshot(const Image<ColorRgb> &)), &flatbuf, SLOT(setImage(Image<ColorRgb>)));
@@ -95,6 +95,7 @@ HyperionDaemon::HyperionDaemon(const QString& rootPath, QObject* parent, bool lo
 	qRegisterMetaType<VideoMode>("VideoMode");
 	qRegisterMetaType<QMap<quint8, QJsonObject>>("QMap<quint8,QJsonObject>");
 	qRegisterMetaType<std::vector<ColorRgb>>("std::vector<ColorRgb>");
+	qRegisterMetaType<std::vector<Led>>("std::vector<Led>");
 
 	// init settings, this settingsManager accesses global settings which are independent from instances
 	_settingsManager = new SettingsManager(GLOABL_INSTANCE_ID, this, readonlyMode);
@@ -0,0 +1,312 @@
+// Receive path of the FlatBufferServer for raw images of several clients
+//
+// Compares the former QByteArray framing (append, mid, remove) with the FlatBufferReceiveBuffer,
+// which receives in place. Both verify the messages and build the image as FlatBufferClient does,
+// the images decoded have to be the same. Headers split across reads, several messages in one read
+// and a message exceeding the maximum size are checked as well, the throughput is printed.
+
+// STL includes
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <vector>
+
+// Qt includes
+#include <QByteArray>
+#include <QElapsedTimer>
+
+// Utils includes
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+// flatbuffer
+#include <flatbufserver/FlatBufferReceiveBuffer.h>
+#include <flatbufserver/hyperion_request_generated.h>
+
+namespace {
+
+const int CLIENTS = 8;
+const int FRAMES_PER_CLIENT = 60;
+const int WIDTH = 1280;
+const int HEIGHT = 720;
+const int FPS = 60;
+
+/// The size of a socket read
+const int CHUNK_SIZE = 64 * 1024;
+
+QByteArray frameMessage(const flatbuffers::FlatBufferBuilder& builder)
+{
+	const uint32_t size = builder.GetSize();
+	const char header[] = { char(size >> 24), char(size >> 16), char(size >> 8), char(size) };
+	QByteArray message(header, 4);
+	message.append(reinterpret_cast<const char*>(builder.GetBufferPointer()), static_cast<int>(size));
+	return message;
+}
+
+/// An image message, the pixels depend on the frame
+QByteArray buildMessage(int width, int height, int frame)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<uint8_t> pixels(width * height * 3);
+	for (size_t i = 0; i < pixels.size(); ++i)
+	{
+		pixels[i] = uint8_t(i * 7 + frame * 13);
+	}
+	auto imgData = builder.CreateVector(pixels.data(), pixels.size());
+	auto rawImg = hyperionnet::CreateRawImage(builder, imgData, width, height);
+	auto imageReq = hyperionnet::CreateImage(builder, hyperionnet::ImageType_RawImage, rawImg.Union(), -1);
+	auto req = hyperionnet::CreateRequest(builder, hyperionnet::Command_Image, imageReq.Union());
+	builder.Finish(req);
+	return frameMessage(builder);
+}
+
+/// The checksum of an image
+uint32_t checksum(const Image<ColorRgb>& image)
+{
+	uint32_t hash = 2166136261u;
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(image.memptr());
+	const size_t bytes = static_cast<size_t>(image.size());
+	for (size_t i = 0; i < bytes; ++i)
+	{
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return hash ^ (image.width() << 16) ^ image.height();
+}
+
+/// Verify a message and copy its image, the checksums of the images are collected
+void handleMessage(const uint8_t* data, uint32_t size, std::vector<uint32_t>& images)
+{
+	flatbuffers::Verifier verifier(data, size);
+	if (!hyperionnet::VerifyRequestBuffer(verifier))
+	{
+		return;
+	}
+
+	const auto* image = hyperionnet::GetRequest(data)->command_as_Image();
+	const auto* raw = image != nullptr ? image->data_as_RawImage() : nullptr;
+	if (raw == nullptr)
+	{
+		return;
+	}
+
+	Image<ColorRgb> imageDest(raw->width(), raw->height());
+	memcpy(imageDest.memptr(), raw->data()->data(), std::min<size_t>(raw->data()->size(), imageDest.size()));
+	images.push_back(checksum(imageDest));
+}
+
+struct LegacyClient
+{
+	QByteArray receiveBuffer;
+	std::vector<uint32_t> images;
+
+	void receive(const char* chunk, int size)
+	{
+		receiveBuffer += QByteArray(chunk, size);
+		while (receiveBuffer.size() >= 4)
+		{
+			uint32_t messageSize =
+				((receiveBuffer[0]<<24) & 0xFF000000) |
+				((receiveBuffer[1]<<16) & 0x00FF0000) |
+				((receiveBuffer[2]<< 8) & 0x0000FF00) |
+				((receiveBuffer[3]    ) & 0x000000FF);
+
+			if ((uint32_t) receiveBuffer.size() < messageSize + 4) break;
+
+			const QByteArray msg = receiveBuffer.mid(4, messageSize);
+			receiveBuffer.remove(0, messageSize + 4);
+			handleMessage(reinterpret_cast<const uint8_t*>(msg.constData()), messageSize, images);
+		}
+	}
+};
+
+struct RingClient
+{
+	FlatBufferReceiveBuffer receiveBuffer;
+	std::vector<uint32_t> images;
+
+	void receive(const char* chunk, int size)
+	{
+		memcpy(receiveBuffer.reserve(size), chunk, size);
+		receiveBuffer.commit(size);
+
+		const uint8_t* data;
+		uint32_t messageSize;
+		while (receiveBuffer.nextMessage(data, messageSize))
+		{
+			handleMessage(data, messageSize, images);
+		}
+	}
+};
+
+/// Feed a stream in chunks of the given sizes, repeated until the stream is consumed
+template <typename Client>
+std::vector<uint32_t> receive(const QByteArray& stream, const std::vector<int>& chunkSizes)
+{
+	Client client;
+	int offset = 0;
+	for (size_t chunk = 0; offset < stream.size(); ++chunk)
+	{
+		const int size = std::min(chunkSizes[chunk % chunkSizes.size()], stream.size() - offset);
+		client.receive(stream.constData() + offset, size);
+		offset += size;
+	}
+	return client.images;
+}
+
+/// Both receive paths decode the same images from a stream
+int compareReceivePaths(const char* name, const QByteArray& stream, const std::vector<int>& chunkSizes, size_t expectedImages)
+{
+	const std::vector<uint32_t> legacy = receive<LegacyClient>(stream, chunkSizes);
+	const std::vector<uint32_t> ring = receive<RingClient>(stream, chunkSizes);
+
+	if (ring.size() != expectedImages || legacy.size() != expectedImages || ring != legacy)
+	{
+		std::cerr << name << ": failed, " << ring.size() << " images received in place, " << legacy.size()
+				  << " with the QByteArray framing, " << expectedImages << " expected" << std::endl;
+		return 1;
+	}
+	std::cout << name << ": " << ring.size() << " equal images" << std::endl;
+	return 0;
+}
+
+int testSplitHeaders()
+{
+	QByteArray stream;
+	for (int frame = 0; frame < 10; ++frame)
+	{
+		stream.append(buildMessage(17, 3, frame));
+	}
+
+	// reads of 1 to 5 bytes split every header, odd sizes misalign the messages
+	int errors = 0;
+	for (int chunkSize = 1; chunkSize <= 5; ++chunkSize)
+	{
+		errors += compareReceivePaths("Header split across reads", stream, { chunkSize }, 10);
+	}
+	errors += compareReceivePaths("Header split across reads", stream, { 2, 1, 3, 7, 4093 }, 10);
+	return errors;
+}
+
+int testSeveralMessagesPerRead()
+{
+	QByteArray stream;
+	for (int frame = 0; frame < 50; ++frame)
+	{
+		stream.append(buildMessage(1 + frame % 9, 1 + frame % 4, frame));
+	}
+
+	// all messages at once and several complete messages followed by a partial one
+	return compareReceivePaths("Several messages in one read", stream, { stream.size() }, 50)
+		 + compareReceivePaths("Several messages in one read", stream, { 1000 }, 50);
+}
+
+int testMessageTooLarge()
+{
+	int errors = 0;
+
+	// a header announcing more than the maximum, followed by a few bytes only
+	const uint32_t size = FlatBufferReceiveBuffer::MAX_MESSAGE_SIZE + 1;
+	const uint8_t header[] = { uint8_t(size >> 24), uint8_t(size >> 16), uint8_t(size >> 8), uint8_t(size), 1, 2, 3, 4 };
+
+	FlatBufferReceiveBuffer receiveBuffer;
+	memcpy(receiveBuffer.reserve(sizeof(header)), header, sizeof(header));
+	receiveBuffer.commit(sizeof(header));
+
+	const uint8_t* data;
+	uint32_t messageSize;
+	if (receiveBuffer.nextMessage(data, messageSize) || !receiveBuffer.isMessageTooLarge())
+	{
+		std::cerr << "Message too large: failed, the message was not rejected" << std::endl;
+		++errors;
+	}
+
+	// a message of the maximum size is accepted, the header alone is not
+	const uint32_t maxSize = FlatBufferReceiveBuffer::MAX_MESSAGE_SIZE;
+	const uint8_t maxHeader[] = { uint8_t(maxSize >> 24), uint8_t(maxSize >> 16), uint8_t(maxSize >> 8), uint8_t(maxSize) };
+	FlatBufferReceiveBuffer maxBuffer;
+	memcpy(maxBuffer.reserve(sizeof(maxHeader)), maxHeader, sizeof(maxHeader));
+	maxBuffer.commit(sizeof(maxHeader));
+	if (maxBuffer.nextMessage(data, messageSize) || maxBuffer.isMessageTooLarge())
+	{
+		std::cerr << "Message too large: failed, a message of the maximum size was rejected" << std::endl;
+		++errors;
+	}
+
+	if (errors == 0)
+	{
+		std::cout << "Message too large: rejected" << std::endl;
+	}
+	return errors;
+}
+
+/// Feed the stream of every client in socket sized chunks, the clients take turns
+template <typename Client>
+size_t benchmark(const char* name, const QByteArray& stream)
+{
+	std::vector<Client> clients(CLIENTS);
+	std::vector<int> offsets(CLIENTS, 0);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	bool pending = true;
+	while (pending)
+	{
+		pending = false;
+		for (int client = 0; client < CLIENTS; ++client)
+		{
+			const int offset = offsets[client];
+			if (offset < stream.size())
+			{
+				const int size = std::min(CHUNK_SIZE, stream.size() - offset);
+				clients[client].receive(stream.constData() + offset, size);
+				offsets[client] += size;
+				pending = true;
+			}
+		}
+	}
+
+	const double seconds = timer.nsecsElapsed() / 1e9;
+	size_t images = 0;
+	for (const Client& client : clients)
+	{
+		images += client.images.size();
+	}
+
+	const double fps = images / seconds;
+	std::cout << name << ": " << images << " images in " << seconds << " s, "
+			  << fps << " images/s, " << (stream.size() * double(CLIENTS) / seconds / (1024 * 1024)) << " MiB/s, "
+			  << "load at " << CLIENTS << "x" << FPS << " fps: " << (100.0 * CLIENTS * FPS / fps) << " %" << std::endl;
+	return images;
+}
+
+} // namespace
+
+int main()
+{
+	int errors = 0;
+	errors += testSplitHeaders();
+	errors += testSeveralMessagesPerRead();
+	errors += testMessageTooLarge();
+
+	QByteArray stream;
+	for (int frame = 0; frame < FRAMES_PER_CLIENT; ++frame)
+	{
+		stream.append(buildMessage(WIDTH, HEIGHT, frame));
+	}
+
+	std::cout << CLIENTS << " clients, " << FRAMES_PER_CLIENT << " frames of " << WIDTH << "x" << HEIGHT
+			  << " each, " << CHUNK_SIZE << " bytes per read" << std::endl;
+
+	errors += compareReceivePaths("Large images", stream, { CHUNK_SIZE }, FRAMES_PER_CLIENT);
+
+	const size_t legacyImages = benchmark<LegacyClient>("QByteArray framing     ", stream);
+	const size_t ringImages = benchmark<RingClient>  ("FlatBufferReceiveBuffer", stream);
+	if (legacyImages != size_t(CLIENTS * FRAMES_PER_CLIENT) || ringImages != legacyImages)
+	{
+		std::cerr << "Benchmark: failed, not all images were received" << std::endl;
+		++errors;
+	}
+
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+// Pixel format conversion of the ImageResampler
+//
+// Compares the row kernels of every pixel format with a per pixel reference, which is the former
+// conversion of processImage with ColorSys::yuv2rgb. Odd widths, crops and decimations cover the
+// vector kernels (blocks of 8 pixels with SSE2, 16 with NEON) as well as the scalar tail and the
+// scalar decimated rows.
+
+// STL includes
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+#include <utils/ColorSys.h>
+#include <utils/Image.h>
+#include <utils/ImageResampler.h>
+#include <utils/PixelFormat.h>
+
+namespace {
+
+struct Format
+{
+	PixelFormat pixelFormat;
+	const char* name;
+	int bytesPerPixel;
+};
+
+const Format FORMATS[] = {
+	{ PixelFormat::YUYV,  "YUYV",  2 },
+	{ PixelFormat::UYVY,  "UYVY",  2 },
+	{ PixelFormat::BGR16, "BGR16", 2 },
+	{ PixelFormat::BGR24, "BGR24", 3 },
+	{ PixelFormat::RGB32, "RGB32", 4 },
+	{ PixelFormat::BGR32, "BGR32", 4 }
+};
+
+/// The conversion of a single source pixel
+ColorRgb referencePixel(const uint8_t * data, int lineLength, PixelFormat pixelFormat, int xSource, int ySource)
+{
+	const int yOffset = lineLength * ySource;
+	ColorRgb rgb {0, 0, 0};
+
+	switch (pixelFormat)
+	{
+		case PixelFormat::UYVY:
+		{
+			int index = yOffset + (xSource << 1);
+			uint8_t y = data[index+1];
+			uint8_t u = ((xSource&1) == 0) ? data[index  ] : data[index-2];
+			uint8_t v = ((xSource&1) == 0) ? data[index+2] : data[index  ];
+			ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
+		}
+		break;
+		case PixelFormat::YUYV:
+		{
+			int index = yOffset + (xSource << 1);
+			uint8_t y = data[index];
+			uint8_t u = ((xSource&1) == 0) ? data[index+1] : data[index-1];
+			uint8_t v = ((xSource&1) == 0) ? data[index+3] : data[index+1];
+			ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
+		}
+		break;
+		case PixelFormat::BGR16:
+		{
+			int index = yOffset + (xSource << 1);
+			rgb.blue  = (data[index] & 0x1f) << 3;
+			rgb.green = (((data[index+1] & 0x7) << 3) | (data[index] & 0xE0) >> 5) << 2;
+			rgb.red   = (data[index+1] & 0xF8);
+		}
+		break;
+		case PixelFormat::BGR24:
+		{
+			int index = yOffset + (xSource << 1) + xSource;
+			rgb.blue  = data[index  ];
+			rgb.green = data[index+1];
+			rgb.red   = data[index+2];
+		}
+		break;
+		case PixelFormat::RGB32:
+		{
+			int index = yOffset + (xSource << 2);
+			rgb.red   = data[index  ];
+			rgb.green = data[index+1];
+			rgb.blue  = data[index+2];
+		}
+		break;
+		case PixelFormat::BGR32:
+		{
+			int index = yOffset + (xSource << 2);
+			rgb.blue  = data[index  ];
+			rgb.green = data[index+1];
+			rgb.red   = data[index+2];
+		}
+		break;
+		default:
+		break;
+	}
+	return rgb;
+}
+
+bool operator!=(const ColorRgb & lhs, const ColorRgb & rhs)
+{
+	return lhs.red != rhs.red || lhs.green != rhs.green || lhs.blue != rhs.blue;
+}
+
+/// A frame of random bytes, lines are padded to test the line length
+std::vector<uint8_t> createFrame(int width, int height, const Format & format, int & lineLength)
+{
+	// packed YUV lines hold whole macro pixels
+	const int pixels = (format.bytesPerPixel == 2) ? ((width + 1) & ~1) : width;
+	lineLength = pixels * format.bytesPerPixel + 5;
+
+	std::vector<uint8_t> frame(static_cast<size_t>(lineLength) * height);
+	for (uint8_t & byte : frame)
+	{
+		byte = uint8_t(rand() % 256);
+	}
+	return frame;
+}
+
+/// Converts a frame with processImage and processLine, both are compared with the reference
+int compareWithReference(const Format & format, int width, int height, int cropLeft, int cropRight, int decimation)
+{
+	int lineLength = 0;
+	const std::vector<uint8_t> frame = createFrame(width, height, format, lineLength);
+
+	ImageResampler resampler;
+	resampler.setCropping(cropLeft, cropRight, 1, 0);
+	resampler.setHorizontalPixelDecimation(decimation);
+	resampler.setVerticalPixelDecimation(decimation);
+
+	Image<ColorRgb> image;
+	resampler.processImage(frame.data(), width, height, lineLength, format.pixelFormat, image);
+
+	int outputWidth = 0;
+	int outputHeight = 0;
+	resampler.getOutputSize(width, height, outputWidth, outputHeight);
+	if (int(image.width()) != outputWidth || int(image.height()) != outputHeight)
+	{
+		std::cerr << format.name << ": output size " << image.width() << "x" << image.height()
+				  << " instead of " << outputWidth << "x" << outputHeight << std::endl;
+		return 1;
+	}
+
+	int errors = 0;
+	std::vector<ColorRgb> line(static_cast<size_t>(outputWidth));
+	for (int yDest = 0; yDest < outputHeight; ++yDest)
+	{
+		const int ySource = 1 + (decimation >> 1) + yDest * decimation;
+		for (int xDest = 0; xDest < outputWidth; ++xDest)
+		{
+			const int xSource = cropLeft + (decimation >> 1) + xDest * decimation;
+			if (image(xDest, yDest) != referencePixel(frame.data(), lineLength, format.pixelFormat, xSource, ySource))
+			{
+				++errors;
+			}
+		}
+
+		// a part of the line starting at an odd column, the rest of the line up to the last column
+		const int xFirst = outputWidth / 3 | 1;
+		if (xFirst < outputWidth)
+		{
+			resampler.processLine(frame.data(), lineLength, format.pixelFormat, yDest, xFirst, outputWidth - xFirst, line.data());
+			for (int xDest = xFirst; xDest < outputWidth; ++xDest)
+			{
+				if (line[xDest - xFirst] != image(xDest, yDest))
+				{
+					++errors;
+				}
+			}
+		}
+	}
+
+	if (errors > 0)
+	{
+		std::cerr << format.name << ": " << errors << " pixels differ from the reference, width " << width
+				  << ", crop " << cropLeft << "/" << cropRight << ", decimation " << decimation << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+} // namespace
+
+int main()
+{
+	int errors = 0;
+	for (const Format & format : FORMATS)
+	{
+		int formatErrors = 0;
+
+		// widths around the block size of the vector kernels, odd crops start a line at an odd column
+		for (int width = 1; width <= 41; width += 2)
+		{
+			for (int decimation = 1; decimation <= 3; ++decimation)
+			{
+				formatErrors += compareWithReference(format, width, 5, 0, 0, decimation);
+				if (width > 4)
+				{
+					formatErrors += compareWithReference(format, width, 5, 1, 2, decimation);
+					formatErrors += compareWithReference(format, width, 5, 3, 1, decimation);
+				}
+			}
+		}
+
+		if (formatErrors == 0)
+		{
+			std::cout << format.name << ": kernels equal the reference" << std::endl;
+		}
+		errors += formatErrors;
+	}
+
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// Compositing of priority channels by blendLedColors
+//
+// Compares every blend mode with a per byte reference, which rounds the exact quotients by 255. The
+// opacities cover the special cases (transparent, opaque) and their neighbours, the led counts give
+// byte counts of full vectors (16 bytes) with every length of the scalar tail.
+
+// STL includes
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+
+// Hyperion includes
+#include <hyperion/PriorityMuxer.h>
+#include <hyperion/LedBlender.h>
+
+using namespace hyperion;
+
+namespace {
+
+struct Mode
+{
+	PriorityMuxer::BlendMode blendMode;
+	const char* name;
+};
+
+const Mode MODES[] = {
+	{ PriorityMuxer::BLEND_NONE,  "none"  },
+	{ PriorityMuxer::BLEND_ALPHA, "alpha" },
+	{ PriorityMuxer::BLEND_ADD,   "add"   },
+	{ PriorityMuxer::BLEND_MAX,   "max"   }
+};
+
+const int OPACITIES[] = { 0, 1, 128, 254, 255 };
+
+/// x / 255 rounded to the nearest integer, x / 255 is never exactly halfway
+unsigned divRound255(unsigned x)
+{
+	return (2 * x + 255) / 510;
+}
+
+/// The blending of a single color byte
+uint8_t referenceByte(PriorityMuxer::BlendMode blendMode, unsigned opacity, uint8_t src, uint8_t dest)
+{
+	switch (blendMode)
+	{
+		case PriorityMuxer::BLEND_ALPHA: return uint8_t(divRound255(src * opacity + dest * (255 - opacity)));
+		case PriorityMuxer::BLEND_ADD: return uint8_t(std::min(255U, dest + divRound255(src * opacity)));
+		case PriorityMuxer::BLEND_MAX: return uint8_t(std::max(unsigned(dest), divRound255(src * opacity)));
+		default: return src;
+	}
+}
+
+std::vector<ColorRgb> createColors(size_t count)
+{
+	std::vector<ColorRgb> colors(count);
+	for (ColorRgb & color : colors)
+	{
+		color.red   = uint8_t(rand() % 256);
+		color.green = uint8_t(rand() % 256);
+		color.blue  = uint8_t(rand() % 256);
+	}
+
+	// the extremes of the saturating and rounding arithmetic
+	if (count > 1)
+	{
+		colors[0] = ColorRgb{ 255, 255, 255 };
+		colors[count - 1] = ColorRgb{ 0, 0, 0 };
+	}
+	return colors;
+}
+
+/// Blends a layer onto the colors below, the layer may have less colors than the leds
+int compareWithReference(const Mode & mode, int opacity, size_t ledCount, size_t layerCount)
+{
+	const std::vector<ColorRgb> layer = createColors(layerCount);
+	const std::vector<ColorRgb> below = createColors(ledCount);
+
+	std::vector<ColorRgb> colors = below;
+	blendLedColors(mode.blendMode, uint8_t(opacity), layer, colors);
+
+	if (colors.size() != ledCount)
+	{
+		std::cerr << mode.name << ": " << colors.size() << " leds instead of " << ledCount << std::endl;
+		return 1;
+	}
+
+	int errors = 0;
+	for (size_t i = 0; i < ledCount; ++i)
+	{
+		ColorRgb expected = below[i];
+		if (i < layerCount)
+		{
+			expected.red   = referenceByte(mode.blendMode, unsigned(opacity), layer[i].red,   below[i].red);
+			expected.green = referenceByte(mode.blendMode, unsigned(opacity), layer[i].green, below[i].green);
+			expected.blue  = referenceByte(mode.blendMode, unsigned(opacity), layer[i].blue,  below[i].blue);
+		}
+
+		if (colors[i].red != expected.red || colors[i].green != expected.green || colors[i].blue != expected.blue)
+		{
+			++errors;
+		}
+	}
+
+	if (errors > 0)
+	{
+		std::cerr << mode.name << ": " << errors << " leds differ from the reference, opacity " << opacity
+				  << ", " << ledCount << " leds, " << layerCount << " layer colors" << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+} // namespace
+
+int main()
+{
+	int errors = 0;
+	for (const Mode & mode : MODES)
+	{
+		int modeErrors = 0;
+		for (int opacity : OPACITIES)
+		{
+			// 3 bytes per led, so every length of the tail is covered, up to several vectors
+			for (size_t ledCount = 0; ledCount <= 41; ++ledCount)
+			{
+				modeErrors += compareWithReference(mode, opacity, ledCount, ledCount);
+			}
+			modeErrors += compareWithReference(mode, opacity, 333, 333);
+
+			// leds without a layer color are kept
+			modeErrors += compareWithReference(mode, opacity, 37, 22);
+		}
+
+		if (modeErrors == 0)
+		{
+			std::cout << mode.name << ": blending equals the reference" << std::endl;
+		}
+		errors += modeErrors;
+	}
+
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+// DCT scaled decoding of the MjpegDecoder
+//
+// A frame is decoded with the crop and decimation of the grabber, which selects the DCT scaling
+// (1/2, 1/4, 1/8) of the JPEG library. The result is compared with the unscaled decode of the whole
+// frame, which is cropped and downscaled by averaging afterwards. The output size has to match exactly,
+// the colors of the smooth test frame within the error of the JPEG compression and the DCT scaling.
+
+// STL includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QSemaphore>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+#include <utils/Image.h>
+#include <utils/Logger.h>
+
+// JPEG encoder
+#ifdef HAVE_JPEG
+	#include <jpeglib.h>
+#endif
+#ifdef HAVE_TURBO_JPEG
+	#include <turbojpeg.h>
+#endif
+
+#include <grabber/v4l2/MjpegDecoder.h>
+
+namespace {
+
+const int WIDTH = 360;
+const int HEIGHT = 202;
+
+/// The maximum difference of a channel to the downscaled reference
+const int TOLERANCE = 12;
+
+/// Diagonal gradients, a wrong crop or sampling position shifts the colors beyond the tolerance
+std::vector<uint8_t> createFrame()
+{
+	std::vector<uint8_t> rgb(static_cast<size_t>(WIDTH) * HEIGHT * 3);
+	uint8_t* pixel = rgb.data();
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x, pixel += 3)
+		{
+			pixel[0] = uint8_t(x * 255 / (WIDTH - 1));
+			pixel[1] = uint8_t(y * 255 / (HEIGHT - 1));
+			pixel[2] = uint8_t((x + 2 * (HEIGHT - 1 - y)) * 255 / (WIDTH - 1 + 2 * (HEIGHT - 1)));
+		}
+	}
+	return rgb;
+}
+
+std::vector<uint8_t> encode(std::vector<uint8_t>& rgb)
+{
+	std::vector<uint8_t> jpeg;
+
+#ifdef HAVE_TURBO_JPEG
+	tjhandle compress = tjInitCompress();
+	unsigned char* buffer = nullptr;
+	unsigned long size = 0;
+	if (tjCompress2(compress, rgb.data(), WIDTH, 0, HEIGHT, TJPF_RGB, &buffer, &size, TJSAMP_420, 95, 0) == 0)
+	{
+		jpeg.assign(buffer, buffer + size);
+	}
+	tjFree(buffer);
+	tjDestroy(compress);
+#elif defined(HAVE_JPEG)
+	jpeg_compress_struct compress;
+	jpeg_error_mgr error;
+	compress.err = jpeg_std_error(&error);
+	jpeg_create_compress(&compress);
+
+	unsigned char* buffer = nullptr;
+	unsigned long size = 0;
+	jpeg_mem_dest(&compress, &buffer, &size);
+
+	compress.image_width = WIDTH;
+	compress.image_height = HEIGHT;
+	compress.input_components = 3;
+	compress.in_color_space = JCS_RGB;
+	jpeg_set_defaults(&compress);
+	jpeg_set_quality(&compress, 95, TRUE);
+
+	jpeg_start_compress(&compress, TRUE);
+	while (compress.next_scanline < compress.image_height)
+	{
+		JSAMPROW row = &rgb[static_cast<size_t>(compress.next_scanline) * WIDTH * 3];
+		jpeg_write_scanlines(&compress, &row, 1);
+	}
+	jpeg_finish_compress(&compress);
+	jpeg_destroy_compress(&compress);
+
+	jpeg.assign(buffer, buffer + size);
+	free(buffer);
+#endif
+
+	return jpeg;
+}
+
+/// Decode a frame synchronously
+bool decode(MjpegDecoder& decoder, const std::vector<uint8_t>& jpeg, const MjpegDecoder::Settings& settings, Image<ColorRgb>& image)
+{
+	QSemaphore decoded;
+	const QMetaObject::Connection connection = QObject::connect(&decoder, &MjpegDecoder::frameDecoded, &decoder, [&](quint64 /*sequence*/, const Image<ColorRgb>& frame) {
+		image = frame;
+		decoded.release();
+	}, Qt::DirectConnection);
+
+	decoder.decode(jpeg.data(), static_cast<int>(jpeg.size()), settings);
+	const bool ok = decoded.tryAcquire(1, 5000);
+
+	QObject::disconnect(connection);
+	return ok;
+}
+
+/// Crop and downscale the unscaled frame, every output pixel is the mean of its decimation x decimation block
+Image<ColorRgb> downscale(const Image<ColorRgb>& frame, const MjpegDecoder::Settings& settings)
+{
+	const int decimation = settings.pixelDecimation;
+	const int width = (int(frame.width()) - settings.cropLeft - settings.cropRight) / decimation;
+	const int height = (int(frame.height()) - settings.cropTop - settings.cropBottom) / decimation;
+
+	Image<ColorRgb> image(width, height);
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			int sum[3] = { 0, 0, 0 };
+			for (int yBlock = 0; yBlock < decimation; ++yBlock)
+			{
+				for (int xBlock = 0; xBlock < decimation; ++xBlock)
+				{
+					const ColorRgb& pixel = frame(settings.cropLeft + x * decimation + xBlock, settings.cropTop + y * decimation + yBlock);
+					sum[0] += pixel.red;
+					sum[1] += pixel.green;
+					sum[2] += pixel.blue;
+				}
+			}
+			const int count = decimation * decimation;
+			image(x, y) = ColorRgb{ uint8_t(sum[0] / count), uint8_t(sum[1] / count), uint8_t(sum[2] / count) };
+		}
+	}
+	return image;
+}
+
+int compare(MjpegDecoder& decoder, const std::vector<uint8_t>& jpeg, const Image<ColorRgb>& frame, const MjpegDecoder::Settings& settings)
+{
+	Image<ColorRgb> image;
+	if (!decode(decoder, jpeg, settings, image))
+	{
+		std::cerr << "Decimation " << settings.pixelDecimation << ": failed to decode the frame" << std::endl;
+		return 1;
+	}
+
+	const Image<ColorRgb> reference = downscale(frame, settings);
+	if (image.width() != reference.width() || image.height() != reference.height())
+	{
+		std::cerr << "Decimation " << settings.pixelDecimation << ", crop " << settings.cropLeft << "/" << settings.cropRight << "/"
+				  << settings.cropTop << "/" << settings.cropBottom << ": size " << image.width() << "x" << image.height()
+				  << " instead of " << reference.width() << "x" << reference.height() << std::endl;
+		return 1;
+	}
+
+	int maxDifference = 0;
+	for (unsigned y = 0; y < image.height(); ++y)
+	{
+		for (unsigned x = 0; x < image.width(); ++x)
+		{
+			const ColorRgb& pixel = image(x, y);
+			const ColorRgb& expected = reference(x, y);
+			maxDifference = std::max(maxDifference, std::abs(pixel.red - expected.red));
+			maxDifference = std::max(maxDifference, std::abs(pixel.green - expected.green));
+			maxDifference = std::max(maxDifference, std::abs(pixel.blue - expected.blue));
+		}
+	}
+
+	if (maxDifference > TOLERANCE)
+	{
+		std::cerr << "Decimation " << settings.pixelDecimation << ", crop " << settings.cropLeft << "/" << settings.cropRight << "/"
+				  << settings.cropTop << "/" << settings.cropBottom << ": colors differ by up to " << maxDifference << std::endl;
+		return 1;
+	}
+
+	std::cout << "Decimation " << settings.pixelDecimation << ", crop " << settings.cropLeft << "/" << settings.cropRight << "/"
+			  << settings.cropTop << "/" << settings.cropBottom << ": " << image.width() << "x" << image.height()
+			  << ", colors differ by up to " << maxDifference << std::endl;
+	return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+
+	std::vector<uint8_t> rgb = createFrame();
+	const std::vector<uint8_t> jpeg = encode(rgb);
+	if (jpeg.empty())
+	{
+		std::cerr << "Failed to encode the test frame" << std::endl;
+		return 1;
+	}
+
+	MjpegDecoder decoder(1, Logger::getInstance("TEST"));
+
+	// the unscaled decode of the whole frame
+	Image<ColorRgb> frame;
+	if (!decode(decoder, jpeg, { 0, 0, 0, 0, 1 }, frame) || frame.width() != unsigned(WIDTH) || frame.height() != unsigned(HEIGHT))
+	{
+		std::cerr << "Failed to decode the unscaled frame" << std::endl;
+		return 1;
+	}
+
+	// decimations without scaling and with the scaling 1/2, 1/4 and 1/8, exact and in between
+	const int decimations[] = { 1, 2, 3, 4, 6, 8, 9 };
+
+	// crops of the four sides, not aligned to the 8x8 blocks of the DCT
+	const MjpegDecoder::Settings crops[] = {
+		{ 0, 0, 0, 0, 1 },
+		{ 3, 5, 1, 2, 1 },
+		{ 37, 21, 29, 13, 1 }
+	};
+
+	int errors = 0;
+	for (int decimation : decimations)
+	{
+		for (MjpegDecoder::Settings settings : crops)
+		{
+			settings.pixelDecimation = decimation;
+			errors += compare(decoder, jpeg, frame, settings);
+		}
+	}
+
+	return errors == 0 ? 0 : 1;
+}